@@ -46,20 +46,17 @@ extern "C" void app_main(void)
     g20sProReport->registerCallback([](const UsbHidG20sProEvent event)
                                     {
                                         if(event.pressed)
-                                            ESP_LOGI(TAG, "G20sPro event: button: %s | x: %03d y: %03d", UsbHidG20sProReport::buttonName(event.button).c_str(), event.mouseX, event.mouseY); });
+                                        {
+                                            std::string_view name = UsbHidG20sProReport::buttonName(event.button);
+                                            ESP_LOGI(TAG, "G20sPro event: button: %.*s | x: %03d y: %03d", static_cast<int>(name.size()), name.data(), event.mouseX, event.mouseY);
+                                        } });
     // Keyboard report
     UsbHidKeyboardReport* keyboardReport = usbHostHid.reportKeyboard();
     keyboardReport->registerCallback([](const UsbHidKeyboardEvent event)
                                      {
-                                        if(event.keyCodes.size() == 0)
-                                        return;
-
-                                         std::string keys;
-                                         for (auto keyCode : event.keyCodes)
-                                         {
-                                             keys += UsbHidKeyboardReport::getKeyName(keyCode);
-                                         }
-                                         ESP_LOGW(TAG, "Key: %s", keys.c_str());
+                                         std::string_view name = UsbHidKeyboardReport::getKeyName(event.keyCode);
+                                         ESP_LOGW(TAG, "Key %s: %.*s", event.pressed ? "down" : "up",
+                                                  static_cast<int>(name.size()), name.data());
 
                                          ESP_LOGW(TAG, "Modifiers: %s", UsbHidKeyboardReport::getModifierNames(event.modifiers).c_str()); });
 
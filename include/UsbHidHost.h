@@ -1,6 +1,8 @@
 #pragma once
 
 #include <variant>
+#include <array>
+#include <functional>
 #include <vector>
 #include <map>
 #include <cstdint>
@@ -8,19 +10,30 @@
 #include <string>
 #include <algorithm>
 #include <optional>
+#include <memory>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
 
 #include "usb/usb_host.h"
 #include "usb/hid_host.h"
 
+#include "reports/UsbHidConsumerReport.h"
+#include "reports/UsbHidDeviceClassifier.h"
+#include "reports/UsbHidDigitizerReport.h"
 #include "reports/UsbHidG20sProReport.h"
+#include "reports/UsbHidGamepadReport.h"
 #include "reports/UsbHidKeyboardReport.h"
+#include "reports/UsbHidMouseGestures.h"
 #include "reports/UsbHidMouseReport.h"
+#include "reports/UsbHidPointerProcessor.h"
 #include "reports/UsbHidGenericReport.h"
+#include "reports/UsbHidHotkeyMatcher.h"
+#include "reports/UsbHidReportDescriptor.h"
+#include "reports/UsbHidTimerWheel.h"
 
 class UsbHidHost
 {
@@ -49,11 +62,55 @@ public:
     // Register a callback to use USB HID device events (e.g. LVGL input device)
     void registerHIDCallback(std::function<void(const UsbHidEvent&)> callback) {};  // TODO
 
-    // Reporters
+    // Use report protocol for boot keyboards when the report descriptor can be decoded (e.g. NKRO keyboards).
+    // Boot protocol remains the fallback. Takes effect for devices connected afterwards.
+    void setKeyboardReportProtocol(bool enable) { keyboardReportProtocol = enable; }
+
+    // Use report protocol for boot mice (16-bit deltas, wheel, AC pan, up to 16 buttons).
+    // Boot protocol remains the fallback. Takes effect for devices connected afterwards.
+    void setMouseReportProtocol(bool enable) { mouseReportProtocol = enable; }
+
+    // Read each device's current input report with GET_REPORT at connect, before streaming starts,
+    // so keys and buttons already held at plug-in are seen. Takes effect for devices connected afterwards.
+    void setInitialStateSync(bool enable) { initialStateSync = enable; }
+
+    // Generate typematic repeats for held keyboard keys, driven by the shared timer wheel.
+    // Not from inside an event callback: such calls are logged and ignored.
+    void setKeyRepeat(uint32_t delayMs, uint32_t intervalMs);
+    void disableKeyRepeat();
+
+    // Per keyboard model, by VID/PID: replace the setting above or turn repeat off for it.
+    // useDefaultKeyRepeat() returns the model to the setting above. Applies to connected keyboards too.
+    void setKeyRepeat(uint16_t vid, uint16_t pid, uint32_t delayMs, uint32_t intervalMs);
+    void disableKeyRepeat(uint16_t vid, uint16_t pid);
+    void useDefaultKeyRepeat(uint16_t vid, uint16_t pid);
+
+    // Hotkeys over keyboard and G20s Pro edges. Register hotkeys before start().
+    UsbHidHotkeyMatcher* hotkeys() { return &hotkeyMatcher; }
+
+    // Accelerated absolute cursor from mouse and G20s Pro motion. Configure before start().
+    UsbHidPointerProcessor* pointer() { return &pointerProcessor; }
+
+    // Click, double-click and long press from mouse button edges; idle until a callback is registered
+    UsbHidMouseGestures* mouseGestures() { return &mouseGestureDetector; }
+
+    // Decode another vendor air remote through the remote report. Profiles added here are
+    // matched by VID/PID before the built-in G20s Pro profile. The profile is compiled into
+    // a copy, only its name strings must outlive the host. Call before start(). Returns
+    // false if the profile is invalid.
+    bool addRemoteProfile(const UsbHidRemoteProfile& profile);
+
+    // Reporters. Each delivers the events of every device of its kind: the first boot keyboard and
+    // mouse feed their reporter directly, other interfaces and all remotes get decoders of their own
+    // that forward their events here. State getters such as getLedState() describe the directly fed
+    // device. A motion filter set on the remote reporter applies to remotes connected afterwards.
     UsbHidG20sProReport* reportG20sPro() { return &g20sProReport; }
     UsbHidKeyboardReport* reportKeyboard() { return &keyboardReport; }
     UsbHidMouseReport* reportMouse() { return &mouseReport; }
     UsbHidGenericReport* reportGeneric() { return &genericReport; }
+    UsbHidGamepadReport* reportGamepad() { return &gamepadReport; }
+    UsbHidConsumerReport* reportConsumer() { return &consumerReport; }
+    UsbHidDigitizerReport* reportDigitizer() { return &digitizerReport; }
 
 private:
     static constexpr const char* TAG                         = "UsbHidHost";
@@ -61,23 +118,84 @@ private:
     static constexpr size_t USB_TASK_STACK_SIZE              = 8192;
     static constexpr UBaseType_t USB_TASK_PRIORITY           = 2;
     static constexpr UBaseType_t HID_PROCESSOR_TASK_PRIORITY = 5;
+    static constexpr size_t TIMER_TASK_STACK_SIZE            = 4096;
+    static constexpr UBaseType_t TIMER_TASK_PRIORITY         = 5;
+    static constexpr uint32_t TIMER_WHEEL_TICK_MS            = 5;
+    static constexpr size_t LED_TASK_STACK_SIZE              = 3072;
+    static constexpr UBaseType_t LED_TASK_PRIORITY           = 3;
 
     UsbHidG20sProReport g20sProReport;
     UsbHidKeyboardReport keyboardReport;
     UsbHidMouseReport mouseReport;
     UsbHidGenericReport genericReport;
+    UsbHidGamepadReport gamepadReport;
+    UsbHidConsumerReport consumerReport;
 
     QueueHandle_t eventQueue;  // FreeRTOS queue for incoming USB events
 
+    bool keyboardReportProtocol;  // Try report protocol before boot protocol for keyboards
+    bool mouseReportProtocol;     // Try report protocol before boot protocol for mice
+    bool initialStateSync;        // GET_REPORT(Input) at connect to seed report state
+
+    UsbHidTimerWheel timerWheel;   // Shared software timers (key repeat, ...)
+    UsbHidHotkeyMatcher hotkeyMatcher;
+    UsbHidPointerProcessor pointerProcessor;
+    UsbHidMouseGestures mouseGestureDetector;
+    UsbHidDigitizerReport digitizerReport;  // Timestamps frames from timerWheel
+    SemaphoreHandle_t inputMutex;  // Serialises report processing and timer wheel callbacks
+
     TaskHandle_t hidProcessorTaskHandle;
     TaskHandle_t usbLibTaskHandle;
+    TaskHandle_t timerTaskHandle;
+    TaskHandle_t ledTaskHandle;                     // Sends LED output reports to every keyboard
+    hid_host_device_handle_t bootKeyboardHandle;    // Boot keyboard feeding keyboardReport, guarded by inputMutex
+    hid_host_device_handle_t bootMouseHandle;       // Boot mouse feeding mouseReport, guarded by inputMutex
+    hid_host_device_handle_t ledTransferDevice;     // Keyboard an LED report is being sent to, guarded by inputMutex
+    hid_host_device_handle_t ledClosingDevice;      // Disconnected during its LED transfer, guarded by inputMutex
+    uint32_t bootKeyboardId;                        // VID << 16 | PID of the boot keyboard, guarded by inputMutex
+    std::optional<UsbHidKeyRepeater::Config> keyRepeat;  // For keyboards without an override, guarded by inputMutex
+    // Per VID << 16 | PID, nullopt turns repeat off, guarded by inputMutex
+    std::map<uint32_t, std::optional<UsbHidKeyRepeater::Config>> keyRepeatOverrides;
     std::vector<hid_host_device_handle_t> connectedDevices;
+    std::vector<std::unique_ptr<UsbHidRemoteDecoder>> remoteProfiles;  // Compiled addRemoteProfile() profiles
+
+    struct RouteDecoder
+    {
+        UsbHidDeviceClass deviceClass;              // Class of the report, Unknown generic, Vendor a remote
+        std::unique_ptr<UsbHidReportSink> report;  // Forwards its events to the reporter of its class
+    };
+    struct DeviceRoute
+    {
+        static constexpr uint8_t NO_DECODER = 0xFF;
+
+        hid_host_device_handle_t handle;
+        uint32_t deviceId;                      // VID << 16 | PID
+        UsbHidDeviceClass deviceClass;          // Primary class
+        bool usesReportIds;                     // Reports are routed by their first byte
+        uint8_t syncReportId;                   // Input report fetched at connect
+        uint16_t classes;                       // Bit per class of the decoders
+        std::vector<RouteDecoder> decoders;     // State of this interface only, released at disconnect
+        std::array<uint8_t, 256> decoderIndex;  // Report ID to its decoder, NO_DECODER drops the report
+    };
+    UsbHidDeviceClassifier deviceClassifier;  // Parsed descriptors cached by their bytes
+    std::vector<DeviceRoute> deviceRoutes;    // Interfaces with their own decoders, guarded by inputMutex
 
     static void usbLibTask(void* pvParameters);
 
     static void hidEventProcessorTaskTrampoline(void* arg);
     void hidEventProcessorTask();
 
+    static void timerTaskTrampoline(void* arg);
+    void timerTask();
+    static uint32_t nowMs();
+
+    static void ledTaskTrampoline(void* arg);
+    void ledTask();
+    void requestLedUpdate(uint8_t leds);
+    void onLedStateChanged(uint8_t leds);
+
+    const UsbHidRemoteDecoder* findRemoteProfile(uint16_t vid, uint16_t pid) const;
+
     static void hidHostDeviceCallback(hid_host_device_handle_t hid_device_handle,
                                       const hid_host_driver_event_t event,
                                       void* arg);
@@ -92,5 +210,39 @@ private:
 
     void addEventToQueue(const UsbHidEvent& event);
 
+    // True, with an error logged, when called from a callback that holds inputMutex
+    bool inInputCallback(const char* caller) const;
+
+    // Release held keys/buttons of a disconnected device and drop its decoders
+    void releaseDeviceState(hid_host_device_handle_t hid_device_handle);
+
+    // Set up a boot interface, false if it cannot be used
+    bool openBootInterface(hid_host_device_handle_t hid_device_handle, const hid_host_dev_params_t& devParams);
+    hid_report_protocol_t selectKeyboardProtocol(hid_host_device_handle_t hid_device_handle,
+                                                 UsbHidKeyboardReport& keyboard);
+    hid_report_protocol_t selectMouseProtocol(hid_host_device_handle_t hid_device_handle, UsbHidMouseReport& mouse);
+
+    // Classify a non-boot interface by its application collections and make its decoders
+    void classifyInterface(hid_host_device_handle_t hid_device_handle);
+    void addRemoteRoute(hid_host_device_handle_t hid_device_handle, const UsbHidRemoteDecoder& profile);
+    std::unique_ptr<UsbHidReportSink> makeDecoder(UsbHidDeviceClass deviceClass, const UsbHidReportDescriptor& descriptor,
+                                                  const hid_host_dev_info_t& devInfo);
+    uint8_t addDecoder(DeviceRoute& route, UsbHidDeviceClass deviceClass, const UsbHidReportDescriptor* descriptor,
+                       const hid_host_dev_info_t& devInfo);
+    void shareKeyboardState(UsbHidKeyboardReport& keyboard, uint32_t deviceId);
+    static uint32_t deviceIdOf(const hid_host_dev_info_t& devInfo) { return (uint32_t{devInfo.VID} << 16) | devInfo.PID; }
+    const std::optional<UsbHidKeyRepeater::Config>& keyRepeatFor(uint32_t deviceId) const;
+    void applyKeyRepeat(UsbHidKeyboardReport& keyboard, uint32_t deviceId);
+    void applyKeyRepeatToAll();
+    void forEachRouteKeyboard(const std::function<void(UsbHidKeyboardReport&)>& function);
+    const DeviceRoute* findRoute(hid_host_device_handle_t hid_device_handle) const;
+
+    // Route an input report to the report class handling the device, caller holds inputMutex
+    void dispatchReport(hid_host_device_handle_t hid_device_handle, const hid_host_dev_params_t& devParams,
+                        const uint8_t* data, size_t length);
+
+    // Seed report state from GET_REPORT(Input), called before hid_host_device_start
+    void syncInitialState(hid_host_device_handle_t hid_device_handle, const hid_host_dev_params_t& devParams);
+
     // static bool usbEnumerationFilterCallback(const usb_device_desc_t* dev_desc, uint8_t* bConfigurationValue);
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 // --- START OF FILE UsbHidHost.cpp ---
 #include "UsbHidHost.h"
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
 
 /**
  * @brief HID Protocol string names
@@ -11,14 +12,41 @@ static const std::vector<std::string> HID_PROTO_NAMES = {
     "Mouse"};
 
 UsbHidHost::UsbHidHost()
-    : hidProcessorTaskHandle(nullptr),
-      usbLibTaskHandle(nullptr)
+    : keyboardReportProtocol(false),
+      mouseReportProtocol(false),
+      initialStateSync(false),
+      timerWheel(TIMER_WHEEL_TICK_MS, nowMs()),
+      hotkeyMatcher(timerWheel),
+      mouseGestureDetector(timerWheel),
+      digitizerReport(timerWheel),
+      hidProcessorTaskHandle(nullptr),
+      usbLibTaskHandle(nullptr),
+      timerTaskHandle(nullptr),
+      ledTaskHandle(nullptr),
+      bootKeyboardHandle(nullptr),
+      bootMouseHandle(nullptr),
+      ledTransferDevice(nullptr),
+      ledClosingDevice(nullptr),
+      bootKeyboardId(0)
 {
     eventQueue = xQueueCreate(EVENT_QUEUE_SIZE, sizeof(UsbHidEvent));
     if (eventQueue == nullptr)
     {
         ESP_LOGE(TAG, "Failed to create USB event queue");
     }
+
+    inputMutex = xSemaphoreCreateMutex();
+    if (inputMutex == nullptr)
+    {
+        ESP_LOGE(TAG, "Failed to create input mutex");
+    }
+
+    keyboardReport.registerCallback([this](const UsbHidKeyboardEvent& event) { hotkeyMatcher.onKeyboardEvent(event); });
+    g20sProReport.registerCallback([this](const UsbHidG20sProEvent& event) { hotkeyMatcher.onRemoteEvent(event); });
+    mouseReport.registerCallback([this](const UsbHidMouseEvent& event) { pointerProcessor.onMouseEvent(event); });
+    mouseReport.registerCallback([this](const UsbHidMouseEvent& event) { mouseGestureDetector.onMouseEvent(event); });
+    g20sProReport.registerCallback([this](const UsbHidG20sProEvent& event) { pointerProcessor.onRemoteEvent(event); });
+    keyboardReport.registerLedCallback([this](uint8_t leds) { onLedStateChanged(leds); });
 }
 
 UsbHidHost::~UsbHidHost()
@@ -28,6 +56,10 @@ UsbHidHost::~UsbHidHost()
     {
         vQueueDelete(eventQueue);
     }
+    if (inputMutex != nullptr)
+    {
+        vSemaphoreDelete(inputMutex);
+    }
 }
 
 esp_err_t UsbHidHost::init()
@@ -79,6 +111,18 @@ esp_err_t UsbHidHost::deinit()
         hidProcessorTaskHandle = nullptr;
     }
 
+    if (timerTaskHandle != nullptr)
+    {
+        vTaskDelete(timerTaskHandle);
+        timerTaskHandle = nullptr;
+    }
+
+    if (ledTaskHandle != nullptr)
+    {
+        vTaskDelete(ledTaskHandle);
+        ledTaskHandle = nullptr;
+    }
+
     if (usbLibTaskHandle != nullptr)
     {
         // Wait for the USB lib task to finish
@@ -121,6 +165,34 @@ esp_err_t UsbHidHost::start()
         return ESP_FAIL;
     }
 
+    task_created = xTaskCreate(
+        timerTaskTrampoline,
+        "hidTimers",
+        TIMER_TASK_STACK_SIZE,
+        this,
+        TIMER_TASK_PRIORITY,
+        &timerTaskHandle);
+
+    if (task_created != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create HID timer task");
+        return ESP_FAIL;
+    }
+
+    task_created = xTaskCreate(
+        ledTaskTrampoline,
+        "hidLeds",
+        LED_TASK_STACK_SIZE,
+        this,
+        LED_TASK_PRIORITY,
+        &ledTaskHandle);
+
+    if (task_created != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create HID LED task");
+        return ESP_FAIL;
+    }
+
     // Force connected devices to be re-enumerated
 
     return ESP_OK;
@@ -133,9 +205,175 @@ esp_err_t UsbHidHost::stop()
         vTaskDelete(hidProcessorTaskHandle);
         hidProcessorTaskHandle = nullptr;
     }
+
+    if (timerTaskHandle != nullptr)
+    {
+        vTaskDelete(timerTaskHandle);
+        timerTaskHandle = nullptr;
+    }
+
+    if (ledTaskHandle != nullptr)
+    {
+        vTaskDelete(ledTaskHandle);
+        ledTaskHandle = nullptr;
+    }
     return ESP_OK;
 }
 
+void UsbHidHost::setKeyRepeat(uint32_t delayMs, uint32_t intervalMs)
+{
+    if (inInputCallback("setKeyRepeat"))
+    {
+        return;
+    }
+    xSemaphoreTake(inputMutex, portMAX_DELAY);
+    keyRepeat = UsbHidKeyRepeater::Config{delayMs, intervalMs};
+    applyKeyRepeatToAll();
+    xSemaphoreGive(inputMutex);
+}
+
+void UsbHidHost::disableKeyRepeat()
+{
+    if (inInputCallback("disableKeyRepeat"))
+    {
+        return;
+    }
+    xSemaphoreTake(inputMutex, portMAX_DELAY);
+    keyRepeat.reset();
+    applyKeyRepeatToAll();
+    xSemaphoreGive(inputMutex);
+}
+
+void UsbHidHost::setKeyRepeat(uint16_t vid, uint16_t pid, uint32_t delayMs, uint32_t intervalMs)
+{
+    if (inInputCallback("setKeyRepeat"))
+    {
+        return;
+    }
+    xSemaphoreTake(inputMutex, portMAX_DELAY);
+    keyRepeatOverrides[(uint32_t{vid} << 16) | pid] = UsbHidKeyRepeater::Config{delayMs, intervalMs};
+    applyKeyRepeatToAll();
+    xSemaphoreGive(inputMutex);
+}
+
+void UsbHidHost::disableKeyRepeat(uint16_t vid, uint16_t pid)
+{
+    if (inInputCallback("disableKeyRepeat"))
+    {
+        return;
+    }
+    xSemaphoreTake(inputMutex, portMAX_DELAY);
+    keyRepeatOverrides[(uint32_t{vid} << 16) | pid] = std::nullopt;
+    applyKeyRepeatToAll();
+    xSemaphoreGive(inputMutex);
+}
+
+void UsbHidHost::useDefaultKeyRepeat(uint16_t vid, uint16_t pid)
+{
+    if (inInputCallback("useDefaultKeyRepeat"))
+    {
+        return;
+    }
+    xSemaphoreTake(inputMutex, portMAX_DELAY);
+    keyRepeatOverrides.erase((uint32_t{vid} << 16) | pid);
+    applyKeyRepeatToAll();
+    xSemaphoreGive(inputMutex);
+}
+
+/**
+ * @brief Get the key repeat setting of a keyboard model
+ *
+ * The caller holds inputMutex.
+ *
+ * @return The model's override if there is one, the setKeyRepeat() default otherwise; nullopt for no repeat
+ */
+const std::optional<UsbHidKeyRepeater::Config>& UsbHidHost::keyRepeatFor(uint32_t deviceId) const
+{
+    const auto found = keyRepeatOverrides.find(deviceId);
+    return found != keyRepeatOverrides.end() ? found->second : keyRepeat;
+}
+
+void UsbHidHost::applyKeyRepeat(UsbHidKeyboardReport& keyboard, uint32_t deviceId)
+{
+    const std::optional<UsbHidKeyRepeater::Config>& config = keyRepeatFor(deviceId);
+    if (config)
+    {
+        keyboard.enableKeyRepeat(timerWheel, *config);
+    }
+    else
+    {
+        keyboard.disableKeyRepeat();
+    }
+}
+
+/**
+ * @brief Apply the key repeat settings to keyboardReport and every keyboard decoder
+ *
+ * keyboardReport follows the boot keyboard feeding it, or the default without one.
+ * The caller holds inputMutex.
+ */
+void UsbHidHost::applyKeyRepeatToAll()
+{
+    applyKeyRepeat(keyboardReport, bootKeyboardHandle != nullptr ? bootKeyboardId : 0);
+    for (DeviceRoute& route : deviceRoutes)
+    {
+        for (RouteDecoder& decoder : route.decoders)
+        {
+            if (decoder.deviceClass == UsbHidDeviceClass::Keyboard)
+            {
+                applyKeyRepeat(static_cast<UsbHidKeyboardReport&>(*decoder.report), route.deviceId);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Refuse a call made from an event or timer callback
+ *
+ * Callbacks run with inputMutex held, which is not recursive. Taking it again would
+ * deadlock, and replacing the repeater from its own repeat callback would destroy the
+ * timer that is firing, so such calls are logged and ignored.
+ */
+bool UsbHidHost::inInputCallback(const char* caller) const
+{
+    if (xSemaphoreGetMutexHolder(inputMutex) != xTaskGetCurrentTaskHandle())
+    {
+        return false;
+    }
+    ESP_LOGE(TAG, "%s() called from an input callback, ignored", caller);
+    return true;
+}
+
+bool UsbHidHost::addRemoteProfile(const UsbHidRemoteProfile& profile)
+{
+    auto decoder = std::make_unique<UsbHidRemoteDecoder>(profile);
+    if (!decoder->isValid())
+    {
+        ESP_LOGE(TAG, "Remote profile %.*s is ambiguous or exceeds the decoder limits",
+                 static_cast<int>(profile.name.size()), profile.name.data());
+        return false;
+    }
+
+    remoteProfiles.push_back(std::move(decoder));
+    ESP_LOGI(TAG, "Added remote profile %.*s (%04X:%04X)",
+             static_cast<int>(profile.name.size()), profile.name.data(), profile.vid, profile.pid);
+    return true;
+}
+
+const UsbHidRemoteDecoder* UsbHidHost::findRemoteProfile(uint16_t vid, uint16_t pid) const
+{
+    for (const auto& decoder : remoteProfiles)
+    {
+        if (decoder->matches(vid, pid))
+        {
+            return decoder.get();
+        }
+    }
+
+    const UsbHidRemoteDecoder& builtIn = UsbHidG20sProReport::g20sProDecoder();
+    return builtIn.matches(vid, pid) ? &builtIn : nullptr;
+}
+
 /**
  * @brief Start USB Host install and handle common USB host library events while app pin not low
  *
@@ -272,6 +510,164 @@ void UsbHidHost::hidEventProcessorTask()
     }
 }
 
+void UsbHidHost::timerTaskTrampoline(void* arg)
+{
+    static_cast<UsbHidHost*>(arg)->timerTask();
+}
+
+/**
+ * @brief Drive the shared timer wheel
+ *
+ * Sleeps until the earliest armed timer is due, or indefinitely when none is armed.
+ * The input path notifies this task whenever it may have armed a timer.
+ */
+void UsbHidHost::timerTask()
+{
+    while (1)
+    {
+        xSemaphoreTake(inputMutex, portMAX_DELAY);
+        timerWheel.advance(nowMs());
+        UsbHidTimerWheel::Millis delayMs = 0;
+        const bool armed                 = timerWheel.timeToNextExpiry(delayMs);
+        xSemaphoreGive(inputMutex);
+
+        TickType_t xTicksToWait = portMAX_DELAY;
+        if (armed)
+        {
+            xTicksToWait = pdMS_TO_TICKS(delayMs);
+            if (xTicksToWait == 0)
+            {
+                xTicksToWait = 1;
+            }
+        }
+        ulTaskNotifyTake(pdTRUE, xTicksToWait);
+    }
+}
+
+uint32_t UsbHidHost::nowMs()
+{
+    return static_cast<uint32_t>(esp_timer_get_time() / 1000);
+}
+
+void UsbHidHost::ledTaskTrampoline(void* arg)
+{
+    static_cast<UsbHidHost*>(arg)->ledTask();
+}
+
+/**
+ * @brief Send keyboard LED output reports
+ *
+ * The input path posts the latest LED state with eSetValueWithOverwrite, so a burst of
+ * lock key presses collapses into a single SET_REPORT per keyboard carrying the final
+ * state. Every keyboard gets it: the boot keyboard feeding keyboardReport and the keyboard
+ * decoders of all routes, each in the layout of its own descriptor. The control transfers
+ * run here and never block report processing.
+ *
+ * A device is only sent to while it is open. When a keyboard disconnects during its
+ * transfer, the callback leaves the close to this task, which closes it once the
+ * transfer has returned.
+ */
+void UsbHidHost::ledTask()
+{
+    struct LedReport
+    {
+        hid_host_device_handle_t device;
+        uint8_t reportId;
+        size_t length;
+        uint8_t data[UsbHidKeyboardReport::MAX_LED_REPORT_SIZE];
+    };
+    std::vector<LedReport> reports;
+
+    uint32_t leds = 0;
+    while (1)
+    {
+        xTaskNotifyWait(0, UINT32_MAX, &leds, portMAX_DELAY);
+
+        xSemaphoreTake(inputMutex, portMAX_DELAY);
+        reports.clear();
+        const auto build = [&reports, leds](hid_host_device_handle_t device, const UsbHidKeyboardReport& keyboard)
+        {
+            LedReport report = {device, 0, 0, {}};
+            report.length    = keyboard.buildLedReport(static_cast<uint8_t>(leds), report.data, sizeof(report.data),
+                                                       report.reportId);
+            if (report.length > 0)
+            {
+                reports.push_back(report);
+            }
+        };
+        if (bootKeyboardHandle != nullptr)
+        {
+            build(bootKeyboardHandle, keyboardReport);
+        }
+        for (const DeviceRoute& route : deviceRoutes)
+        {
+            for (const RouteDecoder& decoder : route.decoders)
+            {
+                if (decoder.deviceClass == UsbHidDeviceClass::Keyboard)
+                {
+                    build(route.handle, static_cast<const UsbHidKeyboardReport&>(*decoder.report));
+                }
+            }
+        }
+        xSemaphoreGive(inputMutex);
+
+        for (LedReport& report : reports)
+        {
+            // Skip keyboards disconnected since the reports were built
+            xSemaphoreTake(inputMutex, portMAX_DELAY);
+            const bool open   = report.device == bootKeyboardHandle || findRoute(report.device) != nullptr;
+            ledTransferDevice = open ? report.device : nullptr;
+            xSemaphoreGive(inputMutex);
+            if (!open)
+            {
+                continue;
+            }
+
+            // The HID driver has no interrupt OUT support, use SET_REPORT on the control pipe
+            esp_err_t err = hid_class_request_set_report(report.device, HID_REPORT_TYPE_OUTPUT, report.reportId,
+                                                         report.data, report.length);
+            if (err != ESP_OK)
+            {
+                ESP_LOGW(TAG, "Failed to set keyboard LEDs: %s", esp_err_to_name(err));
+            }
+
+            xSemaphoreTake(inputMutex, portMAX_DELAY);
+            ledTransferDevice = nullptr;
+            const bool closing = ledClosingDevice == report.device;
+            if (closing)
+            {
+                ledClosingDevice = nullptr;
+            }
+            xSemaphoreGive(inputMutex);
+            if (closing)
+            {
+                ESP_ERROR_CHECK(hid_host_device_close(report.device));
+            }
+        }
+    }
+}
+
+void UsbHidHost::requestLedUpdate(uint8_t leds)
+{
+    if (ledTaskHandle != nullptr)
+    {
+        xTaskNotify(ledTaskHandle, leds, eSetValueWithOverwrite);
+    }
+}
+
+/**
+ * @brief Show a new lock LED state on every keyboard
+ *
+ * Called when keyboardReport's LED state changes, whichever keyboard pressed the lock key.
+ * Keyboards with their own decoder take the state over, so their next lock key toggles
+ * the shared state. The caller holds inputMutex.
+ */
+void UsbHidHost::onLedStateChanged(uint8_t leds)
+{
+    forEachRouteKeyboard([leds](UsbHidKeyboardReport& keyboard) { keyboard.setLedState(leds); });
+    requestLedUpdate(leds);
+}
+
 void UsbHidHost::hidHostDeviceCallback(hid_host_device_handle_t hid_device_handle,
                                        const hid_host_driver_event_t event,
                                        void* arg)
@@ -303,9 +699,6 @@ void UsbHidHost::hidHostInterfaceCallback(hid_host_device_handle_t hid_device_ha
     hid_host_dev_params_t dev_params;
     ESP_ERROR_CHECK(hid_host_device_get_params(hid_device_handle, &dev_params));
 
-    hid_host_dev_info_t dev_info;
-    ESP_ERROR_CHECK(hid_host_get_device_info(hid_device_handle, &dev_info));
-
     UsbHidHost& self = *static_cast<UsbHidHost*>(arg);
 
     switch (event)
@@ -316,38 +709,39 @@ void UsbHidHost::hidHostInterfaceCallback(hid_host_device_handle_t hid_device_ha
                                                                   sizeof(data),
                                                                   &data_length));
 
-        if (dev_info.VID == 0x0C40 && dev_info.PID == 0x7A1C)  // G20s Pro
-        {
-            self.g20sProReport.processReportData(data, data_length);
-        }
-        else if (HID_SUBCLASS_BOOT_INTERFACE == dev_params.sub_class)
-        {
-            if (HID_PROTOCOL_KEYBOARD == dev_params.proto)
-            {
-                self.keyboardReport.processReportData(data, data_length);
-            }
-            else if (HID_PROTOCOL_MOUSE == dev_params.proto)
-            {
-                self.mouseReport.processReportData(data, data_length);
-            }
-            else
-            {
-                // Handle other boot interface devices if needed
-                ESP_LOGW(TAG, "Unhandled boot interface device");
-            }
-        }
-        else
+        xSemaphoreTake(self.inputMutex, portMAX_DELAY);
+        self.timerWheel.advance(nowMs());
+        self.dispatchReport(hid_device_handle, dev_params, data, data_length);
+
+        // The report may have armed timers, let the timer task recompute its deadline
+        if (self.timerWheel.armedCount() > 0 && self.timerTaskHandle != nullptr)
         {
-            // Handle other generic devices if needed
-            ESP_LOGW(TAG, "Unhandled generic HID device");
+            xTaskNotifyGive(self.timerTaskHandle);
         }
+        xSemaphoreGive(self.inputMutex);
         break;
 
     case HID_HOST_INTERFACE_EVENT_DISCONNECTED:
+    {
         ESP_LOGW(TAG, "HID Device, protocol '%s' DISCONNECTED",
                  HID_PROTO_NAMES[dev_params.proto].c_str());
-        ESP_ERROR_CHECK(hid_host_device_close(hid_device_handle));
+        xSemaphoreTake(self.inputMutex, portMAX_DELAY);
+        self.releaseDeviceState(hid_device_handle);
+        // The LED task may be sending to the device. Its transfer completes in this task's
+        // event handling, so waiting here would stall every device: the LED task closes it instead.
+        const bool ledTransfer = self.ledTransferDevice == hid_device_handle;
+        if (ledTransfer)
+        {
+            self.ledClosingDevice = hid_device_handle;
+        }
+        xSemaphoreGive(self.inputMutex);
+
+        if (!ledTransfer)
+        {
+            ESP_ERROR_CHECK(hid_host_device_close(hid_device_handle));
+        }
         break;
+    }
 
     case HID_HOST_INTERFACE_EVENT_TRANSFER_ERROR:
         ESP_LOGW(TAG, "HID Device, protocol '%s' TRANSFER_ERROR",
@@ -361,6 +755,141 @@ void UsbHidHost::hidHostInterfaceCallback(hid_host_device_handle_t hid_device_ha
     }
 }
 
+/**
+ * @brief Route an input report to the report class handling the device
+ *
+ * The caller holds inputMutex.
+ */
+void UsbHidHost::dispatchReport(hid_host_device_handle_t hid_device_handle, const hid_host_dev_params_t& devParams,
+                                const uint8_t* data, size_t length)
+{
+    if (hid_device_handle == bootKeyboardHandle)
+    {
+        keyboardReport.processReportData(data, length);
+    }
+    else if (hid_device_handle == bootMouseHandle)
+    {
+        mouseReport.processReportData(data, length);
+    }
+    else if (const DeviceRoute* route = findRoute(hid_device_handle))
+    {
+        // One table lookup picks the decoder of composite interfaces, e.g. media keys of a keyboard
+        if (length > 0 || !route->usesReportIds)
+        {
+            const uint8_t index = route->decoderIndex[route->usesReportIds ? data[0] : 0];
+            if (index != DeviceRoute::NO_DECODER)
+            {
+                route->decoders[index].report->processReportData(data, length);
+            }
+        }
+    }
+    else if (HID_SUBCLASS_BOOT_INTERFACE == devParams.sub_class)
+    {
+        // Handle other boot interface devices if needed
+        ESP_LOGW(TAG, "Unhandled boot interface device");
+    }
+    else
+    {
+        genericReport.processReportData(data, length);
+    }
+}
+
+/**
+ * @brief Seed report state from the device's current input report
+ *
+ * Runs in the event processor task while the device is open but not started, so no
+ * interrupt report can interleave. Devices that do not support GET_REPORT (it is
+ * optional for boot devices) simply start from an empty state.
+ */
+void UsbHidHost::syncInitialState(hid_host_device_handle_t hid_device_handle, const hid_host_dev_params_t& devParams)
+{
+    // The route table and the report layouts are shared with the event task,
+    // only the request itself runs without the lock
+    xSemaphoreTake(inputMutex, portMAX_DELAY);
+    uint8_t reportId = 0;
+    if (hid_device_handle == bootKeyboardHandle)
+    {
+        reportId = keyboardReport.getInputReportId();
+    }
+    else if (hid_device_handle == bootMouseHandle)
+    {
+        reportId = mouseReport.getInputReportId();
+    }
+    else if (const DeviceRoute* route = findRoute(hid_device_handle))
+    {
+        reportId = route->syncReportId;
+    }
+    xSemaphoreGive(inputMutex);
+
+    uint8_t data[64]   = {0};
+    size_t data_length = sizeof(data);
+    esp_err_t err      = hid_class_request_get_report(hid_device_handle, HID_REPORT_TYPE_INPUT, reportId, data, &data_length);
+    if (err != ESP_OK || data_length == 0)
+    {
+        ESP_LOGI(TAG, "Initial state not available: %s", esp_err_to_name(err));
+        return;
+    }
+
+    xSemaphoreTake(inputMutex, portMAX_DELAY);
+    timerWheel.advance(nowMs());
+    dispatchReport(hid_device_handle, devParams, data, data_length);
+    if (timerWheel.armedCount() > 0 && timerTaskHandle != nullptr)
+    {
+        xTaskNotifyGive(timerTaskHandle);
+    }
+    xSemaphoreGive(inputMutex);
+}
+
+/**
+ * @brief Release held keys and buttons of a disconnected device
+ *
+ * Uses the same routing as the input path, so only the state the device fed is
+ * touched: keys another keyboard holds stay down. Runs in the disconnect callback
+ * under inputMutex, the release events are delivered before it returns.
+ */
+void UsbHidHost::releaseDeviceState(hid_host_device_handle_t hid_device_handle)
+{
+    if (hid_device_handle == bootKeyboardHandle)
+    {
+        keyboardReport.releaseAll();
+    }
+    else if (hid_device_handle == bootMouseHandle)
+    {
+        // A release forced by the disconnect is not a click
+        mouseGestureDetector.reset();
+        mouseReport.releaseAll();
+    }
+    else if (const DeviceRoute* route = findRoute(hid_device_handle))
+    {
+        for (const RouteDecoder& decoder : route->decoders)
+        {
+            if (decoder.deviceClass == UsbHidDeviceClass::Mouse)
+            {
+                mouseGestureDetector.reset();
+            }
+            decoder.report->releaseAll();
+        }
+
+        deviceRoutes.erase(std::remove_if(deviceRoutes.begin(), deviceRoutes.end(),
+                                          [hid_device_handle](const DeviceRoute& route)
+                                          { return route.handle == hid_device_handle; }),
+                           deviceRoutes.end());
+    }
+
+    // The next boot keyboard or mouse feeds the reporters directly again
+    if (hid_device_handle == bootKeyboardHandle)
+    {
+        bootKeyboardHandle = nullptr;
+    }
+    if (hid_device_handle == bootMouseHandle)
+    {
+        bootMouseHandle = nullptr;
+    }
+
+    // The releases above cleared the matcher's held keys, drop sequences in progress too
+    hotkeyMatcher.cancelSequences();
+}
+
 /**
  * @brief USB HID Host Device event
  *
@@ -398,22 +927,19 @@ void UsbHidHost::handleHidHostEvent(hid_host_device_handle_t hid_device_handle,
             // Device opened successfully
             if (HID_SUBCLASS_BOOT_INTERFACE == dev_params.sub_class)
             {
-                err = hid_class_request_set_protocol(hid_device_handle, HID_REPORT_PROTOCOL_BOOT);
-                if (err != ESP_OK)
+                if (!openBootInterface(hid_device_handle, dev_params))
                 {
-                    ESP_LOGE(TAG, "Failed to set boot protocol: %s", esp_err_to_name(err));
                     break;
                 }
+            }
+            else
+            {
+                classifyInterface(hid_device_handle);
+            }
 
-                if (HID_PROTOCOL_KEYBOARD == dev_params.proto)
-                {
-                    err = hid_class_request_set_idle(hid_device_handle, 0, 0);
-                    if (err != ESP_OK)
-                    {
-                        ESP_LOGE(TAG, "Failed to set idle: %s", esp_err_to_name(err));
-                        break;
-                    }
-                }
+            if (initialStateSync)
+            {
+                syncInitialState(hid_device_handle, dev_params);
             }
 
             err = hid_host_device_start(hid_device_handle);
@@ -440,6 +966,462 @@ void UsbHidHost::handleHidHostEvent(hid_host_device_handle_t hid_device_handle,
     }
 }
 
+/**
+ * @brief Set up a boot interface and choose the report it feeds
+ *
+ * The first boot keyboard and mouse feed keyboardReport and mouseReport directly. One
+ * connected while such a device is running gets a decoder of its own, so the layout the
+ * running device is decoded with is never replaced. Boot interfaces of remotes get a
+ * remote report of their own instead.
+ *
+ * @return false if the protocol or idle rate could not be set, the device is not started then
+ */
+bool UsbHidHost::openBootInterface(hid_host_device_handle_t hid_device_handle, const hid_host_dev_params_t& devParams)
+{
+    // Remotes get a remote report of their own: boot protocol, and no keyboard or mouse slot
+    hid_host_dev_info_t devInfo        = {};
+    const UsbHidRemoteDecoder* profile = hid_host_get_device_info(hid_device_handle, &devInfo) == ESP_OK
+                                             ? findRemoteProfile(devInfo.VID, devInfo.PID)
+                                             : nullptr;
+    const bool remote                  = profile != nullptr;
+    const bool keyboardInterface = !remote && HID_PROTOCOL_KEYBOARD == devParams.proto;
+    const bool mouseInterface    = !remote && HID_PROTOCOL_MOUSE == devParams.proto;
+
+    // Boot devices are only claimed by this task, the disconnect callback can only free a slot
+    xSemaphoreTake(inputMutex, portMAX_DELAY);
+    const bool direct = (keyboardInterface && bootKeyboardHandle == nullptr) ||
+                        (mouseInterface && bootMouseHandle == nullptr);
+    xSemaphoreGive(inputMutex);
+
+    std::unique_ptr<UsbHidKeyboardReport> ownKeyboard;
+    std::unique_ptr<UsbHidMouseReport> ownMouse;
+    UsbHidKeyboardReport* keyboard = &keyboardReport;
+    UsbHidMouseReport* mouse       = &mouseReport;
+    if (!direct && keyboardInterface)
+    {
+        ownKeyboard = std::make_unique<UsbHidKeyboardReport>();
+        keyboard    = ownKeyboard.get();
+    }
+    else if (!direct && mouseInterface)
+    {
+        ownMouse = std::make_unique<UsbHidMouseReport>();
+        mouse    = ownMouse.get();
+    }
+
+    hid_report_protocol_t protocol = HID_REPORT_PROTOCOL_BOOT;
+    if (keyboardInterface)
+    {
+        if (keyboardReportProtocol)
+        {
+            protocol = selectKeyboardProtocol(hid_device_handle, *keyboard);
+        }
+        else
+        {
+            keyboard->useBootProtocol();
+        }
+    }
+    else if (mouseInterface)
+    {
+        if (mouseReportProtocol)
+        {
+            protocol = selectMouseProtocol(hid_device_handle, *mouse);
+        }
+        else
+        {
+            mouse->useBootProtocol();
+        }
+    }
+
+    esp_err_t err = hid_class_request_set_protocol(hid_device_handle, protocol);
+    if (err != ESP_OK && protocol == HID_REPORT_PROTOCOL_REPORT)
+    {
+        ESP_LOGW(TAG, "Failed to set report protocol, falling back to boot: %s", esp_err_to_name(err));
+        if (keyboardInterface)
+        {
+            keyboard->useBootProtocol();
+        }
+        else
+        {
+            mouse->useBootProtocol();
+        }
+        err = hid_class_request_set_protocol(hid_device_handle, HID_REPORT_PROTOCOL_BOOT);
+    }
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to set boot protocol: %s", esp_err_to_name(err));
+        return false;
+    }
+
+    if (HID_PROTOCOL_KEYBOARD == devParams.proto)
+    {
+        err = hid_class_request_set_idle(hid_device_handle, 0, 0);
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Failed to set idle: %s", esp_err_to_name(err));
+            return false;
+        }
+    }
+    if (remote)
+    {
+        addRemoteRoute(hid_device_handle, *profile);
+        return true;
+    }
+
+    xSemaphoreTake(inputMutex, portMAX_DELAY);
+    if (direct && keyboardInterface)
+    {
+        bootKeyboardHandle = hid_device_handle;
+        bootKeyboardId     = deviceIdOf(devInfo);
+        applyKeyRepeat(keyboardReport, bootKeyboardId);
+    }
+    else if (direct && mouseInterface)
+    {
+        bootMouseHandle = hid_device_handle;
+    }
+    else if (ownKeyboard || ownMouse)
+    {
+        DeviceRoute route   = {};
+        route.handle        = hid_device_handle;
+        route.deviceId      = deviceIdOf(devInfo);
+        route.usesReportIds = false;
+        route.decoderIndex.fill(DeviceRoute::NO_DECODER);
+        route.decoderIndex[0] = 0;
+        if (ownKeyboard)
+        {
+            shareKeyboardState(*ownKeyboard, route.deviceId);
+            route.deviceClass  = UsbHidDeviceClass::Keyboard;
+            route.syncReportId = ownKeyboard->getInputReportId();
+            route.decoders.push_back({UsbHidDeviceClass::Keyboard, std::move(ownKeyboard)});
+        }
+        else
+        {
+            ownMouse->forwardTo(&mouseReport);
+            route.deviceClass  = UsbHidDeviceClass::Mouse;
+            route.syncReportId = ownMouse->getInputReportId();
+            route.decoders.push_back({UsbHidDeviceClass::Mouse, std::move(ownMouse)});
+        }
+        route.classes = 1u << static_cast<uint8_t>(route.deviceClass);
+        deviceRoutes.push_back(std::move(route));
+    }
+    xSemaphoreGive(inputMutex);
+
+    if (keyboardInterface)
+    {
+        // Show the host lock state on the new keyboard
+        requestLedUpdate(keyboardReport.getLedState());
+    }
+    return true;
+}
+
+/**
+ * @brief Choose the protocol for a boot keyboard from its report descriptor
+ *
+ * @param[in] hid_device_handle  HID Device handle, must be open
+ * @param[in] keyboard           Report decoding the keyboard, not fed by any device yet
+ * @return HID_REPORT_PROTOCOL_REPORT if the keyboard report can decode the descriptor, HID_REPORT_PROTOCOL_BOOT otherwise
+ */
+hid_report_protocol_t UsbHidHost::selectKeyboardProtocol(hid_host_device_handle_t hid_device_handle,
+                                                         UsbHidKeyboardReport& keyboard)
+{
+    size_t length      = 0;
+    const uint8_t* raw = hid_host_get_report_descriptor(hid_device_handle, &length);
+
+    const auto classified = deviceClassifier.classify(raw, length);
+    if (classified->parsed && keyboard.useReportProtocol(classified->descriptor))
+    {
+        return HID_REPORT_PROTOCOL_REPORT;
+    }
+
+    ESP_LOGW(TAG, "Keyboard report descriptor not usable, using boot protocol");
+    keyboard.useBootProtocol();
+    return HID_REPORT_PROTOCOL_BOOT;
+}
+
+hid_report_protocol_t UsbHidHost::selectMouseProtocol(hid_host_device_handle_t hid_device_handle, UsbHidMouseReport& mouse)
+{
+    size_t length      = 0;
+    const uint8_t* raw = hid_host_get_report_descriptor(hid_device_handle, &length);
+
+    const auto classified = deviceClassifier.classify(raw, length);
+    if (classified->parsed && mouse.useReportProtocol(classified->descriptor))
+    {
+        return HID_REPORT_PROTOCOL_REPORT;
+    }
+
+    ESP_LOGW(TAG, "Mouse report descriptor not usable, using boot protocol");
+    mouse.useBootProtocol();
+    return HID_REPORT_PROTOCOL_BOOT;
+}
+
+/**
+ * @brief Classify a non-boot interface by its report descriptor and make its decoders
+ *
+ * Each input report ID gets a decoder for the application collection it belongs to, so a
+ * composite interface has several decoders. They belong to the interface alone: connecting
+ * it never reconfigures a report another device feeds, and its disconnect releases only
+ * what it held.
+ */
+void UsbHidHost::classifyInterface(hid_host_device_handle_t hid_device_handle)
+{
+    hid_host_dev_info_t devInfo = {};
+    if (hid_host_get_device_info(hid_device_handle, &devInfo) == ESP_OK)
+    {
+        if (const UsbHidRemoteDecoder* profile = findRemoteProfile(devInfo.VID, devInfo.PID))
+        {
+            addRemoteRoute(hid_device_handle, *profile);
+            return;
+        }
+    }
+
+    size_t length      = 0;
+    const uint8_t* raw = hid_host_get_report_descriptor(hid_device_handle, &length);
+
+    // Parsed once per descriptor: a reconnecting device reuses the cached result
+    const auto classified                    = deviceClassifier.classify(raw, length);
+    const UsbHidReportDescriptor* descriptor = classified->parsed ? &classified->descriptor : nullptr;
+
+    DeviceRoute route   = {};
+    route.handle        = hid_device_handle;
+    route.deviceId      = deviceIdOf(devInfo);
+    route.deviceClass   = classified->classification.primary;
+    route.usesReportIds = descriptor != nullptr && descriptor->usesReportIds();
+    route.decoderIndex.fill(DeviceRoute::NO_DECODER);
+
+    // Decoders copy the settings of the reporters, which are changed under inputMutex
+    xSemaphoreTake(inputMutex, portMAX_DELAY);
+    if (route.usesReportIds)
+    {
+        // A decoder per input report ID, so two gamepads or consumer collections of one
+        // interface keep their own state. Reports with undeclared IDs are dropped.
+        std::array<bool, 256> declared = {};
+        for (const UsbHidReportField& field : descriptor->fields())
+        {
+            if (field.type == UsbHidReportType::Input && !field.isConstant())
+            {
+                declared[field.reportId] = true;
+            }
+        }
+        for (size_t reportId = 1; reportId < declared.size(); ++reportId)
+        {
+            if (!declared[reportId])
+            {
+                continue;
+            }
+            const UsbHidDeviceClass reportClass = classified->reportClasses[reportId];
+            const UsbHidReportDescriptor report = descriptor->inputReport(static_cast<uint8_t>(reportId));
+            route.decoderIndex[reportId]        = addDecoder(route, reportClass, &report, devInfo);
+
+            // The first input report of the primary class is fetched at connect
+            if (route.syncReportId == 0 && reportClass == route.deviceClass)
+            {
+                route.syncReportId = static_cast<uint8_t>(reportId);
+            }
+        }
+    }
+    else
+    {
+        route.decoderIndex[0] = addDecoder(route, route.deviceClass, descriptor, devInfo);
+    }
+    const uint16_t classes = route.classes;
+    deviceRoutes.push_back(std::move(route));
+    xSemaphoreGive(inputMutex);
+
+    ESP_LOGI(TAG, "Interface routed as %s (classes 0x%04X)",
+             UsbHidDeviceClassifier::name(classified->classification.primary), classes);
+
+    if (classes & (1u << static_cast<uint8_t>(UsbHidDeviceClass::Keyboard)))
+    {
+        // Show the host lock state on the new keyboard
+        requestLedUpdate(keyboardReport.getLedState());
+    }
+}
+
+/**
+ * @brief Route a remote interface to a remote report of its own
+ *
+ * The profile is bound once, at connect. Events go to g20sProReport's callbacks, so two
+ * remotes with different profiles never release each other's buttons or share a motion
+ * filter, and their reports need no profile lookup.
+ */
+void UsbHidHost::addRemoteRoute(hid_host_device_handle_t hid_device_handle, const UsbHidRemoteDecoder& profile)
+{
+    DeviceRoute route   = {};
+    route.handle        = hid_device_handle;
+    route.deviceClass   = UsbHidDeviceClass::Vendor;
+    route.usesReportIds = false;
+    route.classes       = 1u << static_cast<uint8_t>(UsbHidDeviceClass::Vendor);
+    route.decoderIndex.fill(DeviceRoute::NO_DECODER);
+    route.decoderIndex[0] = 0;
+
+    // The remote report's settings are changed under inputMutex
+    xSemaphoreTake(inputMutex, portMAX_DELAY);
+    auto remote = std::make_unique<UsbHidG20sProReport>();
+    remote->useProfile(profile);
+    remote->useSettingsOf(g20sProReport);
+    remote->forwardTo(&g20sProReport);
+    route.decoders.push_back({UsbHidDeviceClass::Vendor, std::move(remote)});
+    deviceRoutes.push_back(std::move(route));
+    xSemaphoreGive(inputMutex);
+}
+
+/**
+ * @brief Add the decoder of a device class to a route
+ *
+ * Classes without a report of their own, and reports their class cannot decode, get a
+ * generic report, which falls back to raw data if the descriptor is not usable either.
+ * The caller holds inputMutex.
+ *
+ * @param[in] descriptor  nullptr if the report descriptor could not be parsed
+ * @return Index of the decoder in route.decoders
+ */
+uint8_t UsbHidHost::addDecoder(DeviceRoute& route, UsbHidDeviceClass deviceClass,
+                               const UsbHidReportDescriptor* descriptor, const hid_host_dev_info_t& devInfo)
+{
+    std::unique_ptr<UsbHidReportSink> report;
+    if (descriptor != nullptr)
+    {
+        report = makeDecoder(deviceClass, *descriptor, devInfo);
+    }
+    if (!report)
+    {
+        auto generic = std::make_unique<UsbHidGenericReport>();
+        if (descriptor == nullptr || !generic->useDescriptor(*descriptor))
+        {
+            ESP_LOGW(TAG, "Report descriptor not usable, reporting raw data");
+            generic->clearDescriptor();
+        }
+        generic->useSubscriptionsOf(genericReport);
+        generic->forwardTo(&genericReport);
+        deviceClass = UsbHidDeviceClass::Unknown;
+        report      = std::move(generic);
+    }
+
+    route.classes |= 1u << static_cast<uint8_t>(deviceClass);
+    route.decoders.push_back({deviceClass, std::move(report)});
+    return static_cast<uint8_t>(route.decoders.size() - 1);
+}
+
+/**
+ * @brief Make the decoder of a device class for a descriptor
+ *
+ * The decoder forwards its events to the reporter of its class and starts from that
+ * reporter's settings. The caller holds inputMutex.
+ *
+ * @return nullptr if the class has no report of its own or that report cannot decode the descriptor
+ */
+std::unique_ptr<UsbHidReportSink> UsbHidHost::makeDecoder(UsbHidDeviceClass deviceClass,
+                                                          const UsbHidReportDescriptor& descriptor,
+                                                          const hid_host_dev_info_t& devInfo)
+{
+    switch (deviceClass)
+    {
+    case UsbHidDeviceClass::Keyboard:
+    {
+        auto keyboard = std::make_unique<UsbHidKeyboardReport>();
+        if (!keyboard->useReportProtocol(descriptor))
+        {
+            return nullptr;
+        }
+        shareKeyboardState(*keyboard, deviceIdOf(devInfo));
+        return keyboard;
+    }
+    case UsbHidDeviceClass::Mouse:
+    {
+        auto mouse = std::make_unique<UsbHidMouseReport>();
+        if (!mouse->useReportProtocol(descriptor))
+        {
+            return nullptr;
+        }
+        mouse->forwardTo(&mouseReport);
+        return mouse;
+    }
+    case UsbHidDeviceClass::Gamepad:
+    {
+        auto gamepad = std::make_unique<UsbHidGamepadReport>();
+        gamepad->useSettingsOf(gamepadReport);
+        if (!gamepad->useDescriptor(descriptor, devInfo.VID, devInfo.PID))
+        {
+            return nullptr;
+        }
+        gamepad->forwardTo(&gamepadReport);
+        return gamepad;
+    }
+    case UsbHidDeviceClass::Consumer:
+    {
+        auto consumer = std::make_unique<UsbHidConsumerReport>();
+        if (!consumer->useDescriptor(descriptor))
+        {
+            return nullptr;
+        }
+        consumer->forwardTo(&consumerReport);
+        return consumer;
+    }
+    case UsbHidDeviceClass::Digitizer:
+    {
+        auto digitizer = std::make_unique<UsbHidDigitizerReport>(timerWheel);
+        if (!digitizer->useDescriptor(descriptor))
+        {
+            return nullptr;
+        }
+        digitizer->forwardTo(&digitizerReport);
+        return digitizer;
+    }
+    default:
+        return nullptr;
+    }
+}
+
+/**
+ * @brief Let a keyboard decoder share the lock state of keyboardReport
+ *
+ * Its lock keys toggle the shared LED state, which onLedStateChanged() mirrors back.
+ * It repeats keys as set for its model. The caller holds inputMutex.
+ */
+void UsbHidHost::shareKeyboardState(UsbHidKeyboardReport& keyboard, uint32_t deviceId)
+{
+    keyboard.forwardTo(&keyboardReport);
+    keyboard.setLedState(keyboardReport.getLedState());
+    keyboard.registerLedCallback([this](uint8_t leds) { keyboardReport.setLedState(leds); });
+    applyKeyRepeat(keyboard, deviceId);
+}
+
+/**
+ * @brief Call a function for the keyboard decoder of every route
+ *
+ * The caller holds inputMutex.
+ */
+void UsbHidHost::forEachRouteKeyboard(const std::function<void(UsbHidKeyboardReport&)>& function)
+{
+    for (DeviceRoute& route : deviceRoutes)
+    {
+        for (RouteDecoder& decoder : route.decoders)
+        {
+            if (decoder.deviceClass == UsbHidDeviceClass::Keyboard)
+            {
+                function(static_cast<UsbHidKeyboardReport&>(*decoder.report));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Get the route of a non-boot interface, made at connect
+ *
+ * deviceRoutes is written by the event processor task and the disconnect callback,
+ * both holding inputMutex. The caller holds inputMutex too.
+ */
+const UsbHidHost::DeviceRoute* UsbHidHost::findRoute(hid_host_device_handle_t hid_device_handle) const
+{
+    for (const auto& route : deviceRoutes)
+    {
+        if (route.handle == hid_device_handle)
+        {
+            return &route;
+        }
+    }
+    return nullptr;
+}
+
 void UsbHidHost::addEventToQueue(const UsbHidEvent& event)
 {
     if (xQueueSend(eventQueue, &event, 0) != pdTRUE)
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <vector>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 
@@ -18,7 +19,36 @@ enum class UsbHidDeviceType : uint8_t
     Keyboard,  ///< Keyboard device
     Mouse,     ///< Mouse device
     G20sPro,   ///< G20s Pro device
-    Generic    ///< Generic HID device
+    Generic,   ///< Generic HID device
+    Gamepad,   ///< Gamepad or joystick
+    Consumer,  ///< Consumer control (media keys)
+    Digitizer  ///< Touch panel or pen digitizer
+};
+
+/**
+ * @class UsbHidReportSink
+ * @brief The part of a report that does not depend on its event type.
+ *
+ * Lets the host keep decoders of different types side by side, e.g. one per report ID
+ * of a composite interface.
+ */
+class UsbHidReportSink
+{
+public:
+    virtual ~UsbHidReportSink() = default;
+
+    /**
+     * @brief Process raw report data from the USB HID device.
+     *
+     * @param data Pointer to the raw report data.
+     * @param length Length of the raw report data.
+     */
+    virtual void processReportData(const uint8_t* const data, int length) = 0;
+
+    /**
+     * @brief Release everything the device holds down and forget its state.
+     */
+    virtual void releaseAll() = 0;
 };
 
 /**
@@ -32,7 +62,7 @@ enum class UsbHidDeviceType : uint8_t
  * @tparam EventType The type of event this report generates.
  */
 template <typename EventType, UsbHidDeviceType DeviceType>
-class UsbHidBaseReport
+class UsbHidBaseReport : public UsbHidReportSink
 {
 public:
     /**
@@ -46,7 +76,7 @@ public:
      *
      * @param type The type of USB HID device this report represents.
      */
-    explicit UsbHidBaseReport() : deviceType_(DeviceType) {}
+    explicit UsbHidBaseReport() : deviceType_(DeviceType), forwardTo_(nullptr) {}
 
     /**
      * @brief Destroy the UsbHidBaseReport object.
@@ -62,7 +92,15 @@ public:
      * @param data Pointer to the raw report data.
      * @param length Length of the raw report data.
      */
-    virtual void processReportData(const uint8_t* const data, int length) = 0;
+    void processReportData(const uint8_t* const data, int length) override = 0;
+
+    /**
+     * @brief Release everything the device holds down and forget its state.
+     *
+     * Called when the device disconnects. Derived classes fire release events for
+     * held keys and buttons before resetting, so consumers never see them stuck.
+     */
+    void releaseAll() override { rawReport_.clear(); }
 
     /**
      * @brief Get the current raw report data.
@@ -91,7 +129,20 @@ public:
         callbacks.push_back(std::move(callback));
     }
 
+    /**
+     * @brief Also deliver every event to the callbacks of another report of the same type.
+     *
+     * Lets several decoders, each with the state of one device, share the callbacks
+     * registered on a single report.
+     *
+     * @param target The report whose callbacks receive the events, nullptr to stop. Must outlive this report.
+     */
+    void forwardTo(UsbHidBaseReport* target) { forwardTo_ = target; }
+
 protected:
+    /// Buffer size for a hex dump of the largest report (64 bytes, 3 characters per byte)
+    static constexpr size_t RAW_LOG_SIZE = 3 * 64;
+
     UsbHidDeviceType deviceType_;     ///< The type of USB HID device this report represents.
     std::vector<uint8_t> rawReport_;  ///< Cached raw report data.
 
@@ -106,6 +157,10 @@ protected:
         {
             callback(event);
         }
+        if (forwardTo_ != nullptr)
+        {
+            forwardTo_->triggerEvent(event);
+        }
     }
 
     /**
@@ -120,4 +175,5 @@ protected:
 
 private:
     std::vector<EventCallback> callbacks;  ///< List of registered callback functions.
+    UsbHidBaseReport* forwardTo_;          ///< Report whose callbacks also receive the events
 };
\ No newline at end of file
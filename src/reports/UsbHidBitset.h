@@ -0,0 +1,163 @@
+/**
+ * @file UsbHidBitset.h
+ * @brief Defines a fixed-size, word-based bitset used to track HID usage state.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class UsbHidBitset
+ * @brief Fixed-size bitset stored as 32-bit words.
+ *
+ * Unlike std::bitset, the word storage is exposed so that callers can diff two
+ * states with a handful of XOR/AND operations and walk only the bits that are set.
+ *
+ * @tparam Bits Number of bits in the set.
+ */
+template <size_t Bits>
+class UsbHidBitset
+{
+public:
+    static constexpr size_t WORD_BITS = 32;                               ///< Bits per storage word
+    static constexpr size_t WORDS     = (Bits + WORD_BITS - 1) / WORD_BITS;  ///< Number of storage words
+
+    constexpr UsbHidBitset() : words_{} {}
+
+    /**
+     * @brief Set a bit.
+     *
+     * @param bit Index of the bit to set. Out of range indices are ignored.
+     */
+    constexpr void set(size_t bit)
+    {
+        if (bit < Bits) words_[bit / WORD_BITS] |= (1u << (bit % WORD_BITS));
+    }
+
+    /**
+     * @brief Clear a bit.
+     *
+     * @param bit Index of the bit to clear. Out of range indices are ignored.
+     */
+    constexpr void reset(size_t bit)
+    {
+        if (bit < Bits) words_[bit / WORD_BITS] &= ~(1u << (bit % WORD_BITS));
+    }
+
+    /**
+     * @brief Test a bit.
+     *
+     * @param bit Index of the bit to test.
+     * @return true if the bit is set, false otherwise (or if out of range).
+     */
+    constexpr bool test(size_t bit) const
+    {
+        return bit < Bits && (words_[bit / WORD_BITS] & (1u << (bit % WORD_BITS))) != 0;
+    }
+
+    /**
+     * @brief Clear all bits.
+     */
+    constexpr void clear()
+    {
+        for (auto& word : words_) word = 0;
+    }
+
+    /**
+     * @brief Check whether any bit is set.
+     */
+    constexpr bool any() const
+    {
+        uint32_t acc = 0;
+        for (auto word : words_) acc |= word;
+        return acc != 0;
+    }
+
+    /**
+     * @brief Count the bits that are set.
+     */
+    size_t count() const
+    {
+        size_t n = 0;
+        for (auto word : words_) n += __builtin_popcount(word);
+        return n;
+    }
+
+    /**
+     * @brief Access a storage word.
+     *
+     * @param index Word index, must be less than WORDS.
+     * @return uint32_t The word value.
+     */
+    constexpr uint32_t word(size_t index) const { return words_[index]; }
+
+    /**
+     * @brief Overwrite a storage word.
+     *
+     * @param index Word index, must be less than WORDS.
+     * @param value The new word value.
+     */
+    constexpr void setWord(size_t index, uint32_t value) { words_[index] = value; }
+
+    /**
+     * @brief Call a function for every set bit, in ascending order.
+     *
+     * Only set bits are visited, so the cost is proportional to the number of
+     * words plus the number of set bits.
+     *
+     * @param fn Callable taking the bit index as size_t.
+     */
+    template <typename Fn>
+    void forEachSet(Fn&& fn) const
+    {
+        for (size_t w = 0; w < WORDS; ++w)
+        {
+            uint32_t bits = words_[w];
+            while (bits != 0)
+            {
+                fn(w * WORD_BITS + __builtin_ctz(bits));
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    constexpr UsbHidBitset operator^(const UsbHidBitset& other) const
+    {
+        UsbHidBitset result;
+        for (size_t w = 0; w < WORDS; ++w) result.words_[w] = words_[w] ^ other.words_[w];
+        return result;
+    }
+
+    constexpr UsbHidBitset operator&(const UsbHidBitset& other) const
+    {
+        UsbHidBitset result;
+        for (size_t w = 0; w < WORDS; ++w) result.words_[w] = words_[w] & other.words_[w];
+        return result;
+    }
+
+    constexpr UsbHidBitset operator|(const UsbHidBitset& other) const
+    {
+        UsbHidBitset result;
+        for (size_t w = 0; w < WORDS; ++w) result.words_[w] = words_[w] | other.words_[w];
+        return result;
+    }
+
+    constexpr bool operator==(const UsbHidBitset& other) const
+    {
+        for (size_t w = 0; w < WORDS; ++w)
+        {
+            if (words_[w] != other.words_[w]) return false;
+        }
+        return true;
+    }
+
+    constexpr bool operator!=(const UsbHidBitset& other) const { return !(*this == other); }
+
+private:
+    uint32_t words_[WORDS];  ///< Bit storage, bit n lives in words_[n / 32] at position n % 32
+};
+
+/// One bit per keyboard usage ID (0x00 - 0xFF), modifiers live at 0xE0 - 0xE7
+using UsbHidKeyBitset = UsbHidBitset<256>;
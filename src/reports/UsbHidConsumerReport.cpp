@@ -0,0 +1,175 @@
+/**
+ * @file UsbHidConsumerReport.cpp
+ * @brief Implements the UsbHidConsumerReport class for consumer-control (media key) reports.
+ */
+
+#include "UsbHidConsumerReport.h"
+
+#include <esp_log.h>
+
+namespace
+{
+constexpr const char* TAG = "ConsumerReport";
+}  // namespace
+
+UsbHidConsumerReport::UsbHidConsumerReport()
+    : inputReportId_(0),
+      held_{},
+      heldCount_(0),
+      usage_(0),
+      pressed_(false)
+{
+}
+
+bool UsbHidConsumerReport::useDescriptor(const UsbHidReportDescriptor& descriptor)
+{
+    heldCount_     = 0;
+    inputReportId_ = 0;
+    rawReport_.clear();
+
+    bool found = false;
+    if (plan_.build(descriptor))
+    {
+        for (size_t id = 0; id < 256 && !found; ++id)
+        {
+            size_t count                             = 0;
+            const UsbHidExtractionPlan::Entry* entry = plan_.entries(static_cast<uint8_t>(id), count);
+            for (size_t i = 0; i < count && !found; ++i, ++entry)
+            {
+                if (entry->usagePage == USAGE_PAGE_CONSUMER)
+                {
+                    found          = true;
+                    inputReportId_ = plan_.usesReportIds() ? static_cast<uint8_t>(id) : 0;
+                }
+            }
+        }
+    }
+
+    if (!found)
+    {
+        ESP_LOGW(TAG, "No consumer controls in report descriptor");
+        plan_.clear();
+        return false;
+    }
+    raw_.assign(plan_.maxValues(), 0);
+    return true;
+}
+
+void UsbHidConsumerReport::processReportData(const uint8_t* const data, int length)
+{
+    rawReport_.assign(data, data + length);
+    if (plan_.empty() || length <= 0)
+    {
+        return;
+    }
+
+    const uint8_t reportId                   = plan_.usesReportIds() ? data[0] : 0;
+    const size_t count                       = plan_.extract(data, static_cast<size_t>(length), raw_.data(), raw_.size());
+    size_t entryCount                        = 0;
+    const UsbHidExtractionPlan::Entry* entry = plan_.entries(reportId, entryCount);
+
+    // Usages this report says are down
+    std::array<uint16_t, MAX_HELD> down;
+    size_t downCount = 0;
+    bool hasConsumer = false;
+    for (size_t i = 0; i < count; ++i, ++entry)
+    {
+        if (entry->usagePage != USAGE_PAGE_CONSUMER)
+        {
+            continue;
+        }
+        hasConsumer = true;
+
+        const int32_t value = raw_[i];
+        uint16_t usage      = 0;
+        if (entry->flags & UsbHidExtractionPlan::ENTRY_ARRAY)
+        {
+            // Array: the element is the index of a pressed usage, out of range when empty
+            if (value >= entry->logicalMin && value <= entry->logicalMax)
+            {
+                usage = static_cast<uint16_t>(entry->usage + (value - entry->logicalMin));
+            }
+        }
+        else if (value != 0)
+        {
+            // Bitmap: one element per usage
+            usage = entry->usage;
+        }
+
+        if (usage != 0 && downCount < MAX_HELD)
+        {
+            down[downCount++] = usage;
+        }
+    }
+
+    if (!hasConsumer)
+    {
+        return;
+    }
+
+    // Releases first, then presses, so a key swap reads in order
+    for (size_t h = 0; h < heldCount_;)
+    {
+        const HeldUsage held = held_[h];
+        bool stillDown       = held.reportId != reportId;
+        for (size_t d = 0; d < downCount && !stillDown; ++d)
+        {
+            stillDown = down[d] == held.usage;
+        }
+
+        if (stillDown)
+        {
+            ++h;
+            continue;
+        }
+        held_[h] = held_[--heldCount_];
+        emit(held.usage, false);
+    }
+
+    for (size_t d = 0; d < downCount; ++d)
+    {
+        if (isPressed(down[d]) || heldCount_ == MAX_HELD)
+        {
+            continue;
+        }
+        held_[heldCount_++] = {down[d], reportId};
+        emit(down[d], true);
+    }
+}
+
+void UsbHidConsumerReport::releaseAll()
+{
+    while (heldCount_ > 0)
+    {
+        emit(held_[--heldCount_].usage, false);
+    }
+    rawReport_.clear();
+}
+
+bool UsbHidConsumerReport::isPressed(uint16_t usage) const
+{
+    for (size_t h = 0; h < heldCount_; ++h)
+    {
+        if (held_[h].usage == usage)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void UsbHidConsumerReport::emit(uint16_t usage, bool pressed)
+{
+    usage_   = usage;
+    pressed_ = pressed;
+    triggerEvent(createEvent());
+}
+
+UsbHidConsumerEvent UsbHidConsumerReport::createEvent() const
+{
+    UsbHidConsumerEvent event;
+    event.usage   = usage_;
+    event.pressed = pressed_;
+    event.name    = usageName(usage_);
+    return event;
+}
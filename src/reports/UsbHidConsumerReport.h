@@ -0,0 +1,178 @@
+/**
+ * @file UsbHidConsumerReport.h
+ * @brief Defines the UsbHidConsumerReport class for consumer-control (media key) reports.
+ */
+
+#pragma once
+
+#include "UsbHidBaseReport.h"
+#include "UsbHidExtractionPlan.h"
+#include "UsbHidReportDescriptor.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+/**
+ * @struct UsbHidConsumerEvent
+ * @brief One Consumer page usage going down or up.
+ */
+struct UsbHidConsumerEvent
+{
+    UsbHidDeviceType deviceType_;  ///< Type of the USB HID device
+    uint16_t usage;                ///< Consumer page usage, e.g. 0xE9 Volume Increment
+    bool pressed;                  ///< true on press, false on release
+    std::string_view name;         ///< Usage name, "Unknown" if not in the table
+
+    UsbHidConsumerEvent() : deviceType_(UsbHidDeviceType::Consumer), usage(0), pressed(false), name() {}
+};
+
+/**
+ * @class UsbHidConsumerReport
+ * @brief Decodes Consumer page (0x0C) reports from media keyboards and remotes.
+ *
+ * Both encodings are supported: array fields, where each element holds the index of a
+ * pressed usage, and bitmap fields, one bit per usage. Every press and release is
+ * emitted as its own event. Usages held from other report IDs are kept, so a device
+ * spreading its keys over several reports still gets exact edges.
+ */
+class UsbHidConsumerReport : public UsbHidBaseReport<UsbHidConsumerEvent, UsbHidDeviceType::Consumer>
+{
+public:
+    /// Usages held at once
+    static constexpr size_t MAX_HELD = 16;
+
+    UsbHidConsumerReport();
+
+    void processReportData(const uint8_t* const data, int length) override;
+    void releaseAll() override;  // Releases held usages, one event each
+
+    /**
+     * @brief Decode reports using the device's report descriptor.
+     *
+     * @return true if the descriptor has Consumer page input fields.
+     */
+    bool useDescriptor(const UsbHidReportDescriptor& descriptor);
+
+    bool isPressed(uint16_t usage) const;
+    uint8_t getInputReportId() const { return inputReportId_; }  // 0 if reports carry no ID
+
+    /**
+     * @brief Get the name of a Consumer page usage, "Unknown" if it has none.
+     */
+    static constexpr std::string_view usageName(uint16_t usage);
+
+protected:
+    UsbHidConsumerEvent createEvent() const override;
+
+private:
+    static constexpr uint16_t USAGE_PAGE_CONSUMER = 0x0C;
+
+    /**
+     * @struct UsageName
+     * @brief One row of the name table.
+     */
+    struct UsageName
+    {
+        uint16_t usage;
+        std::string_view name;
+    };
+
+    /// Sorted by usage for binary search
+    static constexpr UsageName USAGE_NAMES[] = {
+        {0x0030, "Power"},
+        {0x0032, "Sleep"},
+        {0x0040, "Menu"},
+        {0x0041, "Menu Pick"},
+        {0x0042, "Menu Up"},
+        {0x0043, "Menu Down"},
+        {0x0044, "Menu Left"},
+        {0x0045, "Menu Right"},
+        {0x0046, "Menu Escape"},
+        {0x006F, "Brightness Up"},
+        {0x0070, "Brightness Down"},
+        {0x00B0, "Play"},
+        {0x00B1, "Pause"},
+        {0x00B2, "Record"},
+        {0x00B3, "Fast Forward"},
+        {0x00B4, "Rewind"},
+        {0x00B5, "Next Track"},
+        {0x00B6, "Previous Track"},
+        {0x00B7, "Stop"},
+        {0x00B8, "Eject"},
+        {0x00CD, "Play/Pause"},
+        {0x00E2, "Mute"},
+        {0x00E9, "Volume Up"},
+        {0x00EA, "Volume Down"},
+        {0x0183, "Media Player"},
+        {0x018A, "Email"},
+        {0x0192, "Calculator"},
+        {0x0194, "My Computer"},
+        {0x0221, "Search"},
+        {0x0223, "Home"},
+        {0x0224, "Back"},
+        {0x0225, "Forward"},
+        {0x0226, "Browser Stop"},
+        {0x0227, "Refresh"},
+        {0x022A, "Bookmarks"},
+    };
+
+    static constexpr bool isSorted()
+    {
+        for (size_t i = 1; i < std::size(USAGE_NAMES); ++i)
+        {
+            if (USAGE_NAMES[i - 1].usage >= USAGE_NAMES[i].usage)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @struct HeldUsage
+     * @brief A usage that is down, and the report that said so.
+     */
+    struct HeldUsage
+    {
+        uint16_t usage;
+        uint8_t reportId;
+    };
+
+    UsbHidExtractionPlan plan_;
+    std::vector<int32_t> raw_;  ///< extract() output, sized for the largest report
+    uint8_t inputReportId_;
+
+    std::array<HeldUsage, MAX_HELD> held_;
+    size_t heldCount_;
+
+    // Edge being reported
+    uint16_t usage_;
+    bool pressed_;
+
+    void emit(uint16_t usage, bool pressed);
+};
+
+constexpr std::string_view UsbHidConsumerReport::usageName(uint16_t usage)
+{
+    static_assert(isSorted(), "USAGE_NAMES must be sorted by usage");
+
+    size_t low  = 0;
+    size_t high = std::size(USAGE_NAMES);
+    while (low < high)
+    {
+        const size_t mid = (low + high) / 2;
+        if (USAGE_NAMES[mid].usage < usage)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low < std::size(USAGE_NAMES) && USAGE_NAMES[low].usage == usage ? USAGE_NAMES[low].name
+                                                                          : std::string_view("Unknown");
+}
@@ -0,0 +1,216 @@
+/**
+ * @file UsbHidDeviceClassifier.cpp
+ * @brief Implements the UsbHidDeviceClassifier class, which classifies interfaces by their application collections.
+ */
+
+#include "UsbHidDeviceClassifier.h"
+
+#include <cstring>
+
+#include <esp_log.h>
+
+namespace
+{
+constexpr const char* TAG = "DeviceClassifier";
+
+// Usage pages
+constexpr uint16_t USAGE_PAGE_GENERIC_DESKTOP = 0x01;
+constexpr uint16_t USAGE_PAGE_CONSUMER        = 0x0C;
+constexpr uint16_t USAGE_PAGE_DIGITIZER       = 0x0D;
+constexpr uint16_t USAGE_PAGE_VENDOR_FIRST    = 0xFF00;
+
+// Generic Desktop usages
+constexpr uint16_t USAGE_POINTER        = 0x01;
+constexpr uint16_t USAGE_MOUSE          = 0x02;
+constexpr uint16_t USAGE_JOYSTICK       = 0x04;
+constexpr uint16_t USAGE_GAMEPAD        = 0x05;
+constexpr uint16_t USAGE_KEYBOARD       = 0x06;
+constexpr uint16_t USAGE_KEYPAD         = 0x07;
+constexpr uint16_t USAGE_MULTI_AXIS     = 0x08;
+constexpr uint16_t USAGE_SYSTEM_CONTROL = 0x80;
+
+constexpr uint32_t FNV_OFFSET_BASIS = 0x811C9DC5;
+constexpr uint32_t FNV_PRIME        = 0x01000193;
+
+/// Primary class candidates, highest priority first
+constexpr UsbHidDeviceClass PRIORITY[] = {
+    UsbHidDeviceClass::Keyboard,
+    UsbHidDeviceClass::Mouse,
+    UsbHidDeviceClass::Gamepad,
+    UsbHidDeviceClass::Digitizer,
+    UsbHidDeviceClass::Consumer,
+    UsbHidDeviceClass::SystemControl,
+    UsbHidDeviceClass::Vendor,
+};
+}  // namespace
+
+UsbHidDeviceClassifier::UsbHidDeviceClassifier()
+    : cache_{},
+      cacheCount_(0),
+      cacheNext_(0)
+{
+}
+
+std::shared_ptr<const UsbHidDeviceClassifier::Result> UsbHidDeviceClassifier::classify(const uint8_t* data, size_t length)
+{
+    if (data == nullptr)
+    {
+        return std::make_shared<const Result>();
+    }
+
+    const uint32_t key = hash(data, length);
+    for (size_t i = 0; i < cacheCount_; ++i)
+    {
+        const CacheEntry& entry = cache_[i];
+        if (entry.hash == key && entry.bytes.size() == length && std::memcmp(entry.bytes.data(), data, length) == 0)
+        {
+            return entry.result;
+        }
+    }
+
+    auto result = std::make_shared<Result>();
+    if (result->descriptor.parse(data, length))
+    {
+        result->parsed         = true;
+        result->classification = classify(result->descriptor);
+        if (result->descriptor.usesReportIds())
+        {
+            classifyReports(result->descriptor, result->classification.primary, result->reportClasses);
+        }
+        else
+        {
+            result->reportClasses.fill(result->classification.primary);
+        }
+    }
+    else
+    {
+        result->descriptor = UsbHidReportDescriptor();
+    }
+
+    cache_[cacheNext_] = {key, std::vector<uint8_t>(data, data + length), result};
+    cacheNext_         = (cacheNext_ + 1) % CACHE_SIZE;
+    if (cacheCount_ < CACHE_SIZE)
+    {
+        ++cacheCount_;
+    }
+
+    ESP_LOGI(TAG, "Descriptor %08lX classified as %s (classes 0x%04X)", static_cast<unsigned long>(key),
+             name(result->classification.primary), result->classification.classes);
+    return result;
+}
+
+UsbHidDeviceClassifier::Classification UsbHidDeviceClassifier::classify(const UsbHidReportDescriptor& descriptor)
+{
+    Classification classification;
+    for (const auto& application : descriptor.applications())
+    {
+        classification.classes |= bit(classify(application));
+    }
+
+    for (UsbHidDeviceClass candidate : PRIORITY)
+    {
+        if (classification.has(candidate))
+        {
+            classification.primary = candidate;
+            break;
+        }
+    }
+    return classification;
+}
+
+UsbHidDeviceClass UsbHidDeviceClassifier::classify(const UsbHidApplicationCollection& application)
+{
+    if (application.usagePage == USAGE_PAGE_GENERIC_DESKTOP)
+    {
+        switch (application.usage)
+        {
+        case USAGE_KEYBOARD:
+        case USAGE_KEYPAD:
+            return UsbHidDeviceClass::Keyboard;
+        case USAGE_POINTER:
+        case USAGE_MOUSE:
+            return UsbHidDeviceClass::Mouse;
+        case USAGE_JOYSTICK:
+        case USAGE_GAMEPAD:
+        case USAGE_MULTI_AXIS:
+            return UsbHidDeviceClass::Gamepad;
+        case USAGE_SYSTEM_CONTROL:
+            return UsbHidDeviceClass::SystemControl;
+        default:
+            return UsbHidDeviceClass::Unknown;
+        }
+    }
+    if (application.usagePage == USAGE_PAGE_CONSUMER)
+    {
+        return UsbHidDeviceClass::Consumer;
+    }
+    if (application.usagePage == USAGE_PAGE_DIGITIZER)
+    {
+        return UsbHidDeviceClass::Digitizer;
+    }
+    if (application.usagePage >= USAGE_PAGE_VENDOR_FIRST)
+    {
+        return UsbHidDeviceClass::Vendor;
+    }
+    return UsbHidDeviceClass::Unknown;
+}
+
+void UsbHidDeviceClassifier::classifyReports(const UsbHidReportDescriptor& descriptor, UsbHidDeviceClass fallback,
+                                             ReportClasses& classes)
+{
+    classes.fill(fallback);
+
+    std::array<bool, 256> declared{};
+    const auto& applications = descriptor.applications();
+    for (const auto& field : descriptor.fields())
+    {
+        if (field.type != UsbHidReportType::Input || field.isConstant())
+        {
+            continue;
+        }
+
+        const UsbHidDeviceClass fieldClass = field.application < applications.size()
+                                                 ? classify(applications[field.application])
+                                                 : UsbHidDeviceClass::Unknown;
+        // The first field in a recognised application names the report
+        if (!declared[field.reportId] || classes[field.reportId] == UsbHidDeviceClass::Unknown)
+        {
+            classes[field.reportId] = fieldClass;
+        }
+        declared[field.reportId] = true;
+    }
+}
+
+uint32_t UsbHidDeviceClassifier::hash(const uint8_t* data, size_t length)
+{
+    uint32_t value = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < length; ++i)
+    {
+        value ^= data[i];
+        value *= FNV_PRIME;
+    }
+    return value;
+}
+
+const char* UsbHidDeviceClassifier::name(UsbHidDeviceClass deviceClass)
+{
+    switch (deviceClass)
+    {
+    case UsbHidDeviceClass::Keyboard:
+        return "keyboard";
+    case UsbHidDeviceClass::Mouse:
+        return "mouse";
+    case UsbHidDeviceClass::Consumer:
+        return "consumer control";
+    case UsbHidDeviceClass::SystemControl:
+        return "system control";
+    case UsbHidDeviceClass::Gamepad:
+        return "gamepad";
+    case UsbHidDeviceClass::Digitizer:
+        return "digitizer";
+    case UsbHidDeviceClass::Vendor:
+        return "vendor";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,134 @@
+/**
+ * @file UsbHidDeviceClassifier.h
+ * @brief Defines the UsbHidDeviceClassifier class, which classifies interfaces by their application collections.
+ */
+
+#pragma once
+
+#include "UsbHidReportDescriptor.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @enum UsbHidDeviceClass
+ * @brief What an application collection, or a whole interface, is.
+ */
+enum class UsbHidDeviceClass : uint8_t
+{
+    Unknown,        ///< No application collection we recognise
+    Keyboard,       ///< Generic Desktop keyboard or keypad
+    Mouse,          ///< Generic Desktop mouse or pointer
+    Consumer,       ///< Consumer page (media keys, volume, ...)
+    SystemControl,  ///< Generic Desktop system control (power, sleep, wake)
+    Gamepad,        ///< Generic Desktop joystick, gamepad or multi-axis controller
+    Digitizer,      ///< Digitizer page (pens, touch screens, touch pads)
+    Vendor          ///< Vendor-defined usage page
+};
+
+/**
+ * @class UsbHidDeviceClassifier
+ * @brief Classifies an interface from the top-level application collections of its
+ *        report descriptor, and remembers the result by descriptor bytes.
+ *
+ * An interface with several collections (e.g. a keyboard with media keys) is given every
+ * class it contains, and a primary class that picks its decoder: keyboard, then mouse,
+ * gamepad, digitizer, consumer, system control and vendor.
+ *
+ * The cache is looked up before parsing, so a device that reconnects, or a second one of
+ * the same model, reuses the parsed descriptor and the report ID table of the first.
+ */
+class UsbHidDeviceClassifier
+{
+public:
+    /// Descriptors remembered; the oldest is replaced when full
+    static constexpr size_t CACHE_SIZE = 8;
+
+    /**
+     * @struct Classification
+     * @brief Classes found in one descriptor.
+     */
+    struct Classification
+    {
+        UsbHidDeviceClass primary = UsbHidDeviceClass::Unknown;
+        uint16_t classes          = 0;  ///< Bit n set for class n
+
+        bool has(UsbHidDeviceClass deviceClass) const { return (classes & bit(deviceClass)) != 0; }
+    };
+
+    /// Class of each input report ID, indexed by the report ID byte
+    using ReportClasses = std::array<UsbHidDeviceClass, 256>;
+
+    /**
+     * @struct Result
+     * @brief A parsed and classified descriptor, shared by every interface that has it.
+     */
+    struct Result
+    {
+        UsbHidReportDescriptor descriptor;  ///< Empty if the descriptor is malformed
+        bool parsed = false;                ///< The descriptor parsed
+        Classification classification;      ///< Unknown if not parsed
+        ReportClasses reportClasses{};      ///< The primary class for every ID if reports carry no ID
+    };
+
+    UsbHidDeviceClassifier();
+
+    /**
+     * @brief Parse and classify a raw report descriptor, or get the result cached for the same bytes.
+     *
+     * @param data Report descriptor, may be nullptr.
+     * @param length Length of the descriptor in bytes.
+     * @return std::shared_ptr<const Result> The result, which stays valid after it leaves the cache.
+     */
+    std::shared_ptr<const Result> classify(const uint8_t* data, size_t length);
+
+    /**
+     * @brief Classify a parsed descriptor, without the cache.
+     */
+    static Classification classify(const UsbHidReportDescriptor& descriptor);
+
+    /**
+     * @brief Classify one application collection.
+     */
+    static UsbHidDeviceClass classify(const UsbHidApplicationCollection& application);
+
+    /**
+     * @brief Classify each input report ID by the application collection its fields are in.
+     *
+     * Lets a composite interface, e.g. a keyboard sending media keys under another report
+     * ID, have each report decoded by its own report class.
+     *
+     * @param fallback Class of report IDs the descriptor does not declare.
+     * @param classes Receives the class of every report ID; Unknown for declared IDs
+     *                outside any recognised application collection.
+     */
+    static void classifyReports(const UsbHidReportDescriptor& descriptor, UsbHidDeviceClass fallback,
+                                ReportClasses& classes);
+
+    /**
+     * @brief 32-bit FNV-1a hash of a descriptor.
+     */
+    static uint32_t hash(const uint8_t* data, size_t length);
+
+    static const char* name(UsbHidDeviceClass deviceClass);
+
+private:
+    /**
+     * @struct CacheEntry
+     * @brief A classified descriptor.
+     */
+    struct CacheEntry
+    {
+        uint32_t hash;
+        std::vector<uint8_t> bytes;  ///< Compared on a hash match, so a collision cannot return another device's result
+        std::shared_ptr<const Result> result;
+    };
+
+    std::array<CacheEntry, CACHE_SIZE> cache_;
+    size_t cacheCount_;
+    size_t cacheNext_;  ///< Slot replaced next
+
+    static constexpr uint16_t bit(UsbHidDeviceClass deviceClass) { return 1u << static_cast<uint8_t>(deviceClass); }
+};
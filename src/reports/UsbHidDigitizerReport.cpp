@@ -0,0 +1,317 @@
+/**
+ * @file UsbHidDigitizerReport.cpp
+ * @brief Implements the UsbHidDigitizerReport class for multi-touch panels.
+ */
+
+#include "UsbHidDigitizerReport.h"
+
+#include <algorithm>
+
+#include <esp_log.h>
+
+namespace
+{
+constexpr const char* TAG = "DigitizerReport";
+}  // namespace
+
+UsbHidDigitizerReport::UsbHidDigitizerReport(const UsbHidTimerWheel& wheel)
+    : wheel_(wheel),
+      contactCountIndex_(NONE),
+      inputReportId_(0),
+      maxX_(0),
+      maxY_(0),
+      frame_{},
+      frameCount_(0),
+      expected_(0),
+      contacts_{},
+      activeCount_(0),
+      unindexedCount_(0),
+      frameNumber_(0),
+      phase_(UsbHidTouchPhase::Up),
+      eventContact_(nullptr)
+{
+    rowById_.fill(NO_ROW);
+}
+
+bool UsbHidDigitizerReport::useDescriptor(const UsbHidReportDescriptor& descriptor)
+{
+    releaseAll();
+    slots_.clear();
+    contactCountIndex_ = NONE;
+    inputReportId_     = 0;
+
+    if (!plan_.build(descriptor))
+    {
+        return false;
+    }
+
+    // The first report with X/Y contacts is the touch report
+    for (size_t id = 0; id < 256 && slots_.empty(); ++id)
+    {
+        size_t count                             = 0;
+        const UsbHidExtractionPlan::Entry* entry = plan_.entries(static_cast<uint8_t>(id), count);
+
+        Slot slot;
+        std::vector<Slot> slots;
+        uint16_t contactCountIndex = NONE;
+        int32_t maxX               = 0;
+        int32_t maxY               = 0;
+        for (size_t i = 0; i < count; ++i, ++entry)
+        {
+            uint16_t Slot::*field = nullptr;
+            if (entry->usagePage == USAGE_PAGE_GENERIC_DESKTOP && entry->usage == USAGE_X)
+                field = &Slot::x;
+            else if (entry->usagePage == USAGE_PAGE_GENERIC_DESKTOP && entry->usage == USAGE_Y)
+                field = &Slot::y;
+            else if (entry->usagePage == USAGE_PAGE_DIGITIZER && entry->usage == USAGE_TIP_SWITCH)
+                field = &Slot::tip;
+            else if (entry->usagePage == USAGE_PAGE_DIGITIZER && entry->usage == USAGE_CONFIDENCE)
+                field = &Slot::confidence;
+            else if (entry->usagePage == USAGE_PAGE_DIGITIZER && entry->usage == USAGE_CONTACT_ID)
+                field = &Slot::contactId;
+            else if (entry->usagePage == USAGE_PAGE_DIGITIZER && entry->usage == USAGE_CONTACT_COUNT)
+                contactCountIndex = static_cast<uint16_t>(i);
+
+            if (field == nullptr)
+            {
+                continue;
+            }
+
+            // A usage seen again starts the next contact
+            if (slot.*field != NONE)
+            {
+                slots.push_back(slot);
+                slot = Slot();
+            }
+            slot.*field = static_cast<uint16_t>(i);
+
+            if (field == &Slot::x)
+                maxX = entry->logicalMax;
+            else if (field == &Slot::y)
+                maxY = entry->logicalMax;
+        }
+        slots.push_back(slot);
+
+        // Only slots with a position are contacts
+        for (const auto& candidate : slots)
+        {
+            if (candidate.x != NONE && candidate.y != NONE && slots_.size() < MAX_CONTACTS)
+            {
+                slots_.push_back(candidate);
+            }
+        }
+        if (!slots_.empty())
+        {
+            contactCountIndex_ = contactCountIndex;
+            inputReportId_     = plan_.usesReportIds() ? static_cast<uint8_t>(id) : 0;
+            maxX_              = maxX;
+            maxY_              = maxY;
+        }
+    }
+
+    if (slots_.empty())
+    {
+        ESP_LOGW(TAG, "No touch contacts in report descriptor");
+        plan_.clear();
+        return false;
+    }
+
+    raw_.assign(plan_.maxValues(), 0);
+    ESP_LOGI(TAG, "%u contact slot(s) per report%s", static_cast<unsigned>(slots_.size()),
+             contactCountIndex_ != NONE ? ", contact count" : "");
+    return true;
+}
+
+void UsbHidDigitizerReport::processReportData(const uint8_t* const data, int length)
+{
+    rawReport_.assign(data, data + length);
+    if (plan_.empty() || length <= 0 || (plan_.usesReportIds() && data[0] != inputReportId_))
+    {
+        return;
+    }
+
+    const size_t count = plan_.extract(data, static_cast<size_t>(length), raw_.data(), raw_.size());
+    auto value         = [&](uint16_t index, int32_t fallback)
+    { return index != NONE && index < count ? raw_[index] : fallback; };
+
+    if (contactCountIndex_ == NONE)
+    {
+        // No contact count: every report is a frame of all its slots
+        frameCount_ = 0;
+        expected_   = slots_.size();
+    }
+    else
+    {
+        const int32_t contactCount = value(contactCountIndex_, 0);
+        if (contactCount > 0)
+        {
+            // First report of a frame; an unfinished frame before it is lost
+            frameCount_ = 0;
+            expected_   = std::min<size_t>(static_cast<size_t>(contactCount), MAX_CONTACTS);
+        }
+        else if (expected_ == 0)
+        {
+            // A count of 0 outside a hybrid frame: nothing touches the surface
+            finishFrame();
+            return;
+        }
+    }
+
+    for (size_t s = 0; s < slots_.size() && frameCount_ < expected_; ++s)
+    {
+        const Slot& slot = slots_[s];
+        Contact& contact = frame_[frameCount_++];
+        contact.id       = static_cast<uint32_t>(value(slot.contactId, static_cast<int32_t>(s)));
+        contact.x        = value(slot.x, 0);
+        contact.y        = value(slot.y, 0);
+        contact.touching = value(slot.tip, 1) != 0 && value(slot.confidence, 1) != 0;
+    }
+
+    if (frameCount_ >= expected_)
+    {
+        finishFrame();
+    }
+}
+
+void UsbHidDigitizerReport::finishFrame()
+{
+    ++frameNumber_;
+
+    for (size_t f = 0; f < frameCount_; ++f)
+    {
+        const Contact& contact = frame_[f];
+        uint8_t row            = findRow(contact.id);
+
+        if (!contact.touching)
+        {
+            if (row != NO_ROW)
+            {
+                lift(row);
+            }
+            continue;
+        }
+
+        if (row == NO_ROW)
+        {
+            // New contact: take a free row
+            for (uint8_t r = 0; r < MAX_CONTACTS && row == NO_ROW; ++r)
+            {
+                row = contacts_[r].touching ? NO_ROW : r;
+            }
+            if (row == NO_ROW)
+            {
+                continue;  // Table full
+            }
+
+            contacts_[row]          = contact;
+            contacts_[row].lastSeen = frameNumber_;
+            uint8_t& index          = rowById_[contact.id & 0xFF];
+            contacts_[row].indexed  = index == NO_ROW;
+            if (contacts_[row].indexed)
+            {
+                index = row;
+            }
+            else
+            {
+                ++unindexedCount_;
+            }
+            ++activeCount_;
+            emit(UsbHidTouchPhase::Down, contacts_[row]);
+            continue;
+        }
+
+        Contact& tracked = contacts_[row];
+        tracked.lastSeen = frameNumber_;
+        if (tracked.x != contact.x || tracked.y != contact.y)
+        {
+            tracked.x = contact.x;
+            tracked.y = contact.y;
+            emit(UsbHidTouchPhase::Move, tracked);
+        }
+    }
+
+    // Contacts the frame did not mention have lifted
+    for (uint8_t r = 0; r < MAX_CONTACTS; ++r)
+    {
+        if (contacts_[r].touching && contacts_[r].lastSeen != frameNumber_)
+        {
+            lift(r);
+        }
+    }
+
+    frameCount_ = 0;
+    expected_   = 0;
+}
+
+uint8_t UsbHidDigitizerReport::findRow(uint32_t id) const
+{
+    const uint8_t row = rowById_[id & 0xFF];
+    if (row != NO_ROW && contacts_[row].touching && contacts_[row].id == id)
+    {
+        return row;
+    }
+
+    // IDs sharing a low byte with another contact are rare; only then scan the table
+    for (uint8_t r = 0; r < MAX_CONTACTS && unindexedCount_ > 0; ++r)
+    {
+        if (contacts_[r].touching && contacts_[r].id == id)
+        {
+            return r;
+        }
+    }
+    return NO_ROW;
+}
+
+void UsbHidDigitizerReport::lift(uint8_t row)
+{
+    Contact& contact = contacts_[row];
+    contact.touching = false;
+    --activeCount_;
+
+    if (contact.indexed)
+    {
+        rowById_[contact.id & 0xFF] = NO_ROW;
+    }
+    else
+    {
+        --unindexedCount_;
+    }
+    emit(UsbHidTouchPhase::Up, contact);
+}
+
+void UsbHidDigitizerReport::releaseAll()
+{
+    for (uint8_t r = 0; r < MAX_CONTACTS; ++r)
+    {
+        if (contacts_[r].touching)
+        {
+            lift(r);
+        }
+    }
+    frameCount_ = 0;
+    expected_   = 0;
+    rawReport_.clear();
+}
+
+void UsbHidDigitizerReport::emit(UsbHidTouchPhase phase, const Contact& contact)
+{
+    phase_        = phase;
+    eventContact_ = &contact;
+    triggerEvent(createEvent());
+    eventContact_ = nullptr;
+}
+
+UsbHidTouchEvent UsbHidDigitizerReport::createEvent() const
+{
+    UsbHidTouchEvent event;
+    event.phase        = phase_;
+    event.contactCount = static_cast<uint8_t>(activeCount_);
+    event.time         = wheel_.now();
+    if (eventContact_ != nullptr)
+    {
+        event.contactId = eventContact_->id;
+        event.x         = eventContact_->x;
+        event.y         = eventContact_->y;
+    }
+    return event;
+}
@@ -0,0 +1,167 @@
+/**
+ * @file UsbHidDigitizerReport.h
+ * @brief Defines the UsbHidDigitizerReport class for multi-touch panels.
+ */
+
+#pragma once
+
+#include "UsbHidBaseReport.h"
+#include "UsbHidExtractionPlan.h"
+#include "UsbHidReportDescriptor.h"
+#include "UsbHidTimerWheel.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @enum UsbHidTouchPhase
+ * @brief What happened to a contact.
+ */
+enum class UsbHidTouchPhase : uint8_t
+{
+    Down,  ///< The contact touched the surface
+    Move,  ///< The contact moved
+    Up     ///< The contact left the surface
+};
+
+/**
+ * @struct UsbHidTouchEvent
+ * @brief One contact changing, after a complete frame.
+ */
+struct UsbHidTouchEvent
+{
+    UsbHidDeviceType deviceType_;  ///< Type of the USB HID device
+    UsbHidTouchPhase phase;
+    uint32_t contactId;    ///< Contact Identifier from the device, stable from down to up
+    int32_t x;             ///< Logical X, 0 - getMaxX()
+    int32_t y;             ///< Logical Y, 0 - getMaxY()
+    uint8_t contactCount;  ///< Contacts on the surface after this event
+    uint32_t time;         ///< Timer wheel time of the frame, in milliseconds
+
+    UsbHidTouchEvent()
+        : deviceType_(UsbHidDeviceType::Digitizer), phase(UsbHidTouchPhase::Up), contactId(0), x(0), y(0),
+          contactCount(0), time(0)
+    {
+    }
+};
+
+/**
+ * @class UsbHidDigitizerReport
+ * @brief Decodes multi-touch digitizer reports and tracks contacts from down to up.
+ *
+ * The input report is split into contact slots (Tip Switch, Confidence, Contact
+ * Identifier, X, Y), a new slot starting wherever a usage repeats. Contacts are gathered
+ * into frames: in hybrid mode the first report of a frame carries the total Contact Count
+ * and later reports carry 0 and the remaining contacts. Once a frame is complete it is
+ * matched against the contact table, which maps contact IDs to rows through a 256-entry
+ * index, so a frame costs O(contacts); only IDs sharing a low byte fall back to a scan.
+ * Contacts missing from a frame are lifted.
+ *
+ * Single-touch digitizers without Contact Identifier or Contact Count work too: each slot
+ * is its own contact and every report is a frame.
+ */
+class UsbHidDigitizerReport : public UsbHidBaseReport<UsbHidTouchEvent, UsbHidDeviceType::Digitizer>
+{
+public:
+    using Millis = UsbHidTimerWheel::Millis;
+
+    /// Contacts tracked at once
+    static constexpr size_t MAX_CONTACTS = 10;
+
+    /**
+     * @param wheel Timer wheel providing frame timestamps; the host advances it before each report.
+     */
+    explicit UsbHidDigitizerReport(const UsbHidTimerWheel& wheel);
+
+    void processReportData(const uint8_t* const data, int length) override;
+    void releaseAll() override;  // Lifts all contacts with Up events
+
+    /**
+     * @brief Decode reports using a touch panel's report descriptor.
+     *
+     * @return true if the descriptor has an input report with X/Y contacts.
+     */
+    bool useDescriptor(const UsbHidReportDescriptor& descriptor);
+
+    size_t getContactCount() const { return activeCount_; }
+    int32_t getMaxX() const { return maxX_; }
+    int32_t getMaxY() const { return maxY_; }
+    uint8_t getInputReportId() const { return inputReportId_; }  // 0 if reports carry no ID
+
+protected:
+    UsbHidTouchEvent createEvent() const override;
+
+private:
+    static constexpr uint16_t USAGE_PAGE_GENERIC_DESKTOP = 0x01;
+    static constexpr uint16_t USAGE_PAGE_DIGITIZER       = 0x0D;
+    static constexpr uint16_t USAGE_X                    = 0x30;
+    static constexpr uint16_t USAGE_Y                    = 0x31;
+    static constexpr uint16_t USAGE_TIP_SWITCH           = 0x42;
+    static constexpr uint16_t USAGE_CONFIDENCE           = 0x47;
+    static constexpr uint16_t USAGE_CONTACT_ID           = 0x51;
+    static constexpr uint16_t USAGE_CONTACT_COUNT        = 0x54;
+
+    /// Slot field not in the report
+    static constexpr uint16_t NONE = 0xFFFF;
+    /// Row index of an unused contact table index entry
+    static constexpr uint8_t NO_ROW = 0xFF;
+
+    /**
+     * @struct Slot
+     * @brief Where one contact's fields are among the values of the report.
+     */
+    struct Slot
+    {
+        uint16_t tip        = NONE;
+        uint16_t confidence = NONE;
+        uint16_t contactId  = NONE;
+        uint16_t x          = NONE;
+        uint16_t y          = NONE;
+    };
+
+    /**
+     * @struct Contact
+     * @brief A contact of the current frame, or a row of the contact table.
+     */
+    struct Contact
+    {
+        uint32_t id;
+        int32_t x;
+        int32_t y;
+        bool touching;      ///< Frame: tip down and confident. Table: row in use
+        bool indexed;       ///< Table: rowById_ points at this row
+        uint32_t lastSeen;  ///< Table: frame that last reported the contact
+    };
+
+    const UsbHidTimerWheel& wheel_;
+
+    UsbHidExtractionPlan plan_;
+    std::vector<int32_t> raw_;  ///< extract() output, sized for the largest report
+    std::vector<Slot> slots_;   ///< Contact slots of the input report
+    uint16_t contactCountIndex_;
+    uint8_t inputReportId_;
+    int32_t maxX_;
+    int32_t maxY_;
+
+    // Frame being gathered
+    std::array<Contact, MAX_CONTACTS> frame_;
+    size_t frameCount_;
+    size_t expected_;  ///< Contacts the frame will hold
+
+    // Contact table
+    std::array<Contact, MAX_CONTACTS> contacts_;
+    std::array<uint8_t, 256> rowById_;  ///< Low byte of the contact ID to table row
+    size_t activeCount_;
+    size_t unindexedCount_;  ///< Active contacts whose low byte was taken, found by scanning
+    uint32_t frameNumber_;
+
+    // Event being reported
+    UsbHidTouchPhase phase_;
+    const Contact* eventContact_;
+
+    void finishFrame();
+    uint8_t findRow(uint32_t id) const;
+    void emit(UsbHidTouchPhase phase, const Contact& contact);
+    void lift(uint8_t row);
+};
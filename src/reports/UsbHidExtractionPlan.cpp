@@ -0,0 +1,301 @@
+/**
+ * @file UsbHidExtractionPlan.cpp
+ * @brief Implements the UsbHidExtractionPlan class, a flat per-report list of fields to extract.
+ */
+
+#include "UsbHidExtractionPlan.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include <esp_log.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+constexpr const char* TAG = "ExtractionPlan";
+
+/// Entries kept from one descriptor; start_ holds 16-bit indices
+constexpr size_t MAX_ENTRIES = 4096;
+
+/// Widest element, offset within its first byte included, read with one 32-bit load
+constexpr uint32_t WORD_BITS = 32;
+
+/// Raw values decode() resolves per kernel call
+constexpr size_t DECODE_CHUNK = 32;
+
+/// Sign extend with a precomputed sign bit: (v ^ s) - s, a no-op when s is 0
+inline int32_t applySign(uint32_t value, uint32_t signBit)
+{
+    return static_cast<int32_t>((value ^ signBit) - signBit);
+}
+}  // namespace
+
+void UsbHidExtractionPlan::Lanes::clear()
+{
+    byteOffset.clear();
+    end.clear();
+    shift.clear();
+    mask.clear();
+    signBit.clear();
+}
+
+UsbHidExtractionPlan::UsbHidExtractionPlan()
+    : start_{},
+      usesReportIds_(false),
+      maxValues_(0)
+{
+}
+
+void UsbHidExtractionPlan::clear()
+{
+    entries_.clear();
+    lanes_.clear();
+    applications_.clear();
+    start_.fill(0);
+    usesReportIds_ = false;
+    maxValues_     = 0;
+}
+
+bool UsbHidExtractionPlan::build(const UsbHidReportDescriptor& descriptor, UsbHidReportType type)
+{
+    clear();
+
+    struct Keyed
+    {
+        uint8_t reportId;
+        uint8_t application;
+        Entry entry;
+    };
+    std::vector<Keyed> keyed;
+
+    for (const auto& field : descriptor.fields())
+    {
+        if (field.type != type || field.isConstant())
+        {
+            continue;
+        }
+
+        Entry entry{};
+        entry.bitSize    = field.bitSize;
+        entry.usagePage  = field.usagePage;
+        entry.logicalMin = field.logicalMin;
+        entry.logicalMax = field.logicalMax;
+        entry.flags      = (field.isSigned() ? ENTRY_SIGNED : 0) |
+                      (field.isArray() ? ENTRY_ARRAY : 0) |
+                      (field.isRelative() ? ENTRY_RELATIVE : 0);
+
+        for (uint16_t i = 0; i < field.count; ++i)
+        {
+            if (keyed.size() == MAX_ENTRIES)
+            {
+                ESP_LOGW(TAG, "Descriptor has more than %u elements, ignoring the rest", static_cast<unsigned>(MAX_ENTRIES));
+                break;
+            }
+            entry.bitOffset = static_cast<uint16_t>(field.bitOffset + i * field.bitSize);
+            entry.usage     = field.isArray() ? field.usageMin
+                                              : static_cast<uint16_t>(std::min<uint32_t>(field.usageMin + i, field.usageMax));
+            keyed.push_back({field.reportId, field.application, entry});
+        }
+    }
+
+    std::stable_sort(keyed.begin(), keyed.end(), [](const Keyed& a, const Keyed& b)
+                     { return a.reportId != b.reportId ? a.reportId < b.reportId : a.entry.bitOffset < b.entry.bitOffset; });
+
+    // Counting pass, then prefix sums: start_[r] is the first entry of report r
+    std::array<uint16_t, 256> counts{};
+    for (const auto& k : keyed)
+    {
+        ++counts[k.reportId];
+    }
+    for (size_t r = 0; r < counts.size(); ++r)
+    {
+        start_[r + 1] = start_[r] + counts[r];
+        maxValues_    = std::max<size_t>(maxValues_, counts[r]);
+    }
+
+    entries_.reserve(keyed.size());
+    applications_.reserve(keyed.size());
+    for (const auto& k : keyed)
+    {
+        const Entry& entry  = k.entry;
+        const uint32_t byte = entry.bitOffset >> 3;
+        const uint32_t bit  = entry.bitOffset & 7;
+        const bool isSigned = (entry.flags & ENTRY_SIGNED) && entry.bitSize < 32;
+
+        entries_.push_back(entry);
+        applications_.push_back(k.application);
+        lanes_.byteOffset.push_back(static_cast<int32_t>(byte));
+        lanes_.end.push_back(bit + entry.bitSize <= WORD_BITS ? static_cast<int32_t>(byte + 4) : INT32_MAX);
+        lanes_.shift.push_back(bit);
+        lanes_.mask.push_back(static_cast<uint32_t>((uint64_t(1) << entry.bitSize) - 1));
+        lanes_.signBit.push_back(isSigned ? 1u << (entry.bitSize - 1) : 0);
+    }
+    usesReportIds_ = descriptor.usesReportIds();
+    return !entries_.empty();
+}
+
+const UsbHidExtractionPlan::Entry* UsbHidExtractionPlan::entries(uint8_t reportId, size_t& count) const
+{
+    count = start_[reportId + 1] - start_[reportId];
+    return entries_.data() + start_[reportId];
+}
+
+size_t UsbHidExtractionPlan::locate(const uint8_t*& data, size_t& length, size_t& count) const
+{
+    uint8_t reportId = 0;
+    if (usesReportIds_)
+    {
+        if (length == 0)
+        {
+            count = 0;
+            return 0;
+        }
+        reportId = data[0];
+        ++data;
+        --length;
+    }
+
+    count = start_[reportId + 1] - start_[reportId];
+    return start_[reportId];
+}
+
+size_t UsbHidExtractionPlan::extract(const uint8_t* data, size_t length, int32_t* out, size_t capacity, bool allowSimd) const
+{
+    size_t count       = 0;
+    const size_t first = locate(data, length, count);
+    count              = std::min(count, capacity);
+
+    if (allowSimd && hasSimdKernel())
+    {
+        extractSimd(data, length, first, count, out);
+    }
+    else
+    {
+        extractScalar(data, length, first, count, out);
+    }
+    return count;
+}
+
+size_t UsbHidExtractionPlan::decode(const uint8_t* data, size_t length, UsbHidFieldValue* out, size_t capacity) const
+{
+    size_t count       = 0;
+    const size_t first = locate(data, length, count);
+
+    // Unpack in chunks with the batched kernel, then attach usages
+    int32_t raw[DECODE_CHUNK];
+    size_t written = 0;
+    for (size_t base = 0; base < count && written < capacity; base += DECODE_CHUNK)
+    {
+        const size_t chunk = std::min(DECODE_CHUNK, count - base);
+        if (hasSimdKernel())
+        {
+            extractSimd(data, length, first + base, chunk, raw);
+        }
+        else
+        {
+            extractScalar(data, length, first + base, chunk, raw);
+        }
+
+        const Entry* entry = entries_.data() + first + base;
+        for (size_t i = 0; i < chunk && written < capacity; ++i, ++entry)
+        {
+            const int32_t value = raw[i];
+            if (entry->flags & ENTRY_ARRAY)
+            {
+                const uint16_t usage = static_cast<uint16_t>(entry->usage + (value - entry->logicalMin));
+                if (value < entry->logicalMin || value > entry->logicalMax || usage == 0)
+                {
+                    continue;  // Empty slot, or usage 0 (no event)
+                }
+                out[written++] = {entry->usagePage, usage, 1};
+            }
+            else
+            {
+                out[written++] = {entry->usagePage, entry->usage, value};
+            }
+        }
+    }
+    return written;
+}
+
+void UsbHidExtractionPlan::extractScalar(const uint8_t* payload, size_t length, size_t first, size_t count, int32_t* out) const
+{
+    for (size_t i = first; i < first + count; ++i)
+    {
+        uint32_t value;
+        if (static_cast<size_t>(lanes_.end[i]) <= length)
+        {
+            // Common case: the element fits one unaligned little-endian word
+            uint32_t word;
+            std::memcpy(&word, payload + lanes_.byteOffset[i], sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            word = __builtin_bswap32(word);
+#endif
+            value = (word >> lanes_.shift[i]) & lanes_.mask[i];
+        }
+        else
+        {
+            // Wide elements and elements near the end of the report
+            const Entry& entry = entries_[i];
+            value              = readBits(payload, length, entry.bitOffset, entry.bitSize);
+        }
+        *out++ = applySign(value, lanes_.signBit[i]);
+    }
+}
+
+#if defined(__AVX2__)
+
+bool UsbHidExtractionPlan::hasSimdKernel()
+{
+    return true;
+}
+
+void UsbHidExtractionPlan::extractSimd(const uint8_t* payload, size_t length, size_t first, size_t count, int32_t* out) const
+{
+    constexpr size_t LANES = 8;
+
+    // Blocks whose words all lie inside the report take the vector path
+    const __m256i limit = _mm256_set1_epi32(static_cast<int32_t>(std::min<size_t>(length, INT32_MAX)));
+    size_t i            = first;
+    for (; i + LANES <= first + count; i += LANES, out += LANES)
+    {
+        const __m256i end = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes_.end.data() + i));
+        if (_mm256_movemask_epi8(_mm256_cmpgt_epi32(end, limit)) != 0)
+        {
+            extractScalar(payload, length, i, LANES, out);
+            continue;
+        }
+
+        const __m256i offset  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes_.byteOffset.data() + i));
+        const __m256i shift   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes_.shift.data() + i));
+        const __m256i mask    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes_.mask.data() + i));
+        const __m256i signBit = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes_.signBit.data() + i));
+
+        __m256i value = _mm256_i32gather_epi32(reinterpret_cast<const int*>(payload), offset, 1);
+        value         = _mm256_and_si256(_mm256_srlv_epi32(value, shift), mask);
+        value         = _mm256_sub_epi32(_mm256_xor_si256(value, signBit), signBit);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), value);
+    }
+
+    extractScalar(payload, length, i, first + count - i, out);
+}
+
+#else
+
+bool UsbHidExtractionPlan::hasSimdKernel()
+{
+    // The Xtensa PIE extension has neither gathers nor per-lane shifts, the scalar kernel is used
+    return false;
+}
+
+void UsbHidExtractionPlan::extractSimd(const uint8_t* payload, size_t length, size_t first, size_t count, int32_t* out) const
+{
+    extractScalar(payload, length, first, count, out);
+}
+
+#endif
@@ -0,0 +1,199 @@
+/**
+ * @file UsbHidExtractionPlan.h
+ * @brief Defines the UsbHidExtractionPlan class, a flat per-report list of fields to extract.
+ */
+
+#pragma once
+
+#include "UsbHidReportDescriptor.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct UsbHidFieldValue
+ * @brief One decoded element of a report.
+ */
+struct UsbHidFieldValue
+{
+    uint16_t usagePage;
+    uint16_t usage;
+    int32_t value;  ///< Logical value; 1 for an active array usage
+};
+
+/**
+ * @class UsbHidExtractionPlan
+ * @brief A parsed report descriptor flattened into one entry per report element.
+ *
+ * Entries are 16 bytes, grouped by report ID and sorted by bit offset, with an index
+ * from report ID to its first entry. Decoding a report is a single loop over the
+ * entries of its report ID, with no descriptor lookups.
+ *
+ * Variable elements yield their value on every report. Array elements yield the usage
+ * they select, with value 1, and nothing when empty (outside the logical range or usage 0).
+ */
+class UsbHidExtractionPlan
+{
+public:
+    /// Entry flags
+    static constexpr uint8_t ENTRY_SIGNED   = 1 << 0;  ///< Sign extend the element
+    static constexpr uint8_t ENTRY_ARRAY    = 1 << 1;  ///< The element is a usage index
+    static constexpr uint8_t ENTRY_RELATIVE = 1 << 2;  ///< The element is a relative value
+
+    /**
+     * @struct Entry
+     * @brief Where one element lives in a report and what it means.
+     */
+    struct Entry
+    {
+        uint16_t bitOffset;  ///< Offset in the payload, not counting the report ID byte
+        uint8_t bitSize;     ///< 1 - 32
+        uint8_t flags;       ///< ENTRY_ flags
+        uint16_t usagePage;
+        uint16_t usage;      ///< Usage of a variable element, first usage of an array element
+        int32_t logicalMin;
+        int32_t logicalMax;
+    };
+
+    UsbHidExtractionPlan();
+
+    /**
+     * @brief Build the plan for one report type from a parsed descriptor.
+     *
+     * @return true if the descriptor has elements of that type.
+     */
+    bool build(const UsbHidReportDescriptor& descriptor, UsbHidReportType type = UsbHidReportType::Input);
+
+    /**
+     * @brief Forget all entries.
+     */
+    void clear();
+
+    bool empty() const { return entries_.empty(); }
+    bool usesReportIds() const { return usesReportIds_; }
+
+    /**
+     * @brief Get the largest number of values one report can decode to.
+     */
+    size_t maxValues() const { return maxValues_; }
+
+    /**
+     * @brief Get the entries of one report.
+     *
+     * @param reportId Report ID, 0 if the descriptor does not use report IDs.
+     * @param count Receives the number of entries.
+     */
+    const Entry* entries(uint8_t reportId, size_t& count) const;
+
+    /**
+     * @brief Get the index of the first entry of a report, among all entries.
+     *
+     * Values returned by extract() for that report belong to entries firstEntry(),
+     * firstEntry() + 1, ..., so callers can keep per-entry tables of entryCount() size.
+     */
+    size_t firstEntry(uint8_t reportId) const { return start_[reportId]; }
+
+    /**
+     * @brief Get the number of entries of all reports.
+     */
+    size_t entryCount() const { return entries_.size(); }
+
+    /**
+     * @brief Get the application collection an entry belongs to.
+     *
+     * @param entry Index among all entries, as for firstEntry().
+     * @return uint8_t Index into UsbHidReportDescriptor::applications(), or UsbHidReportField::NO_APPLICATION.
+     */
+    uint8_t application(size_t entry) const { return applications_[entry]; }
+
+    /**
+     * @brief Decode a report.
+     *
+     * @param data Report data, including the report ID byte if the descriptor uses report IDs.
+     * @param length Length of the report in bytes.
+     * @param out Receives the values, at most capacity of them.
+     * @param capacity Size of out; maxValues() is always enough.
+     * @return size_t Number of values written.
+     */
+    size_t decode(const uint8_t* data, size_t length, UsbHidFieldValue* out, size_t capacity) const;
+
+    /**
+     * @brief Unpack every element of a report into a dense array, in entry order.
+     *
+     * Values are sign extended for signed entries; array elements are left as raw
+     * indices. Elements outside the report read as 0.
+     *
+     * @param data Report data, including the report ID byte if the descriptor uses report IDs.
+     * @param length Length of the report in bytes.
+     * @param out Receives the values, at most capacity of them.
+     * @param capacity Size of out; maxValues() is always enough.
+     * @param allowSimd Use the SIMD kernel if one was compiled in; both give identical results.
+     * @return size_t Number of values written.
+     */
+    size_t extract(const uint8_t* data, size_t length, int32_t* out, size_t capacity, bool allowSimd = true) const;
+
+    /**
+     * @brief Check whether a SIMD extraction kernel was compiled in.
+     */
+    static bool hasSimdKernel();
+
+    /**
+     * @brief Read a bit field from a payload.
+     *
+     * @return uint32_t The field, zero extended; 0 if it lies outside the payload.
+     */
+    static uint32_t readBits(const uint8_t* payload, size_t length, uint32_t bitOffset, uint8_t bitSize)
+    {
+        const size_t first   = bitOffset >> 3;
+        const uint32_t shift = bitOffset & 7;
+        const size_t bytes   = (shift + bitSize + 7) >> 3;
+        if (first + bytes > length)
+        {
+            return 0;
+        }
+
+        uint64_t window = 0;
+        for (size_t b = 0; b < bytes; ++b)
+        {
+            window |= static_cast<uint64_t>(payload[first + b]) << (8 * b);
+        }
+        const uint64_t mask = (uint64_t(1) << bitSize) - 1;
+        return static_cast<uint32_t>((window >> shift) & mask);
+    }
+
+private:
+    /**
+     * @struct Lanes
+     * @brief Entries unpacked into one array per operand, for the extraction kernels.
+     *
+     * Elements of up to WORD_BITS bits, offset included, are read with one 32-bit load.
+     */
+    struct Lanes
+    {
+        std::vector<int32_t> byteOffset;  ///< First payload byte of the element
+        std::vector<int32_t> end;         ///< byteOffset + 4, INT32_MAX for elements wider than a word
+        std::vector<uint32_t> shift;      ///< Bit offset within the first byte
+        std::vector<uint32_t> mask;       ///< (1 << bitSize) - 1
+        std::vector<uint32_t> signBit;    ///< 1 << (bitSize - 1) for signed entries, 0 otherwise
+
+        void clear();
+    };
+
+    std::vector<Entry> entries_;        ///< Grouped by report ID, in bit order
+    Lanes lanes_;                       ///< entries_ in kernel form, same order
+    std::vector<uint8_t> applications_; ///< Application index of each entry, kept out of Entry
+    std::array<uint16_t, 257> start_;   ///< Entries of report r are [start_[r], start_[r + 1])
+    bool usesReportIds_;
+    size_t maxValues_;
+
+    /**
+     * @brief Strip the report ID and find the entries of the report.
+     *
+     * @return size_t Index of the first entry; count receives the number of entries.
+     */
+    size_t locate(const uint8_t*& data, size_t& length, size_t& count) const;
+
+    void extractScalar(const uint8_t* payload, size_t length, size_t first, size_t count, int32_t* out) const;
+    void extractSimd(const uint8_t* payload, size_t length, size_t first, size_t count, int32_t* out) const;
+};
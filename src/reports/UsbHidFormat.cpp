@@ -0,0 +1,64 @@
+/**
+ * @file UsbHidFormat.cpp
+ * @brief Allocation-free string formatting helpers for diagnostics.
+ */
+
+#include "UsbHidFormat.h"
+
+namespace UsbHidFormat
+{
+size_t append(char* buffer, size_t size, size_t pos, std::string_view text)
+{
+    if (size == 0)
+    {
+        return 0;
+    }
+    if (pos >= size)
+    {
+        pos = size - 1;
+    }
+
+    size_t n = text.size();
+    if (n > size - 1 - pos)
+    {
+        n = size - 1 - pos;
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        buffer[pos + i] = text[i];
+    }
+
+    pos += n;
+    buffer[pos] = '\0';
+    return pos;
+}
+
+size_t hex(const uint8_t* data, size_t length, char* buffer, size_t size)
+{
+    static constexpr char DIGITS[] = "0123456789ABCDEF";
+
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    size_t pos = 0;
+    for (size_t i = 0; i < length; ++i)
+    {
+        const size_t needed = (i == 0) ? 2 : 3;
+        if (pos + needed > size - 1)
+        {
+            break;
+        }
+        if (i != 0)
+        {
+            buffer[pos++] = ' ';
+        }
+        buffer[pos++] = DIGITS[data[i] >> 4];
+        buffer[pos++] = DIGITS[data[i] & 0x0F];
+    }
+
+    buffer[pos] = '\0';
+    return pos;
+}
+}  // namespace UsbHidFormat
@@ -0,0 +1,42 @@
+/**
+ * @file UsbHidFormat.h
+ * @brief Allocation-free string formatting helpers for diagnostics.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @namespace UsbHidFormat
+ * @brief Helpers that write into a caller-provided buffer.
+ *
+ * All functions truncate to fit the buffer, always NUL-terminate it when its size
+ * is non-zero, and never allocate.
+ */
+namespace UsbHidFormat
+{
+/**
+ * @brief Append text at a position in a buffer.
+ *
+ * @param buffer Destination buffer.
+ * @param size Size of the buffer in bytes.
+ * @param pos Position to write at, normally the return value of the previous call.
+ * @param text Text to append.
+ * @return size_t Position of the terminating NUL after appending.
+ */
+size_t append(char* buffer, size_t size, size_t pos, std::string_view text);
+
+/**
+ * @brief Format bytes as space-separated upper-case hex, e.g. "01 A0 FF".
+ *
+ * @param data Bytes to format.
+ * @param length Number of bytes.
+ * @param buffer Destination buffer, 3 bytes per input byte are needed to avoid truncation.
+ * @param size Size of the buffer in bytes.
+ * @return size_t Number of characters written, not counting the terminating NUL.
+ */
+size_t hex(const uint8_t* data, size_t length, char* buffer, size_t size);
+}  // namespace UsbHidFormat
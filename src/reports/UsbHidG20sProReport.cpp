@@ -1,79 +1,183 @@
 #include "UsbHidG20sProReport.h"
-#include <sstream>
-#include <iomanip>
+#include <algorithm>
+#include <array>
+
+namespace
+{
+/**
+ * @struct ButtonDef
+ * @brief A button with the report ID and first code byte it is sent with, and its name.
+ */
+struct ButtonDef
+{
+    G20sProBtn button;
+    uint8_t reportId;  ///< 0 if the button is not sent in a button report
+    uint8_t code;
+    std::string_view name;
+};
+
+/// Every button, in G20sProBtn order. The profile's code map and name table are both built from this.
+constexpr ButtonDef BUTTONS[] = {
+    {G20sProBtn::Power, 0x05, 0x01, "Power"},
+    {G20sProBtn::Mute, 0x04, 0xE2, "Mute"},
+    {G20sProBtn::PgUp, 0x01, 0x4B, "PgUp"},
+    {G20sProBtn::PgDown, 0x01, 0x4E, "PgDown"},
+    {G20sProBtn::Left, 0x01, 0x50, "Left"},
+    {G20sProBtn::Down, 0x01, 0x51, "Down"},
+    {G20sProBtn::Up, 0x01, 0x52, "Up"},
+    {G20sProBtn::Right, 0x01, 0x4F, "Right"},
+    {G20sProBtn::Enter, 0x01, 0x28, "Enter"},
+    {G20sProBtn::Back, 0x04, 0x24, "Back"},
+    {G20sProBtn::Home, 0x04, 0x23, "Home"},
+    {G20sProBtn::VolDown, 0x04, 0xEA, "VolDown"},
+    {G20sProBtn::Mic, 0x04, 0xCF, "Mic"},
+    {G20sProBtn::VolUp, 0x04, 0xE9, "VolUp"},
+    {G20sProBtn::Prev, 0x04, 0xB6, "Prev"},
+    {G20sProBtn::Play, 0x04, 0xCD, "Play"},
+    {G20sProBtn::Next, 0x04, 0xB5, "Next"},
+    {G20sProBtn::Num1, 0x01, 0x1E, "1"},
+    {G20sProBtn::Num2, 0x01, 0x1F, "2"},
+    {G20sProBtn::Num3, 0x01, 0x20, "3"},
+    {G20sProBtn::Num4, 0x01, 0x21, "4"},
+    {G20sProBtn::Num5, 0x01, 0x22, "5"},
+    {G20sProBtn::Num6, 0x01, 0x23, "6"},
+    {G20sProBtn::Num7, 0x01, 0x24, "7"},
+    {G20sProBtn::Num8, 0x01, 0x25, "8"},
+    {G20sProBtn::Num9, 0x01, 0x26, "9"},
+    {G20sProBtn::Num0, 0x01, 0x27, "0"},
+    {G20sProBtn::Backspace, 0x01, 0x2A, "Backspace"},
+    {G20sProBtn::App, 0x01, 0x65, "App"},
+    {G20sProBtn::MouseLeft, 0x00, 0x00, "MouseLeft"},
+    {G20sProBtn::MouseRight, 0x00, 0x00, "MouseRight"},
+};
+
+constexpr size_t BUTTON_COUNT = static_cast<size_t>(G20sProBtn::Unknown);
+static_assert(std::size(BUTTONS) == BUTTON_COUNT, "BUTTONS must list every G20sProBtn but Unknown");
+
+constexpr bool buttonsInOrder()
+{
+    for (size_t i = 0; i < BUTTON_COUNT; ++i)
+    {
+        if (static_cast<size_t>(BUTTONS[i].button) != i)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(buttonsInOrder(), "BUTTONS must be in G20sProBtn order, button numbers are enum values");
+
+constexpr size_t codeCount()
+{
+    size_t count = 0;
+    for (const auto& def : BUTTONS)
+    {
+        count += def.reportId != 0 ? 1 : 0;
+    }
+    return count;
+}
+
+constexpr std::array<UsbHidRemoteProfile::Code, codeCount()> makeCodes()
+{
+    std::array<UsbHidRemoteProfile::Code, codeCount()> codes{};
+    size_t count = 0;
+    for (const auto& def : BUTTONS)
+    {
+        if (def.reportId != 0)
+        {
+            codes[count++] = {def.reportId, def.code, static_cast<uint8_t>(def.button)};
+        }
+    }
+    return codes;
+}
+
+constexpr std::array<std::string_view, BUTTON_COUNT> makeNames()
+{
+    std::array<std::string_view, BUTTON_COUNT> names{};
+    for (size_t i = 0; i < BUTTON_COUNT; ++i)
+    {
+        names[i] = BUTTONS[i].name;
+    }
+    return names;
+}
+
+constexpr auto CODES = makeCodes();
+constexpr auto NAMES = makeNames();
+
+/// Keyboard page keys (0x01), consumer keys (0x04), power (0x05), and mouse reports without a report ID
+constexpr UsbHidRemoteProfile::Signature SIGNATURES[] = {
+    {0x01, 8, UsbHidRemoteReportKind::Buttons},
+    {0x04, 3, UsbHidRemoteReportKind::Buttons},
+    {0x05, 2, UsbHidRemoteReportKind::Buttons},
+    {UsbHidRemoteProfile::ANY_REPORT_ID, 4, UsbHidRemoteReportKind::Mouse},
+};
+
+constexpr UsbHidRemoteProfile G20S_PRO_PROFILE = {
+    "G20s Pro",
+    0x0C40,
+    0x7A1C,
+    SIGNATURES,
+    std::size(SIGNATURES),
+    CODES.data(),
+    CODES.size(),
+    NAMES.data(),
+    NAMES.size(),
+    static_cast<uint8_t>(G20sProBtn::MouseLeft),
+    static_cast<uint8_t>(G20sProBtn::MouseRight),
+    UsbHidMotionFilter::Config::airMouse(),
+};
+
+/// The G20s Pro profile compiled at compile time and kept in flash
+constexpr UsbHidRemoteDecoder G20S_PRO_DECODER(G20S_PRO_PROFILE);
+static_assert(G20S_PRO_DECODER.isValid(), "G20s Pro profile is ambiguous or exceeds the decoder limits");
+static_assert(UsbHidRemoteDecoder::MAX_BUTTONS <= 32, "heldButtons_ has one bit per button");
+}  // namespace
 
 UsbHidG20sProReport::UsbHidG20sProReport()
+    : report_{},
+      lastPressedButton(UsbHidRemoteProfile::NO_BUTTON),
+      buttonPressed(false),
+      mouseX(0),
+      mouseY(0),
+      decoder_(&G20S_PRO_DECODER),
+      heldButtons_(0),
+      reportButton_{},
+      mouseButtons_(0),
+      motionFilter_(G20S_PRO_PROFILE.motionFilter),
+      motionFilterSet_(false)
 {
+    reportButton_.fill(UsbHidRemoteProfile::NO_BUTTON);
     // Initialize the report vector
     rawReport_.clear();
 }
 
-const std::unordered_map<G20sProBtn, ButtonCode> UsbHidG20sProReport::btnCodeMap = {
-    {G20sProBtn::Power, {0x05, 0x01}},
-    {G20sProBtn::Mute, {0x04, 0xE2}},
-    {G20sProBtn::PgUp, {0x01, 0x4B}},
-    {G20sProBtn::PgDown, {0x01, 0x4E}},
-    {G20sProBtn::Left, {0x01, 0x50}},
-    {G20sProBtn::Down, {0x01, 0x51}},
-    {G20sProBtn::Up, {0x01, 0x52}},
-    {G20sProBtn::Right, {0x01, 0x4F}},
-    {G20sProBtn::Enter, {0x01, 0x28}},
-    {G20sProBtn::Back, {0x04, 0x24}},
-    {G20sProBtn::Home, {0x04, 0x23}},
-    {G20sProBtn::VolDown, {0x04, 0xEA}},
-    {G20sProBtn::Mic, {0x04, 0xCF}},
-    {G20sProBtn::VolUp, {0x04, 0xE9}},
-    {G20sProBtn::Prev, {0x04, 0xB6}},
-    {G20sProBtn::Play, {0x04, 0xCD}},
-    {G20sProBtn::Next, {0x04, 0xB5}},
-    {G20sProBtn::Num1, {0x01, 0x1E}},
-    {G20sProBtn::Num2, {0x01, 0x1F}},
-    {G20sProBtn::Num3, {0x01, 0x20}},
-    {G20sProBtn::Num4, {0x01, 0x21}},
-    {G20sProBtn::Num5, {0x01, 0x22}},
-    {G20sProBtn::Num6, {0x01, 0x23}},
-    {G20sProBtn::Num7, {0x01, 0x24}},
-    {G20sProBtn::Num8, {0x01, 0x25}},
-    {G20sProBtn::Num9, {0x01, 0x26}},
-    {G20sProBtn::Num0, {0x01, 0x27}},
-    {G20sProBtn::Backspace, {0x01, 0x2A}},
-    {G20sProBtn::App, {0x01, 0x65}},
-    {G20sProBtn::Unknown, {0x00, 0x00}},
-};
+const UsbHidRemoteDecoder& UsbHidG20sProReport::g20sProDecoder()
+{
+    return G20S_PRO_DECODER;
+}
 
-const std::unordered_map<G20sProBtn, std::string> UsbHidG20sProReport::btnNames = {
-    {G20sProBtn::Power, "Power"},
-    {G20sProBtn::Mute, "Mute"},
-    {G20sProBtn::PgUp, "PgUp"},
-    {G20sProBtn::PgDown, "PgDown"},
-    {G20sProBtn::Left, "Left"},
-    {G20sProBtn::Down, "Down"},
-    {G20sProBtn::Up, "Up"},
-    {G20sProBtn::Right, "Right"},
-    {G20sProBtn::Enter, "Enter"},
-    {G20sProBtn::Back, "Back"},
-    {G20sProBtn::Home, "Home"},
-    {G20sProBtn::VolDown, "VolDown"},
-    {G20sProBtn::Mic, "Mic"},
-    {G20sProBtn::VolUp, "VolUp"},
-    {G20sProBtn::Prev, "Prev"},
-    {G20sProBtn::Play, "Play"},
-    {G20sProBtn::Next, "Next"},
-    {G20sProBtn::Num1, "1"},
-    {G20sProBtn::Num2, "2"},
-    {G20sProBtn::Num3, "3"},
-    {G20sProBtn::Num4, "4"},
-    {G20sProBtn::Num5, "5"},
-    {G20sProBtn::Num6, "6"},
-    {G20sProBtn::Num7, "7"},
-    {G20sProBtn::Num8, "8"},
-    {G20sProBtn::Num9, "9"},
-    {G20sProBtn::Num0, "0"},
-    {G20sProBtn::Backspace, "Backspace"},
-    {G20sProBtn::App, "App"},
-    {G20sProBtn::MouseLeft, "MouseLeft"},
-    {G20sProBtn::MouseRight, "MouseRight"},
-    {G20sProBtn::Unknown, "Unknown"}};
+void UsbHidG20sProReport::useProfile(const UsbHidRemoteDecoder& decoder)
+{
+    if (&decoder == decoder_)
+    {
+        return;
+    }
+
+    releaseAll();
+    decoder_ = &decoder;
+    motionFilter_.setConfig(decoder.getProfile().motionFilter);
+    motionFilterSet_ = false;
+    ESP_LOGI("G20sProReport", "Using remote profile %.*s",
+             static_cast<int>(decoder.getProfile().name.size()), decoder.getProfile().name.data());
+}
+
+void UsbHidG20sProReport::useSettingsOf(const UsbHidG20sProReport& other)
+{
+    if (other.motionFilterSet_)
+    {
+        setMotionFilter(other.motionFilter_.getConfig());
+    }
+}
 
 void UsbHidG20sProReport::processReportData(const uint8_t* const data, int length)
 {
@@ -87,45 +191,55 @@ void UsbHidG20sProReport::processReportData(const uint8_t* const data, int lengt
         return;
     }
 
-    if (length == 4)
+    const UsbHidRemoteProfile::Signature* signature = decoder_->classify(data, length);
+    if (signature == nullptr)
     {
-        processMouseReport(data, length);
+        ESP_LOGW("G20sProReport", "Unknown report type. Length: %d, First byte: 0x%02X", length, data[0]);
+        return;
     }
-    else if ((length == 8 && data[0] == 0x01) ||
-             (length == 3 && data[0] == 0x04) ||
-             (length == 2 && data[0] == 0x05))
+
+    if (signature->kind == UsbHidRemoteReportKind::Mouse)
     {
-        processButtonReport(data, length);
+        const int offset = signature->reportId == UsbHidRemoteProfile::ANY_REPORT_ID ? 0 : 1;
+        if (length - offset < 3)
+        {
+            ESP_LOGW("G20sProReport", "Mouse report too short: %d", length);
+            return;
+        }
+        processMouseReport(signature->reportId, data + offset);
     }
     else
     {
-        ESP_LOGW("G20sProReport", "Unknown report type. Length: %d, First byte: 0x%02X", length, data[0]);
+        processButtonReport(data, length);
     }
-
-    triggerEvent(createEvent());
 }
-
-void UsbHidG20sProReport::processMouseReport(const uint8_t* data, int length)
+void UsbHidG20sProReport::processMouseReport(uint8_t reportId, const uint8_t* data)
 {
-    report_.reportId           = 0x00;  // Assume 0x00 for mouse reports
+    report_.reportId           = reportId;
     report_.data.mouse.buttons = data[0];
     report_.data.mouse.x       = static_cast<int8_t>(data[1]);
     report_.data.mouse.y       = static_cast<int8_t>(data[2]);
 
-    mouseX = report_.data.mouse.x;
-    mouseY = report_.data.mouse.y;
+    // Button edges first, then the motion of the report on its own
+    const uint8_t changed = report_.data.mouse.buttons ^ mouseButtons_;
+    mouseButtons_         = report_.data.mouse.buttons;
+    const UsbHidRemoteProfile& profile = decoder_->getProfile();
+    if ((changed & 0x01) && profile.mouseLeft != UsbHidRemoteProfile::NO_BUTTON)
+    {
+        setButton(profile.mouseLeft, mouseButtons_ & 0x01);
+    }
+    if ((changed & 0x02) && profile.mouseRight != UsbHidRemoteProfile::NO_BUTTON)
+    {
+        setButton(profile.mouseRight, mouseButtons_ & 0x02);
+    }
 
-    buttonPressed = (report_.data.mouse.buttons != 0);
-    if (buttonPressed)
+    // Still reports are filtered too, they let the smoothed motion settle
+    int32_t x = 0;
+    int32_t y = 0;
+    if (motionFilter_.filter(report_.data.mouse.x, report_.data.mouse.y, x, y))
     {
-        if (report_.data.mouse.buttons & 0x01)
-        {
-            lastPressedButton = G20sProBtn::MouseLeft;
-        }
-        else if (report_.data.mouse.buttons & 0x02)
-        {
-            lastPressedButton = G20sProBtn::MouseRight;
-        }
+        emitMotion(static_cast<int8_t>(std::clamp<int32_t>(x, INT8_MIN, INT8_MAX)),
+                   static_cast<int8_t>(std::clamp<int32_t>(y, INT8_MIN, INT8_MAX)));
     }
 }
 
@@ -133,6 +247,7 @@ void UsbHidG20sProReport::processButtonReport(const uint8_t* data, int length)
 {
     report_.reportId            = data[0];
     report_.data.button.keyCode = 0;
+    uint16_t code               = 0;
     uint8_t nonZeroCount        = 0;
 
     for (int i = 1; i < length; ++i)
@@ -141,7 +256,7 @@ void UsbHidG20sProReport::processButtonReport(const uint8_t* data, int length)
         {
             if (nonZeroCount < 2)
             {
-                report_.data.button.keyCode |= data[i] << (8 * nonZeroCount);
+                code |= data[i] << (8 * nonZeroCount);
                 ++nonZeroCount;
             }
             else
@@ -153,46 +268,106 @@ void UsbHidG20sProReport::processButtonReport(const uint8_t* data, int length)
         }
     }
 
-    ESP_LOGI("G20sProReport", "reportId=0x%02X, keyCode=0x%04X", report_.reportId, report_.data.button.keyCode);
+    // keyCode holds one byte; the first code byte is the one that identifies the button
+    report_.data.button.keyCode = static_cast<uint8_t>(code);
+    ESP_LOGI("G20sProReport", "reportId=0x%02X, keyCode=0x%04X", report_.reportId, code);
 
-    buttonPressed = (report_.data.button.keyCode != 0);
-    if (buttonPressed)
+    // Each button report holds at most one button: a new code releases the previous one
+    const uint8_t slot = decoder_->reportSlot(report_.reportId);
+    if (slot == UsbHidRemoteDecoder::NONE)
     {
-        lastPressedButton = buttonFromCode(report_.reportId, report_.data.button.keyCode);
+        return;
+    }
+
+    const uint8_t button = code != 0 ? buttonFromCode(report_.reportId, code) : UsbHidRemoteProfile::NO_BUTTON;
+    const uint8_t held   = reportButton_[slot];
+    if (button == held)
+    {
+        return;  // Unchanged, e.g. a repeated report
+    }
+
+    reportButton_[slot] = button;
+    if (held != UsbHidRemoteProfile::NO_BUTTON)
+    {
+        setButton(held, false);
+    }
+    if (button != UsbHidRemoteProfile::NO_BUTTON)
+    {
+        setButton(button, true);
     }
 }
 
-UsbHidG20sProEvent UsbHidG20sProReport::createEvent() const
+void UsbHidG20sProReport::setButton(uint8_t button, bool pressed)
 {
-    UsbHidG20sProEvent event;
-    event.button  = lastPressedButton;
-    event.pressed = buttonPressed;
-    event.mouseX  = mouseX;
-    event.mouseY  = mouseY;
-    return event;
+    const uint32_t bit = 1u << button;
+    if (((heldButtons_ & bit) != 0) == pressed)
+    {
+        return;  // Already in that state through another report
+    }
+    heldButtons_ ^= bit;
+
+    lastPressedButton = button;
+    buttonPressed     = pressed;
+    mouseX            = 0;
+    mouseY            = 0;
+    triggerEvent(createEvent());
 }
 
-G20sProBtn UsbHidG20sProReport::buttonFromCode(uint8_t reportId, uint16_t code)
+void UsbHidG20sProReport::emitMotion(int8_t x, int8_t y)
 {
-    for (const auto& mapping : btnCodeMap)
+    lastPressedButton = UsbHidRemoteProfile::NO_BUTTON;
+    buttonPressed     = false;
+    mouseX            = x;
+    mouseY            = y;
+    triggerEvent(createEvent());
+}
+
+bool UsbHidG20sProReport::isButtonPressed(uint8_t button) const
+{
+    return button < UsbHidRemoteDecoder::MAX_BUTTONS && (heldButtons_ & (1u << button)) != 0;
+}
+
+void UsbHidG20sProReport::releaseAll()
+{
+    for (uint8_t button = 0; button < UsbHidRemoteDecoder::MAX_BUTTONS; ++button)
     {
-        if (mapping.second.reportId == reportId && mapping.second.code == code)
-        {
-            return mapping.first;
-        }
+        setButton(button, false);
     }
 
-    ESP_LOGW("G20sProReport", "Unknown button code: reportId=0x%02X, code=0x%04X", reportId, code);
-    return G20sProBtn::Unknown;
+    reportButton_.fill(UsbHidRemoteProfile::NO_BUTTON);
+    mouseButtons_     = 0;
+    motionFilter_.reset();
+    lastPressedButton = UsbHidRemoteProfile::NO_BUTTON;
+    buttonPressed     = false;
+    report_           = {};
+    rawReport_.clear();
 }
 
-std::string UsbHidG20sProReport::buttonName(G20sProBtn button)
+UsbHidG20sProEvent UsbHidG20sProReport::createEvent() const
 {
-    auto it = btnNames.find(button);
-    if (it != btnNames.end())
+    UsbHidG20sProEvent event;
+    event.buttonId = lastPressedButton;
+    event.pressed  = buttonPressed;
+    event.mouseX   = mouseX;
+    event.mouseY   = mouseY;
+    if (decoder_ == &G20S_PRO_DECODER && lastPressedButton != UsbHidRemoteProfile::NO_BUTTON)
     {
-        return it->second;
+        event.button = static_cast<G20sProBtn>(lastPressedButton);
     }
+    return event;
+}
 
-    return "Unknown";
-}
\ No newline at end of file
+uint8_t UsbHidG20sProReport::buttonFromCode(uint8_t reportId, uint16_t code) const
+{
+    const uint8_t button = decoder_->buttonFromCode(reportId, static_cast<uint8_t>(code));
+    if (button == UsbHidRemoteProfile::NO_BUTTON)
+    {
+        ESP_LOGW("G20sProReport", "Unknown button code: reportId=0x%02X, code=0x%04X", reportId, code);
+    }
+    return button;
+}
+
+std::string_view UsbHidG20sProReport::buttonName(G20sProBtn button)
+{
+    return G20S_PRO_DECODER.buttonName(static_cast<uint8_t>(button));
+}
@@ -45,9 +45,11 @@
 #endif
 
 #include "UsbHidBaseReport.h"
+#include "UsbHidMotionFilter.h"
+#include "UsbHidRemoteProfile.h"
+#include <array>
 #include <cstdint>
-#include <unordered_map>
-#include <string>
+#include <string_view>
 
 #include <esp_log.h>
 
@@ -96,28 +98,57 @@ struct ButtonCode
 struct UsbHidG20sProEvent
 {
     UsbHidDeviceType deviceType_;
-    G20sProBtn button = G20sProBtn::Unknown;
+    G20sProBtn button = G20sProBtn::Unknown;             // Set for the G20s Pro profile
+    uint8_t buttonId  = UsbHidRemoteProfile::NO_BUTTON;  // Button number in the active remote profile
     bool pressed      = false;
     int8_t mouseX     = 0;
     int8_t mouseY     = 0;
 
     UsbHidG20sProEvent() : deviceType_(UsbHidDeviceType::G20sPro), pressed(false), mouseX(0), mouseY(0) {}
+
+    // Events are either one button edge (no motion) or motion only (no button)
+    bool isMotion() const { return buttonId == UsbHidRemoteProfile::NO_BUTTON && (mouseX != 0 || mouseY != 0); }
 };
 
+// Vendor air remote report. Reports are decoded by the active UsbHidRemoteProfile; the
+// G20s Pro profile is built in and active by default.
 class UsbHidG20sProReport : public UsbHidBaseReport<UsbHidG20sProEvent, UsbHidDeviceType::G20sPro>
 {
 public:
     UsbHidG20sProReport();
     void processReportData(const uint8_t* const data, int length) override;
-    static std::string buttonName(G20sProBtn button);
+    void releaseAll() override;  // Releases held buttons, one event each
+    static std::string_view buttonName(G20sProBtn button);
+
+    // The built-in G20s Pro profile, compiled at compile time
+    static const UsbHidRemoteDecoder& g20sProDecoder();
+
+    // Decode reports with another profile. Held buttons are released first, and the motion
+    // filter takes the profile's parameters. The decoder must outlive the report.
+    void useProfile(const UsbHidRemoteDecoder& decoder);
+    const UsbHidRemoteProfile& getProfile() const { return decoder_->getProfile(); }
+    std::string_view getButtonName(uint8_t buttonId) const { return decoder_->buttonName(buttonId); }
+
+    bool isButtonPressed(uint8_t buttonId) const;
+    bool isButtonPressed(G20sProBtn button) const { return isButtonPressed(static_cast<uint8_t>(button)); }
+
+    // Gyro motion is filtered with the profile's parameters (airMouse() for the G20s Pro) unless
+    // changed here, until the next profile change; pass UsbHidMotionFilter::Config::passthrough()
+    // for raw motion
+    void setMotionFilter(const UsbHidMotionFilter::Config& config)
+    {
+        motionFilter_.setConfig(config);
+        motionFilterSet_ = true;
+    }
+
+    // Take over a motion filter set on another report, e.g. by the application on the report
+    // whose callbacks it uses. Call after useProfile().
+    void useSettingsOf(const UsbHidG20sProReport& other);
 
 protected:
 private:
     UsbHidG20sProEvent createEvent() const override;
 
-    static const std::unordered_map<G20sProBtn, ButtonCode> btnCodeMap;
-    static const std::unordered_map<G20sProBtn, std::string> btnNames;
-
     struct ReportData
     {
         uint8_t reportId;
@@ -139,12 +170,22 @@ private:
     } __attribute__((packed));
 
     ReportData report_;
-    G20sProBtn lastPressedButton;
+    uint8_t lastPressedButton;  // Fields of the event being emitted
     bool buttonPressed;
     int8_t mouseX;
     int8_t mouseY;
 
-    void processMouseReport(const uint8_t* data, int length);
+    const UsbHidRemoteDecoder* decoder_;
+    uint32_t heldButtons_;                                                       // Bit per profile button
+    std::array<uint8_t, UsbHidRemoteDecoder::MAX_BUTTON_REPORTS> reportButton_;  // Button held in each button report
+    uint8_t mouseButtons_;                                                       // Buttons byte of the last mouse report
+    UsbHidMotionFilter motionFilter_;
+    bool motionFilterSet_;  // setMotionFilter() replaced the profile's parameters
+
+    void processMouseReport(uint8_t reportId, const uint8_t* data);
     void processButtonReport(const uint8_t* data, int length);
-    static G20sProBtn buttonFromCode(uint8_t reportId, uint16_t code);
+    void setButton(uint8_t button, bool pressed);
+    void emitMotion(int8_t x, int8_t y);
+    // Table lookup on the report ID and the first code byte, no search
+    uint8_t buttonFromCode(uint8_t reportId, uint16_t code) const;
 };
\ No newline at end of file
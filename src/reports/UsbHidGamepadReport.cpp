@@ -0,0 +1,374 @@
+/**
+ * @file UsbHidGamepadReport.cpp
+ * @brief Implements the UsbHidGamepadReport class for gamepads and joysticks.
+ */
+
+#include "UsbHidGamepadReport.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include <esp_log.h>
+
+namespace
+{
+constexpr const char* TAG = "GamepadReport";
+
+constexpr uint16_t axisBit(size_t axis) { return static_cast<uint16_t>(1u << axis); }
+
+uint32_t isqrt(uint32_t value)
+{
+    uint32_t root = 0;
+    uint32_t bit  = 1u << 30;
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+int16_t clampAxis(int64_t value)
+{
+    return static_cast<int16_t>(std::clamp<int64_t>(value, -UsbHidGamepadReport::AXIS_MAX, UsbHidGamepadReport::AXIS_MAX));
+}
+}  // namespace
+
+UsbHidGamepadReport::UsbHidGamepadReport()
+    : inputReportId_(0),
+      axisPresent_(0),
+      calibration_{},
+      threshold_{},
+      sticks_{{{UsbHidGamepadAxis::X, UsbHidGamepadAxis::Y, 0}, {UsbHidGamepadAxis::Rx, UsbHidGamepadAxis::Ry, 0}}},
+      sticksSet_(false),
+      hatMin_(0),
+      hatPositions_(0)
+{
+    reset();
+}
+
+void UsbHidGamepadReport::reset()
+{
+    normalised_.fill(0);
+    axes_.fill(0);
+    reported_.fill(0);
+    hat_         = UsbHidGamepadHat::Centered;
+    buttons_     = 0;
+    changedAxes_ = 0;
+    hatChanged_  = false;
+    pressed_     = 0;
+    released_    = 0;
+    rawReport_.clear();
+}
+
+bool UsbHidGamepadReport::useDescriptor(const UsbHidReportDescriptor& descriptor, uint16_t vid, uint16_t pid)
+{
+    reset();
+    axisPresent_   = 0;
+    hatPositions_  = 0;
+    inputReportId_ = 0;
+    roles_.clear();
+
+    if (!plan_.build(descriptor))
+    {
+        return false;
+    }
+    roles_.assign(plan_.entryCount(), Role{Role::None, 0});
+    raw_.assign(plan_.maxValues(), 0);
+
+    // Only elements of joystick and gamepad applications get roles, so the X/Y of a mouse or
+    // the buttons of another collection on a composite device are left alone. A descriptor
+    // without such an application, e.g. a vendor-defined one, is taken as a whole.
+    uint32_t gamepadApplications = 0;
+    const auto& applications     = descriptor.applications();
+    for (size_t a = 0; a < applications.size(); ++a)
+    {
+        if (applications[a].usagePage == USAGE_PAGE_GENERIC_DESKTOP &&
+            (applications[a].usage == USAGE_JOYSTICK || applications[a].usage == USAGE_GAMEPAD ||
+             applications[a].usage == USAGE_MULTI_AXIS))
+        {
+            gamepadApplications |= 1u << a;
+        }
+    }
+
+    bool found = false;
+    for (size_t id = 0; id < 256; ++id)
+    {
+        size_t count                             = 0;
+        const UsbHidExtractionPlan::Entry* entry = plan_.entries(static_cast<uint8_t>(id), count);
+        const size_t first                       = plan_.firstEntry(static_cast<uint8_t>(id));
+
+        for (size_t i = 0; i < count; ++i, ++entry)
+        {
+            Role& role                = roles_[first + i];
+            const bool array          = (entry->flags & UsbHidExtractionPlan::ENTRY_ARRAY) != 0;
+            const uint8_t application = plan_.application(first + i);
+            if (gamepadApplications != 0 &&
+                (application == UsbHidReportField::NO_APPLICATION || !(gamepadApplications & (1u << application))))
+            {
+                continue;
+            }
+
+            if (entry->usagePage == USAGE_PAGE_GENERIC_DESKTOP && !array && entry->usage >= USAGE_X &&
+                entry->usage < USAGE_X + AXIS_COUNT)
+            {
+                const size_t axis  = entry->usage - USAGE_X;
+                role               = {Role::Axis, static_cast<uint8_t>(axis)};
+                calibration_[axis] = {entry->logicalMin, (entry->logicalMin + entry->logicalMax + 1) / 2, entry->logicalMax};
+                axisPresent_ |= axisBit(axis);
+            }
+            else if (entry->usagePage == USAGE_PAGE_GENERIC_DESKTOP && entry->usage == USAGE_HAT_SWITCH)
+            {
+                role          = {Role::Hat, 0};
+                hatMin_       = entry->logicalMin;
+                hatPositions_ = entry->logicalMax - entry->logicalMin + 1;
+            }
+            else if (entry->usagePage == USAGE_PAGE_BUTTON && !array && entry->usage >= 1 && entry->usage <= MAX_BUTTONS)
+            {
+                role = {Role::Button, static_cast<uint8_t>(entry->usage - 1)};
+            }
+
+            if (role.kind != Role::None && !found)
+            {
+                found          = true;
+                inputReportId_ = plan_.usesReportIds() ? static_cast<uint8_t>(id) : 0;
+            }
+        }
+    }
+
+    if (!found)
+    {
+        ESP_LOGW(TAG, "No gamepad axes, hat or buttons in report descriptor");
+        plan_.clear();
+        roles_.clear();
+        return false;
+    }
+
+    for (const auto& device : deviceCalibrations_)
+    {
+        if (device.vid == vid && device.pid == pid)
+        {
+            calibration_[static_cast<size_t>(device.axis)] = device.calibration;
+        }
+    }
+
+    if (!sticksSet_ && !(hasAxis(UsbHidGamepadAxis::Rx) && hasAxis(UsbHidGamepadAxis::Ry)))
+    {
+        sticks_[1].x = UsbHidGamepadAxis::Z;
+        sticks_[1].y = UsbHidGamepadAxis::Rz;
+    }
+    else if (!sticksSet_)
+    {
+        sticks_[1].x = UsbHidGamepadAxis::Rx;
+        sticks_[1].y = UsbHidGamepadAxis::Ry;
+    }
+    return true;
+}
+
+void UsbHidGamepadReport::useSettingsOf(const UsbHidGamepadReport& other)
+{
+    deviceCalibrations_ = other.deviceCalibrations_;
+    threshold_          = other.threshold_;
+    sticks_             = other.sticks_;
+    sticksSet_          = other.sticksSet_;
+}
+
+void UsbHidGamepadReport::addCalibration(uint16_t vid, uint16_t pid, UsbHidGamepadAxis axis, const Calibration& calibration)
+{
+    deviceCalibrations_.push_back({vid, pid, axis, calibration});
+}
+
+void UsbHidGamepadReport::setStick(size_t stick, UsbHidGamepadAxis x, UsbHidGamepadAxis y, uint16_t deadZone)
+{
+    if (stick < STICK_COUNT && x < UsbHidGamepadAxis::Count && y < UsbHidGamepadAxis::Count)
+    {
+        sticks_[stick] = {x, y, deadZone};
+        sticksSet_     = true;
+    }
+}
+
+void UsbHidGamepadReport::setDeadZone(size_t stick, uint16_t deadZone)
+{
+    if (stick < STICK_COUNT)
+    {
+        sticks_[stick].deadZone = deadZone;
+    }
+}
+
+void UsbHidGamepadReport::setAxisThreshold(UsbHidGamepadAxis axis, uint16_t threshold)
+{
+    if (axis < UsbHidGamepadAxis::Count)
+    {
+        threshold_[static_cast<size_t>(axis)] = threshold;
+    }
+}
+
+void UsbHidGamepadReport::processReportData(const uint8_t* const data, int length)
+{
+    rawReport_.assign(data, data + length);
+    if (plan_.empty() || length <= 0)
+    {
+        return;
+    }
+
+    const size_t count = plan_.extract(data, static_cast<size_t>(length), raw_.data(), raw_.size());
+    const size_t first = plan_.firstEntry(plan_.usesReportIds() ? data[0] : 0);
+
+    UsbHidGamepadHat hat = hat_;
+    uint32_t buttons     = buttons_;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Role role     = roles_[first + i];
+        const int32_t value = raw_[i];
+        switch (role.kind)
+        {
+        case Role::Axis:
+            normalised_[role.index] = normalise(value, calibration_[role.index]);
+            break;
+        case Role::Hat:
+        {
+            // Out of range is the null state; 4-way hats are spread over the 8 directions
+            const int32_t position = value - hatMin_;
+            hat = position >= 0 && position < hatPositions_ ? static_cast<UsbHidGamepadHat>(position * 8 / hatPositions_)
+                                                            : UsbHidGamepadHat::Centered;
+            break;
+        }
+        case Role::Button:
+            buttons = value != 0 ? buttons | (1u << role.index) : buttons & ~(1u << role.index);
+            break;
+        default:
+            break;
+        }
+    }
+
+    axes_ = normalised_;
+    for (const auto& stick : sticks_)
+    {
+        applyDeadZone(stick);
+    }
+
+    pressed_    = buttons & ~buttons_;
+    released_   = buttons_ & ~buttons;
+    hatChanged_ = hat != hat_;
+    buttons_    = buttons;
+    hat_        = hat;
+
+    if (updateReported() || hatChanged_ || pressed_ != 0 || released_ != 0)
+    {
+        triggerEvent(createEvent());
+    }
+}
+
+void UsbHidGamepadReport::releaseAll()
+{
+    changedAxes_ = 0;
+    for (size_t axis = 0; axis < AXIS_COUNT; ++axis)
+    {
+        if (reported_[axis] != 0)
+        {
+            changedAxes_ |= axisBit(axis);
+        }
+    }
+    reported_.fill(0);
+    pressed_    = 0;
+    released_   = buttons_;
+    hatChanged_ = hat_ != UsbHidGamepadHat::Centered;
+    buttons_    = 0;
+    hat_        = UsbHidGamepadHat::Centered;
+
+    if (changedAxes_ != 0 || released_ != 0 || hatChanged_)
+    {
+        triggerEvent(createEvent());
+    }
+    reset();
+}
+
+bool UsbHidGamepadReport::isButtonPressed(int button) const
+{
+    return button >= 0 && button < static_cast<int>(MAX_BUTTONS) && (buttons_ & (1u << button)) != 0;
+}
+
+UsbHidGamepadEvent UsbHidGamepadReport::createEvent() const
+{
+    UsbHidGamepadEvent event;
+    event.axes        = reported_;
+    event.changedAxes = changedAxes_;
+    event.hat         = hat_;
+    event.hatChanged  = hatChanged_;
+    event.buttons     = buttons_;
+    event.pressed     = pressed_;
+    event.released    = released_;
+    return event;
+}
+
+int16_t UsbHidGamepadReport::normalise(int32_t raw, const Calibration& calibration)
+{
+    // Each side of the centre is scaled on its own, so the centre maps to exactly 0
+    if (raw >= calibration.center)
+    {
+        const int64_t span = static_cast<int64_t>(calibration.max) - calibration.center;
+        return span > 0 ? clampAxis((static_cast<int64_t>(raw) - calibration.center) * AXIS_MAX / span) : 0;
+    }
+    const int64_t span = static_cast<int64_t>(calibration.center) - calibration.min;
+    return span > 0 ? clampAxis((static_cast<int64_t>(raw) - calibration.center) * AXIS_MAX / span) : 0;
+}
+
+void UsbHidGamepadReport::applyDeadZone(const Stick& stick)
+{
+    if (stick.deadZone == 0)
+    {
+        return;
+    }
+
+    int16_t& x = axes_[static_cast<size_t>(stick.x)];
+    int16_t& y = axes_[static_cast<size_t>(stick.y)];
+
+    const uint32_t magnitude = isqrt(static_cast<uint32_t>(x * x) + static_cast<uint32_t>(y * y));
+    if (magnitude <= stick.deadZone || stick.deadZone >= AXIS_MAX)
+    {
+        x = 0;
+        y = 0;
+        return;
+    }
+
+    // Rescale the magnitude from deadZone..AXIS_MAX to 0..AXIS_MAX, keeping the direction
+    const int64_t scaled = std::min<int64_t>((static_cast<int64_t>(magnitude) - stick.deadZone) * AXIS_MAX /
+                                                 (AXIS_MAX - stick.deadZone),
+                                             AXIS_MAX);
+    x = clampAxis(x * scaled / magnitude);
+    y = clampAxis(y * scaled / magnitude);
+}
+
+bool UsbHidGamepadReport::updateReported()
+{
+    changedAxes_ = 0;
+    for (size_t axis = 0; axis < AXIS_COUNT; ++axis)
+    {
+        const int16_t value = axes_[axis];
+        if (!(axisPresent_ & axisBit(axis)) || value == reported_[axis])
+        {
+            continue;
+        }
+
+        // Centre and the ends are always reported, so the last event of a movement is exact
+        const int32_t moved = std::abs(static_cast<int32_t>(value) - reported_[axis]);
+        if (moved >= threshold_[axis] || value == 0 || std::abs(value) == AXIS_MAX)
+        {
+            reported_[axis] = value;
+            changedAxes_ |= axisBit(axis);
+        }
+    }
+    return changedAxes_ != 0;
+}
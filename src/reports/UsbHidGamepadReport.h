@@ -0,0 +1,253 @@
+/**
+ * @file UsbHidGamepadReport.h
+ * @brief Defines the UsbHidGamepadReport class for gamepads and joysticks.
+ */
+
+#pragma once
+
+#include "UsbHidBaseReport.h"
+#include "UsbHidExtractionPlan.h"
+#include "UsbHidReportDescriptor.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @enum UsbHidGamepadAxis
+ * @brief Gamepad axes, the Generic Desktop usages X (0x30) to Wheel (0x38) in order.
+ */
+enum class UsbHidGamepadAxis : uint8_t
+{
+    X,
+    Y,
+    Z,
+    Rx,
+    Ry,
+    Rz,
+    Slider,
+    Dial,
+    Wheel,
+    Count
+};
+
+/**
+ * @enum UsbHidGamepadHat
+ * @brief Hat switch direction, clockwise from up.
+ */
+enum class UsbHidGamepadHat : uint8_t
+{
+    Up,
+    UpRight,
+    Right,
+    DownRight,
+    Down,
+    DownLeft,
+    Left,
+    UpLeft,
+    Centered
+};
+
+/**
+ * @struct UsbHidGamepadEvent
+ * @brief Gamepad state after a report, with what changed.
+ */
+struct UsbHidGamepadEvent
+{
+    static constexpr size_t AXIS_COUNT = static_cast<size_t>(UsbHidGamepadAxis::Count);
+
+    UsbHidDeviceType deviceType_;          ///< Type of the USB HID device
+    std::array<int16_t, AXIS_COUNT> axes;  ///< Normalised to -32767..32767, 0 at the calibrated centre
+    uint16_t changedAxes;                  ///< Bit n set if axis n changed in this event
+    UsbHidGamepadHat hat;                  ///< Hat switch direction
+    bool hatChanged;                       ///< The hat moved in this event
+    uint32_t buttons;                      ///< Button n (1-based) in bit n-1, up to 32 buttons
+    uint32_t pressed;                      ///< Buttons that went down in this event
+    uint32_t released;                     ///< Buttons that went up in this event
+
+    UsbHidGamepadEvent()
+        : deviceType_(UsbHidDeviceType::Gamepad), axes{}, changedAxes(0), hat(UsbHidGamepadHat::Centered),
+          hatChanged(false), buttons(0), pressed(0), released(0)
+    {
+    }
+
+    int16_t axis(UsbHidGamepadAxis a) const { return axes[static_cast<size_t>(a)]; }
+    bool axisChanged(UsbHidGamepadAxis a) const { return (changedAxes & (1u << static_cast<uint8_t>(a))) != 0; }
+
+    // 0-based buttons
+    bool wasPressed(int button) const { return button >= 0 && button < 32 && (pressed & (1u << button)) != 0; }
+    bool wasReleased(int button) const { return button >= 0 && button < 32 && (released & (1u << button)) != 0; }
+};
+
+/**
+ * @class UsbHidGamepadReport
+ * @brief Decodes gamepad and joystick reports through the descriptor extraction plan.
+ *
+ * Axes are normalised with a per-axis calibration (minimum, centre, maximum), which
+ * defaults to the descriptor's logical range and can be overridden per device (VID/PID).
+ * Up to two sticks get a radial dead zone: inside it both axes read 0, outside it the
+ * magnitude is rescaled so the output still ramps smoothly from 0 to full deflection.
+ *
+ * Events are emitted only when something changes. An axis counts as changed once it has
+ * moved by its threshold since it was last reported, or when it reaches centre or an end,
+ * so small noise on a 1 kHz pad does not produce a stream of events.
+ *
+ * Configure with the setters before the device is connected.
+ */
+class UsbHidGamepadReport : public UsbHidBaseReport<UsbHidGamepadEvent, UsbHidDeviceType::Gamepad>
+{
+public:
+    static constexpr size_t AXIS_COUNT  = UsbHidGamepadEvent::AXIS_COUNT;
+    static constexpr size_t MAX_BUTTONS = 32;
+    static constexpr size_t STICK_COUNT = 2;
+    static constexpr int32_t AXIS_MAX   = 32767;
+
+    /**
+     * @struct Calibration
+     * @brief Raw values of one axis at its ends and at rest.
+     *
+     * For one-sided axes such as triggers, set center to min: the axis then reads 0 at
+     * rest and 32767 fully pressed.
+     */
+    struct Calibration
+    {
+        int32_t min;
+        int32_t center;
+        int32_t max;
+    };
+
+    UsbHidGamepadReport();
+
+    void processReportData(const uint8_t* const data, int length) override;
+    void releaseAll() override;  // Releases held buttons and recentres axes and hat with a final event
+
+    /**
+     * @brief Decode reports using a gamepad's report descriptor.
+     *
+     * Only joystick, gamepad and multi-axis application collections are decoded when the
+     * descriptor has any, so other collections of a composite device are ignored.
+     *
+     * @param descriptor Parsed report descriptor.
+     * @param vid Vendor ID, selects calibrations added with addCalibration().
+     * @param pid Product ID.
+     * @return true if the descriptor has gamepad axes, a hat or buttons.
+     */
+    bool useDescriptor(const UsbHidReportDescriptor& descriptor, uint16_t vid = 0, uint16_t pid = 0);
+
+    /**
+     * @brief Take over the calibrations, sticks and thresholds configured on another report.
+     *
+     * Call before useDescriptor(), e.g. to decode one more gamepad with the settings of the first.
+     */
+    void useSettingsOf(const UsbHidGamepadReport& other);
+
+    /**
+     * @brief Calibrate one axis of a device, replacing the descriptor's logical range.
+     */
+    void addCalibration(uint16_t vid, uint16_t pid, UsbHidGamepadAxis axis, const Calibration& calibration);
+
+    /**
+     * @brief Set the axes of a stick and its radial dead zone.
+     *
+     * By default stick 0 is X/Y and stick 1 is Rx/Ry, or Z/Rz if the pad has no Rx/Ry.
+     *
+     * @param stick 0 or 1.
+     * @param deadZone Radius in normalised units (0 - 32767), 0 to disable.
+     */
+    void setStick(size_t stick, UsbHidGamepadAxis x, UsbHidGamepadAxis y, uint16_t deadZone);
+    void setDeadZone(size_t stick, uint16_t deadZone);
+
+    /**
+     * @brief Set how far an axis must move, in normalised units, before it is reported again.
+     */
+    void setAxisThreshold(UsbHidGamepadAxis axis, uint16_t threshold);
+
+    bool hasAxis(UsbHidGamepadAxis axis) const { return (axisPresent_ & (1u << static_cast<uint8_t>(axis))) != 0; }
+    int16_t getAxis(UsbHidGamepadAxis axis) const { return reported_[static_cast<size_t>(axis)]; }
+    UsbHidGamepadHat getHat() const { return hat_; }
+    uint32_t getButtons() const { return buttons_; }
+    bool isButtonPressed(int button) const;  // 0-based
+    uint8_t getInputReportId() const { return inputReportId_; }  // 0 if reports carry no ID
+
+protected:
+    UsbHidGamepadEvent createEvent() const override;
+
+private:
+    static constexpr uint16_t USAGE_PAGE_GENERIC_DESKTOP = 0x01;
+    static constexpr uint16_t USAGE_PAGE_BUTTON          = 0x09;
+    static constexpr uint16_t USAGE_JOYSTICK             = 0x04;
+    static constexpr uint16_t USAGE_GAMEPAD              = 0x05;
+    static constexpr uint16_t USAGE_MULTI_AXIS           = 0x08;
+    static constexpr uint16_t USAGE_X                    = 0x30;
+    static constexpr uint16_t USAGE_HAT_SWITCH           = 0x39;
+
+    /**
+     * @struct Role
+     * @brief What one plan entry feeds.
+     */
+    struct Role
+    {
+        enum Kind : uint8_t
+        {
+            None,
+            Axis,
+            Hat,
+            Button
+        } kind;
+        uint8_t index;  ///< Axis or 0-based button
+    };
+
+    /**
+     * @struct Stick
+     * @brief Two axes sharing a radial dead zone.
+     */
+    struct Stick
+    {
+        UsbHidGamepadAxis x;
+        UsbHidGamepadAxis y;
+        uint16_t deadZone;
+    };
+
+    /**
+     * @struct DeviceCalibration
+     * @brief A calibration added with addCalibration().
+     */
+    struct DeviceCalibration
+    {
+        uint16_t vid;
+        uint16_t pid;
+        UsbHidGamepadAxis axis;
+        Calibration calibration;
+    };
+
+    UsbHidExtractionPlan plan_;
+    std::vector<Role> roles_;   ///< One per plan entry
+    std::vector<int32_t> raw_;  ///< extract() output, sized for the largest report
+    uint8_t inputReportId_;
+
+    uint16_t axisPresent_;
+    std::array<Calibration, AXIS_COUNT> calibration_;
+    std::array<uint16_t, AXIS_COUNT> threshold_;
+    std::array<Stick, STICK_COUNT> sticks_;
+    bool sticksSet_;  ///< setStick() was called, keep its axes
+    std::vector<DeviceCalibration> deviceCalibrations_;
+    int32_t hatMin_;
+    int32_t hatPositions_;
+
+    std::array<int16_t, AXIS_COUNT> normalised_;  ///< Current values, before dead zones
+    std::array<int16_t, AXIS_COUNT> axes_;        ///< Current values, after dead zones
+    std::array<int16_t, AXIS_COUNT> reported_;    ///< Values last reported
+    UsbHidGamepadHat hat_;
+    uint32_t buttons_;
+
+    // Set by the last report
+    uint16_t changedAxes_;
+    bool hatChanged_;
+    uint32_t pressed_;
+    uint32_t released_;
+
+    static int16_t normalise(int32_t raw, const Calibration& calibration);
+    void applyDeadZone(const Stick& stick);
+    bool updateReported();
+    void reset();
+};
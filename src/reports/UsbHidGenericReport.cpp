@@ -4,9 +4,24 @@
  */
 
 #include "UsbHidGenericReport.h"
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
-UsbHidGenericReport::UsbHidGenericReport()
+namespace
+{
+/// Usage an array element selects, 0 for none
+uint16_t arrayUsage(const UsbHidExtractionPlan::Entry& entry, int32_t value)
+{
+    if (value < entry.logicalMin || value > entry.logicalMax)
+    {
+        return 0;
+    }
+    return static_cast<uint16_t>(entry.usage + (value - entry.logicalMin));
+}
+}  // namespace
+
+UsbHidGenericReport::UsbHidGenericReport() : subscriptionOwner_(this), valuesDecoded_(false)
 {
     // Initialize the report vector
     rawReport_.clear();
@@ -14,8 +29,148 @@ UsbHidGenericReport::UsbHidGenericReport()
 
 void UsbHidGenericReport::processReportData(const uint8_t* const data, int length)
 {
+    valuesDecoded_ = false;
+    changes_.clear();
+    changeOrigin_.clear();
+
+    if (plan_.empty() || length <= 0)
+    {
+        // Without a descriptor only whole reports can be compared
+        const bool repeated = rawReport_.size() == static_cast<size_t>(length) &&
+                              (length <= 0 || std::memcmp(rawReport_.data(), data, length) == 0);
+        rawReport_.assign(data, data + length);
+        if (!repeated)
+        {
+            triggerEvent(createEvent());
+        }
+        return;
+    }
+
     // Copy the incoming data to our internal report vector
     rawReport_.assign(data, data + length);
+
+    const uint8_t reportId                   = plan_.usesReportIds() ? data[0] : 0;
+    const size_t count                       = plan_.extract(data, static_cast<size_t>(length), raw_.data(), raw_.size());
+    size_t entryCount                        = 0;
+    const UsbHidExtractionPlan::Entry* entry = plan_.entries(reportId, entryCount);
+    int32_t* previous                        = previous_.data() + plan_.firstEntry(reportId);
+
+    // Most reports repeat the previous one; a single compare skips them
+    if (count == 0 || std::equal(raw_.begin(), raw_.begin() + count, previous))
+    {
+        return;
+    }
+
+    size_t arrayChanges = 0;
+    for (size_t i = 0; i < count; ++i, ++entry)
+    {
+        const int32_t value = raw_[i];
+        const int32_t old   = previous[i];
+        if (value == old)
+        {
+            continue;
+        }
+        previous[i] = value;
+
+        if (entry->flags & UsbHidExtractionPlan::ENTRY_ARRAY)
+        {
+            const uint16_t released = arrayUsage(*entry, old);
+            const uint16_t selected = arrayUsage(*entry, value);
+            if (released != 0)
+            {
+                addChange(reportId, entry->usagePage, released, 0, 1, true);
+                ++arrayChanges;
+            }
+            if (selected != 0)
+            {
+                addChange(reportId, entry->usagePage, selected, 1, 0, true);
+                ++arrayChanges;
+            }
+        }
+        else
+        {
+            addChange(reportId, entry->usagePage, entry->usage, value, old, false);
+        }
+    }
+
+    if (arrayChanges > 1)
+    {
+        dropMovedSelections();
+    }
+    if (changes_.empty())
+    {
+        return;
+    }
+
+    notifySubscribers();
+    triggerEvent(createEvent());
+}
+
+void UsbHidGenericReport::addChange(uint8_t reportId, uint16_t usagePage, uint16_t usage, int32_t value,
+                                    int32_t previous, bool array)
+{
+    changes_.push_back({reportId, usagePage, usage, value, previous});
+    changeOrigin_.push_back(array ? ORIGIN_ARRAY : ORIGIN_VARIABLE);
+}
+
+void UsbHidGenericReport::dropMovedSelections()
+{
+    // A usage released by one array element and selected by another is still selected
+    for (size_t i = 0; i < changes_.size(); ++i)
+    {
+        for (size_t j = i + 1; j < changes_.size() && changeOrigin_[i] == ORIGIN_ARRAY; ++j)
+        {
+            if (changeOrigin_[j] == ORIGIN_ARRAY && changes_[j].usagePage == changes_[i].usagePage &&
+                changes_[j].usage == changes_[i].usage && changes_[j].value != changes_[i].value)
+            {
+                changeOrigin_[i] = ORIGIN_DROPPED;
+                changeOrigin_[j] = ORIGIN_DROPPED;
+            }
+        }
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < changes_.size(); ++i)
+    {
+        if (changeOrigin_[i] != ORIGIN_DROPPED)
+        {
+            changes_[kept]      = changes_[i];
+            changeOrigin_[kept] = changeOrigin_[i];
+            ++kept;
+        }
+    }
+    changes_.resize(kept);
+    changeOrigin_.resize(kept);
+}
+
+void UsbHidGenericReport::subscribe(uint16_t usagePage, uint16_t usage, FieldCallback callback)
+{
+    const uint32_t key  = static_cast<uint32_t>(usagePage) << 16 | usage;
+    const auto position = std::upper_bound(subscriptions_.begin(), subscriptions_.end(), key,
+                                           [](uint32_t value, const Subscription& subscription)
+                                           { return value < subscription.key; });
+    subscriptions_.insert(position, {key, std::move(callback)});
+}
+
+void UsbHidGenericReport::notifySubscribers() const
+{
+    const std::vector<Subscription>& subscriptions = subscriptionOwner_->subscriptions_;
+    if (subscriptions.empty())
+    {
+        return;
+    }
+
+    for (const auto& change : changes_)
+    {
+        const uint32_t key = static_cast<uint32_t>(change.usagePage) << 16 | change.usage;
+        auto subscription  = std::lower_bound(subscriptions.begin(), subscriptions.end(), key,
+                                              [](const Subscription& subscription, uint32_t value)
+                                              { return subscription.key < value; });
+        for (; subscription != subscriptions.end() && subscription->key == key; ++subscription)
+        {
+            subscription->callback(change);
+        }
+    }
 }
 
 size_t UsbHidGenericReport::getReportSize() const
@@ -42,10 +197,58 @@ std::vector<uint8_t> UsbHidGenericReport::getReportData() const
     return rawReport_;
 }
 
+bool UsbHidGenericReport::useDescriptor(const UsbHidReportDescriptor& descriptor)
+{
+    if (!plan_.build(descriptor))
+    {
+        clearDescriptor();
+        return false;
+    }
+    raw_.assign(plan_.maxValues(), 0);
+    previous_.assign(plan_.entryCount(), 0);
+    values_.clear();
+    values_.reserve(plan_.maxValues());
+    valuesDecoded_ = false;
+    rawReport_.clear();
+    return true;
+}
+
+void UsbHidGenericReport::clearDescriptor()
+{
+    plan_.clear();
+    raw_.clear();
+    previous_.clear();
+    values_.clear();
+    valuesDecoded_ = false;
+    rawReport_.clear();
+}
+
+void UsbHidGenericReport::releaseAll()
+{
+    std::fill(previous_.begin(), previous_.end(), 0);
+    changes_.clear();
+    changeOrigin_.clear();
+    valuesDecoded_ = false;
+    rawReport_.clear();
+}
+
+const std::vector<UsbHidFieldValue>& UsbHidGenericReport::getValues() const
+{
+    if (!valuesDecoded_)
+    {
+        // Sized for the largest report by useDescriptor(), so this does not allocate
+        values_.resize(plan_.maxValues());
+        values_.resize(plan_.decode(rawReport_.data(), rawReport_.size(), values_.data(), values_.size()));
+        valuesDecoded_ = true;
+    }
+    return values_;
+}
+
 UsbHidGenericEvent UsbHidGenericReport::createEvent() const
 {
-    // Create and return a new event based on the current report data
+    // Views of the current report, nothing is copied per event
     UsbHidGenericEvent event;
-    event.data = rawReport_;
+    event.data    = rawReport_;
+    event.changes = changes_;
     return event;
-}
\ No newline at end of file
+}
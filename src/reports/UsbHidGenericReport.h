@@ -6,17 +6,37 @@
 #pragma once
 
 #include "UsbHidBaseReport.h"
+#include "UsbHidExtractionPlan.h"
 #include <vector>
 #include <cstdint>
+#include <functional>
+#include <span>
+
+/**
+ * @struct UsbHidFieldChange
+ * @brief A report element whose value differs from the previous report with its report ID.
+ */
+struct UsbHidFieldChange
+{
+    uint8_t reportId;  ///< Report ID, 0 if the descriptor does not use report IDs
+    uint16_t usagePage;
+    uint16_t usage;
+    int32_t value;     ///< Logical value; for array usages 1 when selected, 0 when no longer
+    int32_t previous;  ///< Value in the previous report, 0 before the first one
+};
 
 /**
  * @struct UsbHidGenericEvent
  * @brief Represents a generic HID event with raw data.
+ *
+ * The event views the buffers of the report that decoded it, so both spans are only valid
+ * inside the callback. Copy what has to be kept, e.g. with getReportData().
  */
 struct UsbHidGenericEvent
 {
-    UsbHidDeviceType deviceType_;  ///< Type of the USB HID device
-    std::vector<uint8_t> data;     ///< Raw data from the HID report
+    UsbHidDeviceType deviceType_;                ///< Type of the USB HID device
+    std::span<const uint8_t> data;               ///< Raw data from the HID report
+    std::span<const UsbHidFieldChange> changes;  ///< Changed elements, empty without a report descriptor
 
     /**
      * @brief Construct a new UsbHidGenericEvent object.
@@ -30,10 +50,21 @@ struct UsbHidGenericEvent
  *
  * This class extends UsbHidBaseReport to provide functionality for generic HID devices.
  * It processes raw HID reports and provides methods to access the report data.
+ *
+ * Events are only fired when a report differs from the previous one. With a report
+ * descriptor each element is compared with its value in the previous report of the same
+ * report ID, and events carry just the elements that changed; subscribers can also ask
+ * for the changes of single usages. Without a descriptor whole reports are compared.
  */
 class UsbHidGenericReport : public UsbHidBaseReport<UsbHidGenericEvent, UsbHidDeviceType::Generic>
 {
 public:
+    /**
+     * @typedef FieldCallback
+     * @brief Function type for usage subscriptions.
+     */
+    using FieldCallback = std::function<void(const UsbHidFieldChange&)>;
+
     /**
      * @brief Construct a new UsbHidGenericReport object.
      */
@@ -47,6 +78,11 @@ public:
      */
     void processReportData(const uint8_t* const data, int length) override;
 
+    /**
+     * @brief Forget the previous values, so the next report is compared with an idle device.
+     */
+    void releaseAll() override;
+
     /**
      * @brief Get the size of the current report.
      *
@@ -70,6 +106,50 @@ public:
      */
     std::vector<uint8_t> getReportData() const;
 
+    /**
+     * @brief Decode reports using the device's report descriptor.
+     *
+     * @param descriptor Parsed report descriptor of the device.
+     * @return true if the descriptor has input fields to decode.
+     */
+    bool useDescriptor(const UsbHidReportDescriptor& descriptor);
+
+    /**
+     * @brief Stop decoding reports; events carry raw data only.
+     */
+    void clearDescriptor();
+
+    /**
+     * @brief Get the extraction plan reports are decoded with.
+     */
+    const UsbHidExtractionPlan& getPlan() const { return plan_; }
+
+    /**
+     * @brief Get the values decoded from the current report.
+     *
+     * Decoded on the first call after each report, events only carry the changes.
+     */
+    const std::vector<UsbHidFieldValue>& getValues() const;
+
+    /**
+     * @brief Call a function whenever one usage changes value.
+     *
+     * Called before the report's event, once per change. Subscriptions last across
+     * descriptors, so they can be made before the device connects.
+     *
+     * @param usagePage Usage page, e.g. 0x0C Consumer.
+     * @param usage Usage ID on that page.
+     * @param callback Function receiving the change.
+     */
+    void subscribe(uint16_t usagePage, uint16_t usage, FieldCallback callback);
+
+    /**
+     * @brief Notify the subscriptions of another report instead of this one's.
+     *
+     * @param owner The report holding the subscriptions. Must outlive this report.
+     */
+    void useSubscriptionsOf(const UsbHidGenericReport& owner) { subscriptionOwner_ = &owner; }
+
 protected:
     /**
      * @brief Create a UsbHidGenericEvent based on the current report state.
@@ -79,4 +159,33 @@ protected:
     UsbHidGenericEvent createEvent() const override;
 
 private:
+    /// Where a change came from, array changes may cancel out
+    static constexpr uint8_t ORIGIN_VARIABLE = 0;
+    static constexpr uint8_t ORIGIN_ARRAY    = 1;
+    static constexpr uint8_t ORIGIN_DROPPED  = 2;
+
+    /**
+     * @struct Subscription
+     * @brief A usage and the function called when it changes.
+     */
+    struct Subscription
+    {
+        uint32_t key;  ///< usagePage << 16 | usage
+        FieldCallback callback;
+    };
+
+    UsbHidExtractionPlan plan_;                     ///< Compiled from the report descriptor
+    std::vector<int32_t> raw_;                      ///< extract() output, sized for the largest report
+    std::vector<int32_t> previous_;                 ///< Raw value of every entry in its last report
+    std::vector<UsbHidFieldChange> changes_;        ///< Changes of the current report
+    std::vector<uint8_t> changeOrigin_;             ///< ORIGIN_ value of each change
+    std::vector<Subscription> subscriptions_;       ///< Sorted by key
+    const UsbHidGenericReport* subscriptionOwner_;  ///< Report whose subscriptions are notified
+    mutable std::vector<UsbHidFieldValue> values_;  ///< Values of the current report, decoded on demand
+    mutable bool valuesDecoded_;                    ///< values_ matches rawReport_
+
+    void addChange(uint8_t reportId, uint16_t usagePage, uint16_t usage, int32_t value, int32_t previous,
+                   bool array);
+    void dropMovedSelections();
+    void notifySubscribers() const;
 };
\ No newline at end of file
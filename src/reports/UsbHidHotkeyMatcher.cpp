@@ -0,0 +1,379 @@
+/**
+ * @file UsbHidHotkeyMatcher.cpp
+ * @brief Implements the UsbHidHotkeyMatcher class, which matches key chords and sequences.
+ */
+
+#include "UsbHidHotkeyMatcher.h"
+
+#include <algorithm>
+#include <esp_log.h>
+
+namespace
+{
+constexpr const char* TAG = "HotkeyMatcher";
+
+// Modifier usages 0xE0 - 0xE7 are matched through the modifier mask, not as keys
+constexpr uint16_t USAGE_MODIFIER_FIRST = 0xE0;
+constexpr uint16_t USAGE_MODIFIER_LAST  = 0xE7;
+
+constexpr bool isModifierCode(uint16_t code)
+{
+    return code >= USAGE_MODIFIER_FIRST && code <= USAGE_MODIFIER_LAST;
+}
+
+/// Wrap-safe "a is at or after b" for millisecond timestamps
+constexpr bool reached(uint32_t a, uint32_t b)
+{
+    return static_cast<int32_t>(a - b) >= 0;
+}
+}  // namespace
+
+UsbHidHotkeyMatcher::Chord::Chord(uint8_t modifiers, std::initializer_list<Code> codes)
+    : modifiers(modifiers), keys{}, keyCount(0)
+{
+    for (Code code : codes)
+    {
+        if (keyCount == MAX_CHORD_KEYS)
+        {
+            // Too many keys, leave the chord invalid
+            keyCount = MAX_CHORD_KEYS + 1;
+            break;
+        }
+        keys[keyCount++] = code;
+    }
+}
+
+UsbHidHotkeyMatcher::UsbHidHotkeyMatcher(UsbHidTimerWheel& wheel)
+    : wheel_(wheel),
+      timer_([this](Millis now) { onTimeout(now); }),
+      nextId_(0),
+      triggerStart_(CODE_COUNT + 1, 0),
+      modifiers_(0),
+      active_{},
+      activeCount_(0)
+{
+}
+
+UsbHidHotkeyMatcher::Id UsbHidHotkeyMatcher::addChord(const Chord& chord, HotkeyCallback callback)
+{
+    return add(&chord, 1, 0, std::move(callback));
+}
+
+UsbHidHotkeyMatcher::Id UsbHidHotkeyMatcher::addSequence(std::initializer_list<Chord> steps, Millis timeoutMs, HotkeyCallback callback)
+{
+    return add(steps.begin(), steps.size(), timeoutMs, std::move(callback));
+}
+
+UsbHidHotkeyMatcher::Id UsbHidHotkeyMatcher::add(const Chord* steps, size_t stepCount, Millis timeoutMs, HotkeyCallback callback)
+{
+    if (stepCount == 0 || stepCount > MAX_STEPS)
+    {
+        ESP_LOGE(TAG, "Invalid number of steps: %u", static_cast<unsigned>(stepCount));
+        return INVALID_ID;
+    }
+
+    Hotkey hotkey{};
+    for (size_t i = 0; i < stepCount; ++i)
+    {
+        if (!compile(steps[i], hotkey.steps[i]))
+        {
+            ESP_LOGE(TAG, "Invalid chord in step %u", static_cast<unsigned>(i));
+            return INVALID_ID;
+        }
+    }
+
+    hotkey.id        = nextId_++;
+    hotkey.stepCount = stepCount;
+    hotkey.timeoutMs = timeoutMs;
+    hotkey.callback  = std::move(callback);
+    hotkeys_.push_back(std::move(hotkey));
+    rebuildIndex();
+    return hotkeys_.back().id;
+}
+
+bool UsbHidHotkeyMatcher::remove(Id id)
+{
+    auto it = std::find_if(hotkeys_.begin(), hotkeys_.end(), [id](const Hotkey& hotkey) { return hotkey.id == id; });
+    if (it == hotkeys_.end())
+    {
+        return false;
+    }
+
+    hotkeys_.erase(it);
+    rebuildIndex();
+    return true;
+}
+
+void UsbHidHotkeyMatcher::clear()
+{
+    hotkeys_.clear();
+    rebuildIndex();
+}
+
+void UsbHidHotkeyMatcher::reset()
+{
+    held_.clear();
+    modifiers_ = 0;
+    cancelSequences();
+}
+
+void UsbHidHotkeyMatcher::cancelSequences()
+{
+    activeCount_ = 0;
+    wheel_.stop(timer_);
+}
+
+bool UsbHidHotkeyMatcher::compile(const Chord& chord, CompiledChord& out)
+{
+    if (chord.keyCount == 0 || chord.keyCount > MAX_CHORD_KEYS)
+    {
+        return false;
+    }
+
+    CodeBitset keys;
+    for (size_t i = 0; i < chord.keyCount; ++i)
+    {
+        const Code code = chord.keys[i];
+        if (code >= CODE_COUNT || isModifierCode(code))
+        {
+            return false;
+        }
+        keys.set(code);
+        out.keys[i] = code;
+    }
+    out.keyCount  = chord.keyCount;
+    out.modifiers = foldModifiers(chord.modifiers);
+
+    // Keep only the non-empty words, at most one per key
+    out.maskCount = 0;
+    for (size_t w = 0; w < CodeBitset::WORDS; ++w)
+    {
+        if (keys.word(w) != 0)
+        {
+            out.masks[out.maskCount++] = {static_cast<uint8_t>(w), keys.word(w)};
+        }
+    }
+    return true;
+}
+
+uint8_t UsbHidHotkeyMatcher::foldModifiers(uint8_t modifiers)
+{
+    // Right Ctrl/Shift/Alt/GUI sit four bits above their left counterparts
+    return (modifiers | (modifiers >> 4)) & 0x0F;
+}
+
+void UsbHidHotkeyMatcher::rebuildIndex()
+{
+    // Hotkey indices change, drop sequences in progress
+    activeCount_ = 0;
+    wheel_.stop(timer_);
+
+    // Counting sort of (code, hotkey) pairs by code
+    std::fill(triggerStart_.begin(), triggerStart_.end(), 0);
+    for (const auto& hotkey : hotkeys_)
+    {
+        const CompiledChord& first = hotkey.steps[0];
+        for (size_t k = 0; k < first.keyCount; ++k)
+        {
+            ++triggerStart_[first.keys[k] + 1];
+        }
+    }
+    for (size_t code = 0; code < CODE_COUNT; ++code)
+    {
+        triggerStart_[code + 1] += triggerStart_[code];
+    }
+
+    triggers_.assign(triggerStart_[CODE_COUNT], 0);
+    std::vector<uint16_t> fill(triggerStart_.begin(), triggerStart_.end() - 1);
+    for (size_t i = 0; i < hotkeys_.size(); ++i)
+    {
+        const CompiledChord& first = hotkeys_[i].steps[0];
+        for (size_t k = 0; k < first.keyCount; ++k)
+        {
+            triggers_[fill[first.keys[k]]++] = static_cast<uint16_t>(i);
+        }
+    }
+}
+
+bool UsbHidHotkeyMatcher::matches(const CompiledChord& chord, Code trigger) const
+{
+    if (chord.modifiers != modifiers_)
+    {
+        return false;
+    }
+
+    // The trigger must belong to the chord, so that pressing an unrelated key while
+    // a chord is held does not fire it again
+    bool hasTrigger = false;
+    for (size_t k = 0; k < chord.keyCount; ++k)
+    {
+        hasTrigger |= chord.keys[k] == trigger;
+    }
+    if (!hasTrigger)
+    {
+        return false;
+    }
+
+    for (size_t m = 0; m < chord.maskCount; ++m)
+    {
+        const KeyMask& mask = chord.masks[m];
+        if ((held_.word(mask.word) & mask.bits) != mask.bits)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void UsbHidHotkeyMatcher::onKeyboardEvent(const UsbHidKeyboardEvent& event)
+{
+    if (event.repeat)
+    {
+        return;
+    }
+    onCode(KEYBOARD_BASE + event.keyCode, event.pressed, event.modifiers);
+}
+
+void UsbHidHotkeyMatcher::onRemoteEvent(const UsbHidG20sProEvent& event)
+{
+    if (event.buttonId == UsbHidRemoteProfile::NO_BUTTON)
+    {
+        return;
+    }
+    handleEdge(REMOTE_BASE + event.buttonId, event.pressed);
+}
+
+void UsbHidHotkeyMatcher::onCode(Code code, bool pressed, uint8_t modifiers)
+{
+    modifiers_ = foldModifiers(modifiers);
+    handleEdge(code, pressed);
+}
+
+void UsbHidHotkeyMatcher::handleEdge(Code code, bool pressed)
+{
+    if (code >= CODE_COUNT)
+    {
+        return;
+    }
+
+    if (!pressed)
+    {
+        held_.reset(code);
+        return;
+    }
+
+    // Some devices resend held buttons, only the first press is an edge
+    if (held_.test(code))
+    {
+        return;
+    }
+    held_.set(code);
+
+    if (!isModifierCode(code))
+    {
+        handlePress(code);
+    }
+}
+
+void UsbHidHotkeyMatcher::handlePress(Code code)
+{
+    const Millis now = wheel_.now();
+
+    // Sequences in progress take the press first
+    if (activeCount_ > 0)
+    {
+        std::array<Progress, MAX_ACTIVE> advanced;
+        size_t advancedCount = 0;
+        bool consumed        = false;
+
+        for (size_t i = 0; i < activeCount_; ++i)
+        {
+            const Progress& progress = active_[i];
+            const Hotkey& hotkey     = hotkeys_[progress.hotkey];
+            if (!reached(progress.deadline, now))
+            {
+                continue;  // Expired, the timer has not fired yet
+            }
+            if (!matches(hotkey.steps[progress.nextStep], code))
+            {
+                continue;
+            }
+
+            consumed = true;
+            if (progress.nextStep + 1 == hotkey.stepCount)
+            {
+                if (hotkey.callback) hotkey.callback(hotkey.id);
+            }
+            else
+            {
+                advanced[advancedCount++] = {progress.hotkey, static_cast<uint8_t>(progress.nextStep + 1), now + hotkey.timeoutMs};
+            }
+        }
+
+        // Any other key breaks all sequences in progress
+        active_      = advanced;
+        activeCount_ = advancedCount;
+        if (consumed)
+        {
+            armTimeout();
+            return;
+        }
+    }
+
+    for (uint16_t t = triggerStart_[code]; t < triggerStart_[code + 1]; ++t)
+    {
+        const Hotkey& hotkey = hotkeys_[triggers_[t]];
+        if (!matches(hotkey.steps[0], code))
+        {
+            continue;
+        }
+
+        if (hotkey.stepCount == 1)
+        {
+            if (hotkey.callback) hotkey.callback(hotkey.id);
+        }
+        else if (activeCount_ < MAX_ACTIVE)
+        {
+            active_[activeCount_++] = {triggers_[t], 1, now + hotkey.timeoutMs};
+        }
+        else
+        {
+            ESP_LOGW(TAG, "Too many sequences in progress, dropping hotkey %d", hotkey.id);
+        }
+    }
+    armTimeout();
+}
+
+void UsbHidHotkeyMatcher::armTimeout()
+{
+    if (activeCount_ == 0)
+    {
+        wheel_.stop(timer_);
+        return;
+    }
+
+    const Millis now = wheel_.now();
+    Millis earliest  = active_[0].deadline;
+    for (size_t i = 1; i < activeCount_; ++i)
+    {
+        if (!reached(active_[i].deadline, earliest))
+        {
+            earliest = active_[i].deadline;
+        }
+    }
+    wheel_.start(timer_, reached(now, earliest) ? 0 : earliest - now);
+}
+
+void UsbHidHotkeyMatcher::onTimeout(Millis now)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < activeCount_; ++i)
+    {
+        if (!reached(now, active_[i].deadline))
+        {
+            active_[kept++] = active_[i];
+        }
+    }
+    activeCount_ = kept;
+    armTimeout();
+}
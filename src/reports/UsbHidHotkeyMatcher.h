@@ -0,0 +1,233 @@
+/**
+ * @file UsbHidHotkeyMatcher.h
+ * @brief Defines the UsbHidHotkeyMatcher class, which matches key chords and sequences.
+ */
+
+#pragma once
+
+#include "UsbHidBitset.h"
+#include "UsbHidG20sProReport.h"
+#include "UsbHidKeyboardReport.h"
+#include "UsbHidTimerWheel.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+/**
+ * @class UsbHidHotkeyMatcher
+ * @brief Matches registered hotkeys against key edges from the keyboard and the G20s Pro.
+ *
+ * A hotkey is a chord (modifiers plus up to MAX_CHORD_KEYS keys held together) or a
+ * sequence of up to MAX_STEPS chords, e.g. Ctrl+K followed by Ctrl+C. Keyboard usages
+ * and G20s Pro buttons share one code space, so a chord may mix both devices.
+ *
+ * Registered hotkeys are compiled into an index keyed by trigger code: a press only
+ * looks at the hotkeys containing that code, then checks them with a modifier mask
+ * compare and a word-wise subset test against the held key bitset. The cost per event
+ * does not grow with the number of unrelated hotkeys.
+ *
+ * Left and right modifiers are equivalent. A chord fires when its last key goes down
+ * while exactly its modifiers are held; other held keys are ignored, so keyboards
+ * with limited rollover still match. Typematic repeats never fire hotkeys.
+ *
+ * Sequence timeouts run on a shared UsbHidTimerWheel, so the matcher is deterministic
+ * under a simulated clock.
+ *
+ * Callbacks run from the input path and must not add or remove hotkeys.
+ */
+class UsbHidHotkeyMatcher
+{
+public:
+    using Millis = UsbHidTimerWheel::Millis;
+    using Code   = uint16_t;
+
+    static constexpr Code KEYBOARD_BASE    = 0x000;  ///< Keyboard usage u is code KEYBOARD_BASE + u
+    static constexpr Code REMOTE_BASE      = 0x100;  ///< Remote profile button b is code REMOTE_BASE + b
+    static constexpr size_t CODE_COUNT     = 0x200;  ///< Size of the code space
+    static constexpr size_t MAX_CHORD_KEYS = 4;      ///< Keys per chord, modifiers excluded
+    static constexpr size_t MAX_STEPS      = 4;      ///< Chords per sequence
+    static constexpr size_t MAX_ACTIVE     = 8;      ///< Sequences tracked in progress at once
+
+    /// Identifies a registered hotkey
+    using Id = int;
+
+    /// Returned when a hotkey could not be registered
+    static constexpr Id INVALID_ID = -1;
+
+    /**
+     * @typedef HotkeyCallback
+     * @brief Function called when a hotkey matches, with its id.
+     */
+    using HotkeyCallback = std::function<void(Id id)>;
+
+    /**
+     * @struct Chord
+     * @brief Modifiers and keys that must be held together.
+     */
+    struct Chord
+    {
+        uint8_t modifiers;                        ///< UsbHidKeyboardReport::Modifier bits, either side
+        std::array<Code, MAX_CHORD_KEYS> keys;    ///< Codes of the keys, first keyCount are used
+        uint8_t keyCount;
+
+        Chord() : modifiers(0), keys{}, keyCount(0) {}
+        Chord(uint8_t modifiers, std::initializer_list<Code> codes);
+    };
+
+    static constexpr Code keyboardCode(UsbHidKeyboardReport::KeyCode key)
+    {
+        return KEYBOARD_BASE + static_cast<uint8_t>(key);
+    }
+
+    static constexpr Code remoteCode(G20sProBtn button)
+    {
+        return REMOTE_BASE + static_cast<uint8_t>(button);
+    }
+
+    /**
+     * @brief Construct a new UsbHidHotkeyMatcher object.
+     *
+     * @param wheel Timer wheel driving sequence timeouts.
+     */
+    explicit UsbHidHotkeyMatcher(UsbHidTimerWheel& wheel);
+
+    UsbHidHotkeyMatcher(const UsbHidHotkeyMatcher&)            = delete;
+    UsbHidHotkeyMatcher& operator=(const UsbHidHotkeyMatcher&) = delete;
+
+    /**
+     * @brief Register a chord.
+     *
+     * @param chord Modifiers and keys of the hotkey, at least one key.
+     * @param callback Function called when the chord matches.
+     * @return Id Id of the hotkey, or INVALID_ID if the chord is invalid.
+     */
+    Id addChord(const Chord& chord, HotkeyCallback callback);
+
+    /**
+     * @brief Register a sequence of chords.
+     *
+     * @param steps Chords in the order they must be pressed, 1 to MAX_STEPS.
+     * @param timeoutMs Maximum time between two steps.
+     * @param callback Function called when the last step matches.
+     * @return Id Id of the hotkey, or INVALID_ID if a step is invalid.
+     */
+    Id addSequence(std::initializer_list<Chord> steps, Millis timeoutMs, HotkeyCallback callback);
+
+    /**
+     * @brief Unregister a hotkey.
+     *
+     * @return true if the hotkey existed.
+     */
+    bool remove(Id id);
+
+    /**
+     * @brief Unregister all hotkeys.
+     */
+    void clear();
+
+    /**
+     * @brief Get the number of registered hotkeys.
+     */
+    size_t size() const { return hotkeys_.size(); }
+
+    /**
+     * @brief Feed a keyboard key edge.
+     */
+    void onKeyboardEvent(const UsbHidKeyboardEvent& event);
+
+    /**
+     * @brief Feed a G20s Pro event.
+     */
+    void onRemoteEvent(const UsbHidG20sProEvent& event);
+
+    /**
+     * @brief Feed an edge of any code.
+     *
+     * @param code Code of the key or button.
+     * @param pressed true on press, false on release.
+     * @param modifiers Modifier bits held after this edge.
+     */
+    void onCode(Code code, bool pressed, uint8_t modifiers);
+
+    /**
+     * @brief Forget held keys and sequences in progress, e.g. after a disconnect.
+     */
+    void reset();
+
+    /**
+     * @brief Abandon sequences in progress, keeping the held key state.
+     */
+    void cancelSequences();
+
+private:
+    /**
+     * @struct KeyMask
+     * @brief One word of a chord's key bitset.
+     */
+    struct KeyMask
+    {
+        uint8_t word;
+        uint32_t bits;
+    };
+
+    /**
+     * @struct CompiledChord
+     * @brief A chord as matched: folded modifiers and a sparse key bitset.
+     */
+    struct CompiledChord
+    {
+        uint8_t modifiers;                         ///< Folded to the left modifier bits
+        uint8_t maskCount;
+        std::array<KeyMask, MAX_CHORD_KEYS> masks; ///< Non-empty words of the key bitset
+        std::array<Code, MAX_CHORD_KEYS> keys;
+        uint8_t keyCount;
+    };
+
+    struct Hotkey
+    {
+        Id id;
+        std::array<CompiledChord, MAX_STEPS> steps;
+        uint8_t stepCount;
+        Millis timeoutMs;
+        HotkeyCallback callback;
+    };
+
+    /**
+     * @struct Progress
+     * @brief A sequence waiting for its next step.
+     */
+    struct Progress
+    {
+        uint16_t hotkey;   ///< Index into hotkeys_
+        uint8_t nextStep;
+        Millis deadline;
+    };
+
+    using CodeBitset = UsbHidBitset<CODE_COUNT>;
+
+    UsbHidTimerWheel& wheel_;
+    UsbHidTimerWheel::Timer timer_;
+    std::vector<Hotkey> hotkeys_;
+    Id nextId_;
+
+    std::vector<uint16_t> triggerStart_;  ///< Per code, first entry in triggers_; CODE_COUNT + 1 entries
+    std::vector<uint16_t> triggers_;      ///< Hotkey indices grouped by the codes of their first step
+
+    CodeBitset held_;
+    uint8_t modifiers_;  ///< Folded modifiers held
+    std::array<Progress, MAX_ACTIVE> active_;
+    size_t activeCount_;
+
+    static bool compile(const Chord& chord, CompiledChord& out);
+    static uint8_t foldModifiers(uint8_t modifiers);
+    bool matches(const CompiledChord& chord, Code trigger) const;
+    Id add(const Chord* steps, size_t stepCount, Millis timeoutMs, HotkeyCallback callback);
+    void rebuildIndex();
+    void handleEdge(Code code, bool pressed);
+    void handlePress(Code code);
+    void armTimeout();
+    void onTimeout(Millis now);
+};
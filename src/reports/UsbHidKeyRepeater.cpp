@@ -0,0 +1,74 @@
+/**
+ * @file UsbHidKeyRepeater.cpp
+ * @brief Implements the UsbHidKeyRepeater class, a host-side typematic key repeat engine.
+ */
+
+#include "UsbHidKeyRepeater.h"
+
+namespace
+{
+// Usage IDs that never repeat, see HID Usage Tables, Keyboard/Keypad Page (0x07)
+constexpr uint8_t USAGE_ERR_UNDEFINED = 0x03;
+constexpr uint8_t USAGE_CAPS_LOCK     = 0x39;
+constexpr uint8_t USAGE_SCROLL_LOCK   = 0x47;
+constexpr uint8_t USAGE_NUM_LOCK      = 0x53;
+constexpr uint8_t USAGE_LEFT_CTRL     = 0xE0;
+}  // namespace
+
+UsbHidKeyRepeater::UsbHidKeyRepeater(UsbHidTimerWheel& wheel, const Config& config, RepeatCallback callback)
+    : wheel_(wheel),
+      timer_([this](Millis) { onTimer(); }),
+      config_(config),
+      callback_(std::move(callback)),
+      key_(0)
+{
+}
+
+void UsbHidKeyRepeater::onKey(uint8_t keyCode, bool pressed)
+{
+    if (!isRepeatable(keyCode))
+    {
+        return;
+    }
+
+    if (pressed)
+    {
+        // The newest key takes over, as on a PC keyboard
+        key_ = keyCode;
+        wheel_.start(timer_, config_.delayMs);
+    }
+    else if (keyCode == key_)
+    {
+        cancel();
+    }
+}
+
+void UsbHidKeyRepeater::cancel()
+{
+    wheel_.stop(timer_);
+    key_ = 0;
+}
+
+bool UsbHidKeyRepeater::isRepeatable(uint8_t keyCode)
+{
+    return keyCode > USAGE_ERR_UNDEFINED &&
+           keyCode < USAGE_LEFT_CTRL &&
+           keyCode != USAGE_CAPS_LOCK &&
+           keyCode != USAGE_SCROLL_LOCK &&
+           keyCode != USAGE_NUM_LOCK;
+}
+
+void UsbHidKeyRepeater::onTimer()
+{
+    if (key_ == 0)
+    {
+        return;
+    }
+
+    // Re-arm first so the callback may cancel
+    wheel_.start(timer_, config_.intervalMs);
+    if (callback_)
+    {
+        callback_(key_);
+    }
+}
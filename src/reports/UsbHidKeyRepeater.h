@@ -0,0 +1,97 @@
+/**
+ * @file UsbHidKeyRepeater.h
+ * @brief Defines the UsbHidKeyRepeater class, a host-side typematic key repeat engine.
+ */
+
+#pragma once
+
+#include "UsbHidTimerWheel.h"
+#include <cstdint>
+#include <functional>
+
+/**
+ * @class UsbHidKeyRepeater
+ * @brief Generates typematic repeats for the most recently pressed key.
+ *
+ * Keyboards are put in infinite idle, so they never re-send held keys. The repeater
+ * follows key edges and, like a PC keyboard, repeats only the last key pressed:
+ * after the initial delay it fires every interval until that key is released or
+ * another key is pressed. Modifiers and lock keys never repeat.
+ *
+ * All timing is done with a single timer on a shared UsbHidTimerWheel.
+ */
+class UsbHidKeyRepeater
+{
+public:
+    using Millis = UsbHidTimerWheel::Millis;
+
+    /**
+     * @typedef RepeatCallback
+     * @brief Function called for every repeat of a held key.
+     */
+    using RepeatCallback = std::function<void(uint8_t keyCode)>;
+
+    /**
+     * @struct Config
+     * @brief Typematic delay and rate.
+     */
+    struct Config
+    {
+        Millis delayMs    = 500;  ///< Time from key-down to the first repeat
+        Millis intervalMs = 33;   ///< Time between repeats (about 30 per second)
+    };
+
+    /**
+     * @brief Construct a new UsbHidKeyRepeater object.
+     *
+     * @param wheel Timer wheel driving the repeats.
+     * @param config Typematic delay and rate.
+     * @param callback Function called for every repeat.
+     */
+    UsbHidKeyRepeater(UsbHidTimerWheel& wheel, const Config& config, RepeatCallback callback);
+
+    /**
+     * @brief Change the typematic delay and rate. Applies from the next key press.
+     */
+    void setConfig(const Config& config) { config_ = config; }
+
+    /**
+     * @brief Get the typematic delay and rate.
+     */
+    const Config& getConfig() const { return config_; }
+
+    /**
+     * @brief Feed a key edge.
+     *
+     * @param keyCode Usage ID of the key.
+     * @param pressed true on key-down, false on key-up.
+     */
+    void onKey(uint8_t keyCode, bool pressed);
+
+    /**
+     * @brief Stop repeating.
+     */
+    void cancel();
+
+    /**
+     * @brief Get the key that is repeating or waiting for its first repeat, 0 if none.
+     */
+    uint8_t getRepeatingKey() const { return key_; }
+
+    /**
+     * @brief Check whether a key takes part in typematic repeat.
+     *
+     * @param keyCode Usage ID of the key.
+     * @return true unless the key is a modifier, a lock key or an error code.
+     */
+    static bool isRepeatable(uint8_t keyCode);
+
+private:
+    UsbHidTimerWheel& wheel_;
+    UsbHidTimerWheel::Timer timer_;
+    Config config_;
+    RepeatCallback callback_;
+    uint8_t key_;  ///< Key being repeated, 0 if none
+
+    void onTimer();
+};
@@ -0,0 +1,292 @@
+/**
+ * @file UsbHidKeyboardLayout.cpp
+ * @brief Built-in keyboard layout tables and dead key compositions.
+ */
+
+#include "UsbHidKeyboardLayout.h"
+
+#include <algorithm>
+
+namespace
+{
+using Key = UsbHidKeyboardLayout::Key;
+
+constexpr uint8_t CAPS       = UsbHidKeyboardLayout::FLAG_CAPS;
+constexpr uint8_t DEAD_BASE  = UsbHidKeyboardLayout::FLAG_DEAD << UsbHidKeyboardLayout::LEVEL_BASE;
+constexpr uint8_t DEAD_SHIFT = UsbHidKeyboardLayout::FLAG_DEAD << UsbHidKeyboardLayout::LEVEL_SHIFT;
+constexpr uint8_t DEAD_ALTGR = UsbHidKeyboardLayout::FLAG_DEAD << UsbHidKeyboardLayout::LEVEL_ALTGR;
+
+/**
+ * @struct KeyDef
+ * @brief One key of a layout as written in the tables below.
+ */
+struct KeyDef
+{
+    uint8_t usage;
+    char16_t base;
+    char16_t shift;
+    char16_t altGr;
+    char16_t shiftAltGr;
+    uint8_t flags;
+};
+
+/**
+ * @brief Build a key table: Latin letters a-z and space, overridden by the layout's keys.
+ */
+template <size_t N>
+constexpr std::array<Key, UsbHidKeyboardLayout::KEY_COUNT> buildKeys(const KeyDef (&defs)[N])
+{
+    std::array<Key, UsbHidKeyboardLayout::KEY_COUNT> keys{};
+
+    for (uint8_t usage = 0x04; usage <= 0x1D; ++usage)
+    {
+        const char16_t offset = usage - 0x04;
+        keys[UsbHidKeyboardLayout::keyIndex(usage)] = {{char16_t(u'a' + offset), char16_t(u'A' + offset), 0, 0}, CAPS};
+    }
+    keys[UsbHidKeyboardLayout::keyIndex(0x2C)] = {{u' ', u' ', u' ', u' '}, 0};
+
+    for (const auto& def : defs)
+    {
+        keys[UsbHidKeyboardLayout::keyIndex(def.usage)] = {{def.base, def.shift, def.altGr, def.shiftAltGr}, def.flags};
+    }
+    return keys;
+}
+
+constexpr KeyDef US_KEYS[] = {
+    {0x1E, u'1', u'!', 0, 0, 0},
+    {0x1F, u'2', u'@', 0, 0, 0},
+    {0x20, u'3', u'#', 0, 0, 0},
+    {0x21, u'4', u'$', 0, 0, 0},
+    {0x22, u'5', u'%', 0, 0, 0},
+    {0x23, u'6', u'^', 0, 0, 0},
+    {0x24, u'7', u'&', 0, 0, 0},
+    {0x25, u'8', u'*', 0, 0, 0},
+    {0x26, u'9', u'(', 0, 0, 0},
+    {0x27, u'0', u')', 0, 0, 0},
+    {0x2D, u'-', u'_', 0, 0, 0},
+    {0x2E, u'=', u'+', 0, 0, 0},
+    {0x2F, u'[', u'{', 0, 0, 0},
+    {0x30, u']', u'}', 0, 0, 0},
+    {0x31, u'\\', u'|', 0, 0, 0},
+    {0x32, u'\\', u'|', 0, 0, 0},
+    {0x33, u';', u':', 0, 0, 0},
+    {0x34, u'\'', u'"', 0, 0, 0},
+    {0x35, u'`', u'~', 0, 0, 0},
+    {0x36, u',', u'<', 0, 0, 0},
+    {0x37, u'.', u'>', 0, 0, 0},
+    {0x38, u'/', u'?', 0, 0, 0},
+    {0x64, u'\\', u'|', 0, 0, 0},
+};
+
+constexpr KeyDef UK_KEYS[] = {
+    {0x04, u'a', u'A', u'\u00E1', u'\u00C1', CAPS},  // á Á
+    {0x08, u'e', u'E', u'\u00E9', u'\u00C9', CAPS},  // é É
+    {0x0C, u'i', u'I', u'\u00ED', u'\u00CD', CAPS},  // í Í
+    {0x12, u'o', u'O', u'\u00F3', u'\u00D3', CAPS},  // ó Ó
+    {0x18, u'u', u'U', u'\u00FA', u'\u00DA', CAPS},  // ú Ú
+    {0x1E, u'1', u'!', 0, 0, 0},
+    {0x1F, u'2', u'"', 0, 0, 0},
+    {0x20, u'3', u'\u00A3', 0, 0, 0},  // £
+    {0x21, u'4', u'$', u'\u20AC', 0, 0},  // €
+    {0x22, u'5', u'%', 0, 0, 0},
+    {0x23, u'6', u'^', 0, 0, 0},
+    {0x24, u'7', u'&', 0, 0, 0},
+    {0x25, u'8', u'*', 0, 0, 0},
+    {0x26, u'9', u'(', 0, 0, 0},
+    {0x27, u'0', u')', 0, 0, 0},
+    {0x2D, u'-', u'_', 0, 0, 0},
+    {0x2E, u'=', u'+', 0, 0, 0},
+    {0x2F, u'[', u'{', 0, 0, 0},
+    {0x30, u']', u'}', 0, 0, 0},
+    {0x31, u'#', u'~', 0, 0, 0},
+    {0x32, u'#', u'~', 0, 0, 0},
+    {0x33, u';', u':', 0, 0, 0},
+    {0x34, u'\'', u'@', 0, 0, 0},
+    {0x35, u'`', u'\u00AC', u'\u00A6', 0, 0},  // ¬ ¦
+    {0x36, u',', u'<', 0, 0, 0},
+    {0x37, u'.', u'>', 0, 0, 0},
+    {0x38, u'/', u'?', 0, 0, 0},
+    {0x64, u'\\', u'|', 0, 0, 0},
+};
+
+constexpr KeyDef DE_KEYS[] = {
+    {0x08, u'e', u'E', u'\u20AC', 0, CAPS},  // €
+    {0x10, u'm', u'M', u'\u00B5', 0, CAPS},  // µ
+    {0x14, u'q', u'Q', u'@', 0, CAPS},
+    {0x1C, u'z', u'Z', 0, 0, CAPS},
+    {0x1D, u'y', u'Y', 0, 0, CAPS},
+    {0x1E, u'1', u'!', 0, 0, 0},
+    {0x1F, u'2', u'"', u'\u00B2', 0, 0},  // ²
+    {0x20, u'3', u'\u00A7', u'\u00B3', 0, 0},  // § ³
+    {0x21, u'4', u'$', 0, 0, 0},
+    {0x22, u'5', u'%', 0, 0, 0},
+    {0x23, u'6', u'&', 0, 0, 0},
+    {0x24, u'7', u'/', u'{', 0, 0},
+    {0x25, u'8', u'(', u'[', 0, 0},
+    {0x26, u'9', u')', u']', 0, 0},
+    {0x27, u'0', u'=', u'}', 0, 0},
+    {0x2D, u'\u00DF', u'?', u'\\', 0, 0},  // ß
+    {0x2E, u'\u00B4', u'`', 0, 0, DEAD_BASE | DEAD_SHIFT},  // ´
+    {0x2F, u'\u00FC', u'\u00DC', 0, 0, CAPS},  // ü Ü
+    {0x30, u'+', u'*', u'~', 0, 0},
+    {0x31, u'#', u'\'', 0, 0, 0},
+    {0x32, u'#', u'\'', 0, 0, 0},
+    {0x33, u'\u00F6', u'\u00D6', 0, 0, CAPS},  // ö Ö
+    {0x34, u'\u00E4', u'\u00C4', 0, 0, CAPS},  // ä Ä
+    {0x35, u'^', u'\u00B0', 0, 0, DEAD_BASE},  // °
+    {0x36, u',', u';', 0, 0, 0},
+    {0x37, u'.', u':', 0, 0, 0},
+    {0x38, u'-', u'_', 0, 0, 0},
+    {0x64, u'<', u'>', u'|', 0, 0},
+};
+
+constexpr KeyDef FR_KEYS[] = {
+    {0x04, u'q', u'Q', 0, 0, CAPS},
+    {0x08, u'e', u'E', u'\u20AC', 0, CAPS},  // €
+    {0x10, u',', u'?', 0, 0, 0},
+    {0x14, u'a', u'A', 0, 0, CAPS},
+    {0x1A, u'z', u'Z', 0, 0, CAPS},
+    {0x1D, u'w', u'W', 0, 0, CAPS},
+    {0x1E, u'&', u'1', 0, 0, 0},
+    {0x1F, u'\u00E9', u'2', u'~', 0, DEAD_ALTGR},  // é
+    {0x20, u'"', u'3', u'#', 0, 0},
+    {0x21, u'\'', u'4', u'{', 0, 0},
+    {0x22, u'(', u'5', u'[', 0, 0},
+    {0x23, u'-', u'6', u'|', 0, 0},
+    {0x24, u'\u00E8', u'7', u'`', 0, DEAD_ALTGR},  // è
+    {0x25, u'_', u'8', u'\\', 0, 0},
+    {0x26, u'\u00E7', u'9', u'^', 0, 0},  // ç
+    {0x27, u'\u00E0', u'0', u'@', 0, 0},  // à
+    {0x2D, u')', u'\u00B0', u']', 0, 0},  // °
+    {0x2E, u'=', u'+', u'}', 0, 0},
+    {0x2F, u'^', u'\u00A8', 0, 0, DEAD_BASE | DEAD_SHIFT},  // ¨
+    {0x30, u'$', u'\u00A3', u'\u00A4', 0, 0},  // £ ¤
+    {0x31, u'*', u'\u00B5', 0, 0, 0},  // µ
+    {0x32, u'*', u'\u00B5', 0, 0, 0},  // µ
+    {0x33, u'm', u'M', 0, 0, CAPS},
+    {0x34, u'\u00F9', u'%', 0, 0, 0},  // ù
+    {0x35, u'\u00B2', 0, 0, 0, 0},  // ²
+    {0x36, u';', u'.', 0, 0, 0},
+    {0x37, u':', u'/', 0, 0, 0},
+    {0x38, u'!', u'\u00A7', 0, 0, 0},  // §
+    {0x64, u'<', u'>', 0, 0, 0},
+};
+
+/**
+ * @struct Composition
+ * @brief Dead key followed by a base character and the resulting character.
+ */
+struct Composition
+{
+    char16_t dead;
+    char16_t base;
+    char16_t composed;
+};
+
+/// Sorted by dead key, then base character
+constexpr Composition COMPOSITIONS[] = {
+    {0x005E, u'A', u'\u00C2'},  // Â
+    {0x005E, u'C', u'\u0108'},  // Ĉ
+    {0x005E, u'E', u'\u00CA'},  // Ê
+    {0x005E, u'I', u'\u00CE'},  // Î
+    {0x005E, u'O', u'\u00D4'},  // Ô
+    {0x005E, u'U', u'\u00DB'},  // Û
+    {0x005E, u'Y', u'\u0176'},  // Ŷ
+    {0x005E, u'a', u'\u00E2'},  // â
+    {0x005E, u'c', u'\u0109'},  // ĉ
+    {0x005E, u'e', u'\u00EA'},  // ê
+    {0x005E, u'i', u'\u00EE'},  // î
+    {0x005E, u'o', u'\u00F4'},  // ô
+    {0x005E, u'u', u'\u00FB'},  // û
+    {0x005E, u'y', u'\u0177'},  // ŷ
+    {0x0060, u'A', u'\u00C0'},  // À
+    {0x0060, u'E', u'\u00C8'},  // È
+    {0x0060, u'I', u'\u00CC'},  // Ì
+    {0x0060, u'N', u'\u01F8'},  // Ǹ
+    {0x0060, u'O', u'\u00D2'},  // Ò
+    {0x0060, u'U', u'\u00D9'},  // Ù
+    {0x0060, u'Y', u'\u1EF2'},  // Ỳ
+    {0x0060, u'a', u'\u00E0'},  // à
+    {0x0060, u'e', u'\u00E8'},  // è
+    {0x0060, u'i', u'\u00EC'},  // ì
+    {0x0060, u'n', u'\u01F9'},  // ǹ
+    {0x0060, u'o', u'\u00F2'},  // ò
+    {0x0060, u'u', u'\u00F9'},  // ù
+    {0x0060, u'y', u'\u1EF3'},  // ỳ
+    {0x007E, u'A', u'\u00C3'},  // Ã
+    {0x007E, u'E', u'\u1EBC'},  // Ẽ
+    {0x007E, u'I', u'\u0128'},  // Ĩ
+    {0x007E, u'N', u'\u00D1'},  // Ñ
+    {0x007E, u'O', u'\u00D5'},  // Õ
+    {0x007E, u'U', u'\u0168'},  // Ũ
+    {0x007E, u'Y', u'\u1EF8'},  // Ỹ
+    {0x007E, u'a', u'\u00E3'},  // ã
+    {0x007E, u'e', u'\u1EBD'},  // ẽ
+    {0x007E, u'i', u'\u0129'},  // ĩ
+    {0x007E, u'n', u'\u00F1'},  // ñ
+    {0x007E, u'o', u'\u00F5'},  // õ
+    {0x007E, u'u', u'\u0169'},  // ũ
+    {0x007E, u'y', u'\u1EF9'},  // ỹ
+    {0x00A8, u'A', u'\u00C4'},  // Ä
+    {0x00A8, u'E', u'\u00CB'},  // Ë
+    {0x00A8, u'I', u'\u00CF'},  // Ï
+    {0x00A8, u'O', u'\u00D6'},  // Ö
+    {0x00A8, u'U', u'\u00DC'},  // Ü
+    {0x00A8, u'Y', u'\u0178'},  // Ÿ
+    {0x00A8, u'a', u'\u00E4'},  // ä
+    {0x00A8, u'e', u'\u00EB'},  // ë
+    {0x00A8, u'i', u'\u00EF'},  // ï
+    {0x00A8, u'o', u'\u00F6'},  // ö
+    {0x00A8, u'u', u'\u00FC'},  // ü
+    {0x00A8, u'y', u'\u00FF'},  // ÿ
+    {0x00B4, u'A', u'\u00C1'},  // Á
+    {0x00B4, u'C', u'\u0106'},  // Ć
+    {0x00B4, u'E', u'\u00C9'},  // É
+    {0x00B4, u'I', u'\u00CD'},  // Í
+    {0x00B4, u'N', u'\u0143'},  // Ń
+    {0x00B4, u'O', u'\u00D3'},  // Ó
+    {0x00B4, u'U', u'\u00DA'},  // Ú
+    {0x00B4, u'Y', u'\u00DD'},  // Ý
+    {0x00B4, u'a', u'\u00E1'},  // á
+    {0x00B4, u'c', u'\u0107'},  // ć
+    {0x00B4, u'e', u'\u00E9'},  // é
+    {0x00B4, u'i', u'\u00ED'},  // í
+    {0x00B4, u'n', u'\u0144'},  // ń
+    {0x00B4, u'o', u'\u00F3'},  // ó
+    {0x00B4, u'u', u'\u00FA'},  // ú
+    {0x00B4, u'y', u'\u00FD'},  // ý
+};
+
+constexpr bool compositionsSorted()
+{
+    for (size_t i = 1; i < std::size(COMPOSITIONS); ++i)
+    {
+        const auto& a = COMPOSITIONS[i - 1];
+        const auto& b = COMPOSITIONS[i];
+        if (a.dead > b.dead || (a.dead == b.dead && a.base >= b.base)) return false;
+    }
+    return true;
+}
+static_assert(compositionsSorted(), "COMPOSITIONS must be sorted for binary search");
+}  // namespace
+
+char32_t UsbHidKeyboardLayout::compose(char32_t dead, char32_t base)
+{
+    const auto less = [](const Composition& entry, std::pair<char32_t, char32_t> key)
+    { return entry.dead < key.first || (entry.dead == key.first && entry.base < key.second); };
+
+    const auto* it = std::lower_bound(std::begin(COMPOSITIONS), std::end(COMPOSITIONS), std::make_pair(dead, base), less);
+    if (it != std::end(COMPOSITIONS) && it->dead == dead && it->base == base)
+    {
+        return it->composed;
+    }
+    return 0;
+}
+
+namespace UsbHidKeyboardLayouts
+{
+constexpr UsbHidKeyboardLayout US = {"US", false, u'.', buildKeys(US_KEYS)};
+constexpr UsbHidKeyboardLayout UK = {"UK", true, u'.', buildKeys(UK_KEYS)};
+constexpr UsbHidKeyboardLayout DE = {"DE", true, u',', buildKeys(DE_KEYS)};
+constexpr UsbHidKeyboardLayout FR = {"FR", true, u'.', buildKeys(FR_KEYS)};
+}  // namespace UsbHidKeyboardLayouts
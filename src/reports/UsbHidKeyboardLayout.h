@@ -0,0 +1,91 @@
+/**
+ * @file UsbHidKeyboardLayout.h
+ * @brief Defines keyboard layout tables mapping keyboard usages to Unicode code points.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @struct UsbHidKeyboardLayout
+ * @brief Compact, constexpr description of a keyboard layout.
+ *
+ * Only the layout dependent keys are stored: usages 0x04 (A) to 0x38 (Slash) and 0x64
+ * (the ISO key next to left shift). Keypad, Enter, Tab and friends are the same on all
+ * layouts and handled by UsbHidTextTranslator.
+ */
+struct UsbHidKeyboardLayout
+{
+    /// Shift levels stored per key
+    enum Level : uint8_t
+    {
+        LEVEL_BASE        = 0,
+        LEVEL_SHIFT       = 1,
+        LEVEL_ALTGR       = 2,
+        LEVEL_SHIFT_ALTGR = 3,
+        LEVEL_COUNT       = 4
+    };
+
+    /// Caps lock acts as shift on this key
+    static constexpr uint8_t FLAG_CAPS = 0x01;
+    /// The code point at a level is a dead key (diacritic), FLAG_DEAD << level
+    static constexpr uint8_t FLAG_DEAD = 0x10;
+
+    static constexpr uint8_t FIRST_USAGE   = 0x04;  ///< First stored usage (A)
+    static constexpr uint8_t LAST_USAGE    = 0x38;  ///< Last usage of the contiguous block (Slash)
+    static constexpr uint8_t NON_US_USAGE  = 0x64;  ///< ISO key next to left shift, stored after the block
+    static constexpr size_t KEY_COUNT      = LAST_USAGE - FIRST_USAGE + 2;
+
+    /**
+     * @struct Key
+     * @brief Code points of one key at every level, 0 where the level produces nothing.
+     */
+    struct Key
+    {
+        char16_t level[LEVEL_COUNT];
+        uint8_t flags;
+    };
+
+    std::string_view name;           ///< Layout name, e.g. "US"
+    bool hasAltGr;                   ///< Right Alt selects the AltGr levels instead of acting as Alt
+    char16_t keypadDecimal;          ///< Character produced by keypad '.' with num lock on
+    std::array<Key, KEY_COUNT> keys; ///< Keys indexed by keyIndex()
+
+    /**
+     * @brief Get the table index of a usage.
+     *
+     * @param usage Keyboard usage ID.
+     * @return int Index into keys, or -1 if the usage is not layout dependent.
+     */
+    static constexpr int keyIndex(uint8_t usage)
+    {
+        if (usage >= FIRST_USAGE && usage <= LAST_USAGE) return usage - FIRST_USAGE;
+        if (usage == NON_US_USAGE) return KEY_COUNT - 1;
+        return -1;
+    }
+
+    /**
+     * @brief Compose a dead key with the following character.
+     *
+     * @param dead Code point of the dead key (e.g. U+00B4 ACUTE ACCENT).
+     * @param base Code point of the following character.
+     * @return char32_t The composed character, or 0 if the pair does not compose.
+     */
+    static char32_t compose(char32_t dead, char32_t base);
+};
+
+/**
+ * @namespace UsbHidKeyboardLayouts
+ * @brief Built-in layouts, stored in flash.
+ */
+namespace UsbHidKeyboardLayouts
+{
+extern const UsbHidKeyboardLayout US;  ///< US English (QWERTY)
+extern const UsbHidKeyboardLayout UK;  ///< UK English (QWERTY, ISO)
+extern const UsbHidKeyboardLayout DE;  ///< German (QWERTZ, ISO)
+extern const UsbHidKeyboardLayout FR;  ///< French (AZERTY, ISO)
+}  // namespace UsbHidKeyboardLayouts
@@ -4,8 +4,268 @@
  */
 
 #include "UsbHidKeyboardReport.h"
+#include "UsbHidFormat.h"
+#include <array>
 #include <cstring>
-#include <sstream>
+
+namespace
+{
+/**
+ * @struct KeyNameEntry
+ * @brief Key code and name pair used to build the key name table.
+ */
+struct KeyNameEntry
+{
+    UsbHidKeyboardReport::KeyCode keyCode;
+    std::string_view name;
+};
+
+/**
+ * @brief Build the usage ID to key name table at compile time.
+ *
+ * @return std::array<std::string_view, 256> Names indexed by usage ID, "Unknown" for reserved usages.
+ */
+constexpr std::array<std::string_view, 256> makeKeyNames()
+{
+    using KeyCode = UsbHidKeyboardReport::KeyCode;
+
+    const KeyNameEntry entries[] = {
+        {KeyCode::KEY_NONE, "NONE"},
+        {KeyCode::KEY_ERR_ROLLOVER, "ERR_ROLLOVER"},
+        {KeyCode::KEY_POST_FAIL, "POST_FAIL"},
+        {KeyCode::KEY_ERR_UNDEFINED, "ERR_UNDEFINED"},
+        {KeyCode::KEY_A, "A"},
+        {KeyCode::KEY_B, "B"},
+        {KeyCode::KEY_C, "C"},
+        {KeyCode::KEY_D, "D"},
+        {KeyCode::KEY_E, "E"},
+        {KeyCode::KEY_F, "F"},
+        {KeyCode::KEY_G, "G"},
+        {KeyCode::KEY_H, "H"},
+        {KeyCode::KEY_I, "I"},
+        {KeyCode::KEY_J, "J"},
+        {KeyCode::KEY_K, "K"},
+        {KeyCode::KEY_L, "L"},
+        {KeyCode::KEY_M, "M"},
+        {KeyCode::KEY_N, "N"},
+        {KeyCode::KEY_O, "O"},
+        {KeyCode::KEY_P, "P"},
+        {KeyCode::KEY_Q, "Q"},
+        {KeyCode::KEY_R, "R"},
+        {KeyCode::KEY_S, "S"},
+        {KeyCode::KEY_T, "T"},
+        {KeyCode::KEY_U, "U"},
+        {KeyCode::KEY_V, "V"},
+        {KeyCode::KEY_W, "W"},
+        {KeyCode::KEY_X, "X"},
+        {KeyCode::KEY_Y, "Y"},
+        {KeyCode::KEY_Z, "Z"},
+        {KeyCode::KEY_1, "1"},
+        {KeyCode::KEY_2, "2"},
+        {KeyCode::KEY_3, "3"},
+        {KeyCode::KEY_4, "4"},
+        {KeyCode::KEY_5, "5"},
+        {KeyCode::KEY_6, "6"},
+        {KeyCode::KEY_7, "7"},
+        {KeyCode::KEY_8, "8"},
+        {KeyCode::KEY_9, "9"},
+        {KeyCode::KEY_0, "0"},
+        {KeyCode::KEY_ENTER, "ENTER"},
+        {KeyCode::KEY_ESC, "ESC"},
+        {KeyCode::KEY_BACKSPACE, "BACKSPACE"},
+        {KeyCode::KEY_TAB, "TAB"},
+        {KeyCode::KEY_SPACE, "SPACE"},
+        {KeyCode::KEY_MINUS, "MINUS"},
+        {KeyCode::KEY_EQUAL, "EQUAL"},
+        {KeyCode::KEY_BRACKET_LEFT, "BRACKET_LEFT"},
+        {KeyCode::KEY_BRACKET_RIGHT, "BRACKET_RIGHT"},
+        {KeyCode::KEY_BACKSLASH, "BACKSLASH"},
+        {KeyCode::KEY_HASHTAG, "HASHTAG"},
+        {KeyCode::KEY_SEMICOLON, "SEMICOLON"},
+        {KeyCode::KEY_QUOTE, "QUOTE"},
+        {KeyCode::KEY_TILDE, "TILDE"},
+        {KeyCode::KEY_COMMA, "COMMA"},
+        {KeyCode::KEY_DOT, "DOT"},
+        {KeyCode::KEY_SLASH, "SLASH"},
+        {KeyCode::KEY_CAPS_LOCK, "CAPS_LOCK"},
+        {KeyCode::KEY_F1, "F1"},
+        {KeyCode::KEY_F2, "F2"},
+        {KeyCode::KEY_F3, "F3"},
+        {KeyCode::KEY_F4, "F4"},
+        {KeyCode::KEY_F5, "F5"},
+        {KeyCode::KEY_F6, "F6"},
+        {KeyCode::KEY_F7, "F7"},
+        {KeyCode::KEY_F8, "F8"},
+        {KeyCode::KEY_F9, "F9"},
+        {KeyCode::KEY_F10, "F10"},
+        {KeyCode::KEY_F11, "F11"},
+        {KeyCode::KEY_F12, "F12"},
+        {KeyCode::KEY_PRINTSCREEN, "PRINTSCREEN"},
+        {KeyCode::KEY_SCROLL_LOCK, "SCROLL_LOCK"},
+        {KeyCode::KEY_PAUSE, "PAUSE"},
+        {KeyCode::KEY_INSERT, "INSERT"},
+        {KeyCode::KEY_HOME, "HOME"},
+        {KeyCode::KEY_PAGE_UP, "PAGE_UP"},
+        {KeyCode::KEY_DELETE, "DELETE"},
+        {KeyCode::KEY_END, "END"},
+        {KeyCode::KEY_PAGE_DOWN, "PAGE_DOWN"},
+        {KeyCode::KEY_ARROW_RIGHT, "ARROW_RIGHT"},
+        {KeyCode::KEY_ARROW_LEFT, "ARROW_LEFT"},
+        {KeyCode::KEY_ARROW_DOWN, "ARROW_DOWN"},
+        {KeyCode::KEY_ARROW_UP, "ARROW_UP"},
+        {KeyCode::KEY_NUM_LOCK, "NUM_LOCK"},
+        {KeyCode::KEYPAD_SLASH, "KEYPAD_SLASH"},
+        {KeyCode::KEYPAD_ASTERISK, "KEYPAD_ASTERISK"},
+        {KeyCode::KEYPAD_MINUS, "KEYPAD_MINUS"},
+        {KeyCode::KEYPAD_PLUS, "KEYPAD_PLUS"},
+        {KeyCode::KEYPAD_ENTER, "KEYPAD_ENTER"},
+        {KeyCode::KEYPAD_1, "KEYPAD_1"},
+        {KeyCode::KEYPAD_2, "KEYPAD_2"},
+        {KeyCode::KEYPAD_3, "KEYPAD_3"},
+        {KeyCode::KEYPAD_4, "KEYPAD_4"},
+        {KeyCode::KEYPAD_5, "KEYPAD_5"},
+        {KeyCode::KEYPAD_6, "KEYPAD_6"},
+        {KeyCode::KEYPAD_7, "KEYPAD_7"},
+        {KeyCode::KEYPAD_8, "KEYPAD_8"},
+        {KeyCode::KEYPAD_9, "KEYPAD_9"},
+        {KeyCode::KEYPAD_0, "KEYPAD_0"},
+        {KeyCode::KEYPAD_DOT, "KEYPAD_DOT"},
+        {KeyCode::KEY_NON_US_HASH, "NON_US_HASH"},
+        {KeyCode::KEY_APPLICATION, "APPLICATION"},
+        {KeyCode::KEY_POWER, "POWER"},
+        {KeyCode::KEYPAD_EQUAL, "KEYPAD_EQUAL"},
+        {KeyCode::KEY_F13, "F13"},
+        {KeyCode::KEY_F14, "F14"},
+        {KeyCode::KEY_F15, "F15"},
+        {KeyCode::KEY_F16, "F16"},
+        {KeyCode::KEY_F17, "F17"},
+        {KeyCode::KEY_F18, "F18"},
+        {KeyCode::KEY_F19, "F19"},
+        {KeyCode::KEY_F20, "F20"},
+        {KeyCode::KEY_F21, "F21"},
+        {KeyCode::KEY_F22, "F22"},
+        {KeyCode::KEY_F23, "F23"},
+        {KeyCode::KEY_F24, "F24"},
+        {KeyCode::KEY_EXECUTE, "EXECUTE"},
+        {KeyCode::KEY_HELP, "HELP"},
+        {KeyCode::KEY_MENU, "MENU"},
+        {KeyCode::KEY_SELECT, "SELECT"},
+        {KeyCode::KEY_STOP, "STOP"},
+        {KeyCode::KEY_AGAIN, "AGAIN"},
+        {KeyCode::KEY_UNDO, "UNDO"},
+        {KeyCode::KEY_CUT, "CUT"},
+        {KeyCode::KEY_COPY, "COPY"},
+        {KeyCode::KEY_PASTE, "PASTE"},
+        {KeyCode::KEY_FIND, "FIND"},
+        {KeyCode::KEY_MUTE, "MUTE"},
+        {KeyCode::KEY_VOLUME_UP, "VOLUME_UP"},
+        {KeyCode::KEY_VOLUME_DOWN, "VOLUME_DOWN"},
+        {KeyCode::KEY_LOCKING_CAPS, "LOCKING_CAPS"},
+        {KeyCode::KEY_LOCKING_NUM, "LOCKING_NUM"},
+        {KeyCode::KEY_LOCKING_SCROLL, "LOCKING_SCROLL"},
+        {KeyCode::KEYPAD_COMMA, "KEYPAD_COMMA"},
+        {KeyCode::KEYPAD_EQUAL_SIGN, "KEYPAD_EQUAL_SIGN"},
+        {KeyCode::KEY_INTERNATIONAL_1, "INTERNATIONAL_1"},
+        {KeyCode::KEY_INTERNATIONAL_2, "INTERNATIONAL_2"},
+        {KeyCode::KEY_INTERNATIONAL_3, "INTERNATIONAL_3"},
+        {KeyCode::KEY_INTERNATIONAL_4, "INTERNATIONAL_4"},
+        {KeyCode::KEY_INTERNATIONAL_5, "INTERNATIONAL_5"},
+        {KeyCode::KEY_INTERNATIONAL_6, "INTERNATIONAL_6"},
+        {KeyCode::KEY_INTERNATIONAL_7, "INTERNATIONAL_7"},
+        {KeyCode::KEY_INTERNATIONAL_8, "INTERNATIONAL_8"},
+        {KeyCode::KEY_INTERNATIONAL_9, "INTERNATIONAL_9"},
+        {KeyCode::KEY_LANG_1, "LANG_1"},
+        {KeyCode::KEY_LANG_2, "LANG_2"},
+        {KeyCode::KEY_LANG_3, "LANG_3"},
+        {KeyCode::KEY_LANG_4, "LANG_4"},
+        {KeyCode::KEY_LANG_5, "LANG_5"},
+        {KeyCode::KEY_LANG_6, "LANG_6"},
+        {KeyCode::KEY_LANG_7, "LANG_7"},
+        {KeyCode::KEY_LANG_8, "LANG_8"},
+        {KeyCode::KEY_LANG_9, "LANG_9"},
+        {KeyCode::KEY_ALTERNATE_ERASE, "ALTERNATE_ERASE"},
+        {KeyCode::KEY_SYSREQ, "SYSREQ"},
+        {KeyCode::KEY_CANCEL, "CANCEL"},
+        {KeyCode::KEY_CLEAR, "CLEAR"},
+        {KeyCode::KEY_PRIOR, "PRIOR"},
+        {KeyCode::KEY_RETURN, "RETURN"},
+        {KeyCode::KEY_SEPARATOR, "SEPARATOR"},
+        {KeyCode::KEY_OUT, "OUT"},
+        {KeyCode::KEY_OPER, "OPER"},
+        {KeyCode::KEY_CLEAR_AGAIN, "CLEAR_AGAIN"},
+        {KeyCode::KEY_CRSEL, "CRSEL"},
+        {KeyCode::KEY_EXSEL, "EXSEL"},
+        {KeyCode::KEYPAD_00, "KEYPAD_00"},
+        {KeyCode::KEYPAD_000, "KEYPAD_000"},
+        {KeyCode::THOUSANDS_SEPARATOR, "THOUSANDS_SEPARATOR"},
+        {KeyCode::DECIMAL_SEPARATOR, "DECIMAL_SEPARATOR"},
+        {KeyCode::CURRENCY_UNIT, "CURRENCY_UNIT"},
+        {KeyCode::CURRENCY_SUBUNIT, "CURRENCY_SUBUNIT"},
+        {KeyCode::KEYPAD_PARENTHESIS_LEFT, "KEYPAD_PARENTHESIS_LEFT"},
+        {KeyCode::KEYPAD_PARENTHESIS_RIGHT, "KEYPAD_PARENTHESIS_RIGHT"},
+        {KeyCode::KEYPAD_BRACE_LEFT, "KEYPAD_BRACE_LEFT"},
+        {KeyCode::KEYPAD_BRACE_RIGHT, "KEYPAD_BRACE_RIGHT"},
+        {KeyCode::KEYPAD_TAB, "KEYPAD_TAB"},
+        {KeyCode::KEYPAD_BACKSPACE, "KEYPAD_BACKSPACE"},
+        {KeyCode::KEYPAD_A, "KEYPAD_A"},
+        {KeyCode::KEYPAD_B, "KEYPAD_B"},
+        {KeyCode::KEYPAD_C, "KEYPAD_C"},
+        {KeyCode::KEYPAD_D, "KEYPAD_D"},
+        {KeyCode::KEYPAD_E, "KEYPAD_E"},
+        {KeyCode::KEYPAD_F, "KEYPAD_F"},
+        {KeyCode::KEYPAD_XOR, "KEYPAD_XOR"},
+        {KeyCode::KEYPAD_CARET, "KEYPAD_CARET"},
+        {KeyCode::KEYPAD_PERCENT, "KEYPAD_PERCENT"},
+        {KeyCode::KEYPAD_LESS_THAN, "KEYPAD_LESS_THAN"},
+        {KeyCode::KEYPAD_GREATER_THAN, "KEYPAD_GREATER_THAN"},
+        {KeyCode::KEYPAD_AMPERSAND, "KEYPAD_AMPERSAND"},
+        {KeyCode::KEYPAD_DOUBLE_AMPERSAND, "KEYPAD_DOUBLE_AMPERSAND"},
+        {KeyCode::KEYPAD_PIPE, "KEYPAD_PIPE"},
+        {KeyCode::KEYPAD_DOUBLE_PIPE, "KEYPAD_DOUBLE_PIPE"},
+        {KeyCode::KEYPAD_COLON, "KEYPAD_COLON"},
+        {KeyCode::KEYPAD_HASH, "KEYPAD_HASH"},
+        {KeyCode::KEYPAD_SPACE, "KEYPAD_SPACE"},
+        {KeyCode::KEYPAD_AT, "KEYPAD_AT"},
+        {KeyCode::KEYPAD_EXCLAMATION, "KEYPAD_EXCLAMATION"},
+        {KeyCode::KEYPAD_MEMORY_STORE, "KEYPAD_MEMORY_STORE"},
+        {KeyCode::KEYPAD_MEMORY_RECALL, "KEYPAD_MEMORY_RECALL"},
+        {KeyCode::KEYPAD_MEMORY_CLEAR, "KEYPAD_MEMORY_CLEAR"},
+        {KeyCode::KEYPAD_MEMORY_ADD, "KEYPAD_MEMORY_ADD"},
+        {KeyCode::KEYPAD_MEMORY_SUBTRACT, "KEYPAD_MEMORY_SUBTRACT"},
+        {KeyCode::KEYPAD_MEMORY_MULTIPLY, "KEYPAD_MEMORY_MULTIPLY"},
+        {KeyCode::KEYPAD_MEMORY_DIVIDE, "KEYPAD_MEMORY_DIVIDE"},
+        {KeyCode::KEYPAD_PLUS_MINUS, "KEYPAD_PLUS_MINUS"},
+        {KeyCode::KEYPAD_CLEAR, "KEYPAD_CLEAR"},
+        {KeyCode::KEYPAD_CLEAR_ENTRY, "KEYPAD_CLEAR_ENTRY"},
+        {KeyCode::KEYPAD_BINARY, "KEYPAD_BINARY"},
+        {KeyCode::KEYPAD_OCTAL, "KEYPAD_OCTAL"},
+        {KeyCode::KEYPAD_DECIMAL, "KEYPAD_DECIMAL"},
+        {KeyCode::KEYPAD_HEXADECIMAL, "KEYPAD_HEXADECIMAL"},
+        {KeyCode::KEY_LEFT_CTRL, "LEFT_CTRL"},
+        {KeyCode::KEY_LEFT_SHIFT, "LEFT_SHIFT"},
+        {KeyCode::KEY_LEFT_ALT, "LEFT_ALT"},
+        {KeyCode::KEY_LEFT_GUI, "LEFT_GUI"},
+        {KeyCode::KEY_RIGHT_CTRL, "RIGHT_CTRL"},
+        {KeyCode::KEY_RIGHT_SHIFT, "RIGHT_SHIFT"},
+        {KeyCode::KEY_RIGHT_ALT, "RIGHT_ALT"},
+        {KeyCode::KEY_RIGHT_GUI, "RIGHT_GUI"},
+    };
+
+    std::array<std::string_view, 256> names{};
+    for (auto &name : names)
+    {
+        name = "Unknown";
+    }
+    for (const auto &entry : entries)
+    {
+        names[static_cast<uint8_t>(entry.keyCode)] = entry.name;
+    }
+    return names;
+}
+
+/// Key names indexed by usage ID, evaluated at compile time and kept in flash
+constexpr std::array<std::string_view, 256> KEY_NAMES = makeKeyNames();
+}  // namespace
 
 /**
  * @brief Construct a new UsbHidKeyboardReport object.
@@ -13,9 +273,18 @@
  * Initializes the report as a USB HID Keyboard device.
  */
 UsbHidKeyboardReport::UsbHidKeyboardReport()
+    : reportProtocol_(false),
+      usesReportId_(false),
+      reportId_(0),
+      keyFieldCount_(0),
+      keyFields_{},
+      ledState_(0),
+      ledReportId_(0),
+      ledReportSize_(1),
+      ledBitOffsets_{0, 1, 2, 3, 4}
 {
-    // Initialize the report_ data
-    std::memset(&report_, 0, sizeof(KeyboardReportData));
+    // Start with no keys pressed
+    keyState_.clear();
     rawReport_.clear();
 }
 
@@ -30,54 +299,433 @@ void UsbHidKeyboardReport::processReportData(const uint8_t *const data, int leng
     rawReport_.assign(data, data + length);
 
     // Print raw data in hexadecimal format
-    std::string raw;
-    for (int i = 0; i < length; ++i)
+    char raw[RAW_LOG_SIZE];
+    UsbHidFormat::hex(data, length, raw, sizeof(raw));
+    ESP_LOGI("KeyboardReport", "Raw data: %s", raw);
+
+    UsbHidKeyBitset keys;
+
+    if (reportProtocol_)
+    {
+        const uint8_t *payload = data;
+        size_t payloadLength   = length;
+
+        if (usesReportId_)
+        {
+            // Other report IDs on this interface (e.g. media keys) are not keyboard input
+            if (length < 1 || data[0] != reportId_)
+            {
+                return;
+            }
+            ++payload;
+            --payloadLength;
+        }
+
+        if (!decodeReport(payload, payloadLength, keys))
+        {
+            ESP_LOGW("KeyboardReport", "Key rollover error, report ignored");
+            return;
+        }
+    }
+    else
+    {
+        if (length < static_cast<int>(sizeof(KeyboardReportData)))
+        {
+            ESP_LOGW("KeyboardReport", "Invalid report_ data length: %d", length);
+            return;
+        }
+
+        KeyboardReportData report;
+        std::memcpy(&report, data, sizeof(KeyboardReportData));
+
+        // Phantom state: the keyboard cannot tell which keys are down, keep the previous state
+        if (report.key[0] == static_cast<uint8_t>(KeyCode::KEY_ERR_ROLLOVER))
+        {
+            ESP_LOGW("KeyboardReport", "Key rollover error, report ignored");
+            return;
+        }
+
+        keys = decodeBootReport(report);
+    }
+
+    updateKeyState(keys);
+}
+
+/**
+ * @brief Release all held keys and modifiers and stop key repeat.
+ */
+void UsbHidKeyboardReport::releaseAll()
+{
+    if (repeater_)
+    {
+        repeater_->cancel();
+    }
+    updateKeyState(UsbHidKeyBitset());
+    rawReport_.clear();
+}
+
+/**
+ * @brief Decode reports using the layout from a report descriptor.
+ *
+ * @param descriptor The parsed report descriptor of the keyboard interface.
+ * @return true if a keyboard layout was found, false if the boot layout must be used.
+ */
+bool UsbHidKeyboardReport::useReportProtocol(const UsbHidReportDescriptor &descriptor)
+{
+    keyFieldCount_ = 0;
+
+    // Keep the keyboard page fields of the first input report that has any
+    for (const auto &field : descriptor.fields())
+    {
+        if (field.type != UsbHidReportType::Input || field.usagePage != USAGE_PAGE_KEYBOARD)
+        {
+            continue;
+        }
+        if (keyFieldCount_ > 0 && field.reportId != keyFields_[0].reportId)
+        {
+            continue;
+        }
+        if (keyFieldCount_ == MAX_KEY_FIELDS)
+        {
+            break;
+        }
+        keyFields_[keyFieldCount_++] = field;
+    }
+
+    if (keyFieldCount_ == 0)
+    {
+        ESP_LOGW("KeyboardReport", "No keyboard fields in report descriptor");
+        useBootProtocol();
+        return false;
+    }
+
+    reportId_       = keyFields_[0].reportId;
+    usesReportId_   = descriptor.usesReportIds();
+    reportProtocol_ = true;
+
+    // LEDs: bit positions of usages 0x01 - 0x05 in the first output report that has any
+    ledReportSize_ = 0;
+    ledBitOffsets_.fill(-1);
+    for (const auto &field : descriptor.fields())
+    {
+        if (field.type != UsbHidReportType::Output || field.usagePage != USAGE_PAGE_LED || !field.isVariable())
+        {
+            continue;
+        }
+        if (ledReportSize_ > 0 && field.reportId != ledReportId_)
+        {
+            continue;
+        }
+
+        ledReportId_   = field.reportId;
+        ledReportSize_ = descriptor.reportSize(UsbHidReportType::Output, field.reportId);
+        for (uint16_t i = 0; i < field.count; ++i)
+        {
+            const uint32_t usage = field.usageMin + i;
+            if (usage >= 1 && usage <= LED_COUNT)
+            {
+                ledBitOffsets_[usage - 1] = static_cast<int16_t>(field.bitOffset + i * field.bitSize);
+            }
+        }
+    }
+
+    ESP_LOGI("KeyboardReport", "Report protocol: report ID 0x%02X, %u key fields",
+             reportId_, static_cast<unsigned>(keyFieldCount_));
+    return true;
+}
+
+/**
+ * @brief Decode reports using the fixed 8-byte boot layout.
+ */
+void UsbHidKeyboardReport::useBootProtocol()
+{
+    reportProtocol_ = false;
+    usesReportId_   = false;
+    reportId_       = 0;
+    keyFieldCount_  = 0;
+
+    // Boot output report: one byte, LED n in bit n
+    ledReportId_   = 0;
+    ledReportSize_ = 1;
+    for (size_t i = 0; i < LED_COUNT; ++i)
     {
-        char buffer[3];                                                // Each byte to hex requires 2 characters + null terminator
-        sprintf(buffer, "%02X", static_cast<unsigned char>(data[i]));  // Convert byte to hex
-        raw += buffer;
-        raw += " ";  // Add space between bytes for readability
+        ledBitOffsets_[i] = static_cast<int16_t>(i);
     }
-    ESP_LOGI("KeyboardReport", "Raw data: %s", raw.c_str());
+}
 
-    if (length < sizeof(KeyboardReportData))
+/**
+ * @brief Overwrite the lock LED state.
+ *
+ * @param leds Bitmask of Led values.
+ */
+void UsbHidKeyboardReport::setLedState(uint8_t leds)
+{
+    if (leds == ledState_)
     {
-        ESP_LOGW("KeyboardReport", "Invalid report_ data length: %d", length);
-        std::memset(&report_, 0, sizeof(KeyboardReportData));
         return;
     }
+    ledState_ = leds;
+    if (ledCallback_)
+    {
+        ledCallback_(ledState_);
+    }
+}
+
+/**
+ * @brief Toggle the lock LED belonging to a lock key.
+ *
+ * @param keyCode Usage ID of the key that was pressed.
+ * @return true if the key is a lock key.
+ */
+bool UsbHidKeyboardReport::toggleLock(uint8_t keyCode)
+{
+    Led led;
+    switch (static_cast<KeyCode>(keyCode))
+    {
+    case KeyCode::KEY_NUM_LOCK:
+        led = Led::NUM_LOCK;
+        break;
+    case KeyCode::KEY_CAPS_LOCK:
+        led = Led::CAPS_LOCK;
+        break;
+    case KeyCode::KEY_SCROLL_LOCK:
+        led = Led::SCROLL_LOCK;
+        break;
+    default:
+        return false;
+    }
+
+    ledState_ ^= static_cast<uint8_t>(led);
+    return true;
+}
+
+/**
+ * @brief Build the output report that shows an LED state on the keyboard.
+ *
+ * @param leds Bitmask of Led values.
+ * @param buffer Receives the report.
+ * @param size Size of the buffer in bytes.
+ * @param reportId Receives the report ID to send the report with.
+ * @return size_t Length of the report, 0 if the keyboard has no LEDs or the buffer is too small.
+ */
+size_t UsbHidKeyboardReport::buildLedReport(uint8_t leds, uint8_t *buffer, size_t size, uint8_t &reportId) const
+{
+    const size_t prefix = ledReportId_ != 0 ? 1 : 0;
+    const size_t length = prefix + ledReportSize_;
+    if (ledReportSize_ == 0 || length > size)
+    {
+        return 0;
+    }
 
-    KeyboardReportData newReport;
-    std::memcpy(&newReport, data, sizeof(KeyboardReportData));
+    std::memset(buffer, 0, length);
+    if (prefix)
+    {
+        buffer[0] = ledReportId_;
+    }
 
-    if (memcmp(&newReport, &report_, sizeof(KeyboardReportData)) != 0)
+    uint8_t *payload = buffer + prefix;
+    for (size_t i = 0; i < LED_COUNT; ++i)
+    {
+        const int16_t bit = ledBitOffsets_[i];
+        if (bit >= 0 && (leds & (1u << i)))
+        {
+            payload[bit / 8] |= 1u << (bit % 8);
+        }
+    }
+
+    reportId = ledReportId_;
+    return length;
+}
+
+/**
+ * @brief Decode a report protocol payload into a key state.
+ *
+ * @param payload Report data, not including the report ID byte.
+ * @param length Length of the payload in bytes.
+ * @param keys Receives the decoded key state.
+ * @return true on success, false if the keyboard reported a rollover error.
+ */
+bool UsbHidKeyboardReport::decodeReport(const uint8_t *payload, size_t length, UsbHidKeyBitset &keys) const
+{
+    for (size_t f = 0; f < keyFieldCount_; ++f)
     {
-        report_ = newReport;
+        const UsbHidReportField &field = keyFields_[f];
 
-        triggerEvent(createEvent());
+        if (field.isVariable() && field.bitSize == 1 && (field.bitOffset % 8) == 0)
+        {
+            // Byte aligned bitmap: walk whole bytes and only visit the bits that are set
+            const size_t first = field.bitOffset / 8;
+            for (uint16_t i = 0; i < field.count && first + i / 8 < length; i += 8)
+            {
+                uint32_t bits = payload[first + i / 8];
+                if (field.count - i < 8)
+                {
+                    bits &= (1u << (field.count - i)) - 1;
+                }
+                while (bits != 0)
+                {
+                    keys.set(field.usageMin + i + __builtin_ctz(bits));
+                    bits &= bits - 1;
+                }
+            }
+        }
+        else if (field.isVariable())
+        {
+            for (uint16_t i = 0; i < field.count; ++i)
+            {
+                if (field.extract(payload, length, i) != 0)
+                {
+                    keys.set(field.usageMin + i);
+                }
+            }
+        }
+        else
+        {
+            // Array: every slot holds one usage, offset by the logical minimum
+            for (uint16_t i = 0; i < field.count; ++i)
+            {
+                const int32_t value = field.extract(payload, length, i);
+                if (value < field.logicalMin || value > field.logicalMax)
+                {
+                    continue;
+                }
+
+                const uint32_t usage = field.usageMin + static_cast<uint32_t>(value - field.logicalMin);
+                if (usage == static_cast<uint8_t>(KeyCode::KEY_ERR_ROLLOVER))
+                {
+                    return false;
+                }
+                if (usage > static_cast<uint8_t>(KeyCode::KEY_ERR_UNDEFINED))
+                {
+                    keys.set(usage);
+                }
+            }
+        }
     }
+    return true;
 }
 
 /**
- * @brief Create a UsbHidKeyboardEvent based on the current report_ state.
+ * @brief Decode a boot protocol report into a key state.
  *
- * @return UsbHidKeyboardEvent The created event.
+ * @param report The boot protocol report.
+ * @return UsbHidKeyBitset The decoded key state.
  */
-UsbHidKeyboardEvent UsbHidKeyboardReport::createEvent() const
+UsbHidKeyBitset UsbHidKeyboardReport::decodeBootReport(const KeyboardReportData &report)
 {
-    UsbHidKeyboardEvent event;
-    event.modifiers = report_.modifier.val;
+    UsbHidKeyBitset keys;
+
+    // Modifier byte maps one-to-one onto usages 0xE0 - 0xE7
+    keys.setWord(MODIFIER_USAGE_BASE / UsbHidKeyBitset::WORD_BITS, report.modifier.val);
 
-    event.keyCodes.reserve(MAX_KEYS);
     for (int i = 0; i < MAX_KEYS; ++i)
     {
-        if (report_.key[i] != static_cast<uint8_t>(KeyCode::KEY_NONE))
+        // Usages 0x00 - 0x03 are "no event" and error codes, not keys
+        if (report.key[i] > static_cast<uint8_t>(KeyCode::KEY_ERR_UNDEFINED))
         {
-            event.keyCodes.push_back(report_.key[i]);
-            ESP_LOGI("KeyboardReport", "Size %d | Key: 0x%02X", event.keyCodes.size(), event.keyCodes.back());
-            // event.keyCodes[i] = report_.key[i];
+            keys.set(report.key[i]);
         }
     }
+    return keys;
+}
+
+/**
+ * @brief Step the key state towards @p next, firing an event for every bit that changed.
+ *
+ * @param next The new key state.
+ */
+void UsbHidKeyboardReport::updateKeyState(const UsbHidKeyBitset &next)
+{
+    const UsbHidKeyBitset changed = keyState_ ^ next;
+    if (!changed.any())
+    {
+        return;
+    }
+
+    const UsbHidKeyBitset released = changed & keyState_;
+    const UsbHidKeyBitset pressed  = changed & next;
+
+    // The state is stepped one edge at a time so each event and any state
+    // queried from its callback reflect the keys held after that edge only
+    auto fireEdge = [this](size_t keyCode, bool down)
+    {
+        if (down)
+        {
+            keyState_.set(keyCode);
+        }
+        else
+        {
+            keyState_.reset(keyCode);
+        }
+
+        // Lock keys toggle on key-down, the event already carries the new state
+        const bool ledsChanged = down && toggleLock(static_cast<uint8_t>(keyCode));
+
+        triggerEvent(createKeyEvent(static_cast<uint8_t>(keyCode), down));
+        if (repeater_)
+        {
+            repeater_->onKey(static_cast<uint8_t>(keyCode), down);
+        }
+        if (ledsChanged && ledCallback_)
+        {
+            ledCallback_(ledState_);
+        }
+    };
+
+    released.forEachSet([&fireEdge](size_t keyCode)
+                        { fireEdge(keyCode, false); });
+    pressed.forEachSet([&fireEdge](size_t keyCode)
+                       { fireEdge(keyCode, true); });
+}
+
+/**
+ * @brief Generate typematic repeats for held keys.
+ *
+ * @param wheel Timer wheel driving the repeats.
+ * @param config Typematic delay and rate.
+ */
+void UsbHidKeyboardReport::enableKeyRepeat(UsbHidTimerWheel &wheel, const UsbHidKeyRepeater::Config &config)
+{
+    repeater_ = std::make_unique<UsbHidKeyRepeater>(wheel, config, [this](uint8_t keyCode)
+                                                    {
+                                                        UsbHidKeyboardEvent event = createKeyEvent(keyCode, true);
+                                                        event.repeat              = true;
+                                                        triggerEvent(event); });
+}
+
+/**
+ * @brief Stop generating typematic repeats.
+ */
+void UsbHidKeyboardReport::disableKeyRepeat()
+{
+    repeater_.reset();
+}
+
+/**
+ * @brief Create a UsbHidKeyboardEvent based on the current key state.
+ *
+ * @return UsbHidKeyboardEvent The created event.
+ */
+UsbHidKeyboardEvent UsbHidKeyboardReport::createEvent() const
+{
+    UsbHidKeyboardEvent event;
+    event.modifiers = getModifiers();
+    event.leds      = ledState_;
+    return event;
+}
+
+/**
+ * @brief Create a UsbHidKeyboardEvent for a single key edge.
+ *
+ * @param keyCode Usage ID of the key that changed state.
+ * @param pressed true on key-down, false on key-up.
+ * @return UsbHidKeyboardEvent The created event.
+ */
+UsbHidKeyboardEvent UsbHidKeyboardReport::createKeyEvent(uint8_t keyCode, bool pressed) const
+{
+    UsbHidKeyboardEvent event = createEvent();
+    event.keyCode             = keyCode;
+    event.pressed             = pressed;
     return event;
 }
 
@@ -89,7 +737,7 @@ UsbHidKeyboardEvent UsbHidKeyboardReport::createEvent() const
  */
 bool UsbHidKeyboardReport::isModifierActive(Modifier modifier) const
 {
-    return (report_.modifier.val & static_cast<uint8_t>(modifier)) != 0;
+    return (getModifiers() & static_cast<uint8_t>(modifier)) != 0;
 }
 
 /**
@@ -99,24 +747,23 @@ bool UsbHidKeyboardReport::isModifierActive(Modifier modifier) const
  */
 uint8_t UsbHidKeyboardReport::getModifiers() const
 {
-    return report_.modifier.val;
+    return static_cast<uint8_t>(keyState_.word(MODIFIER_USAGE_BASE / UsbHidKeyBitset::WORD_BITS));
 }
 
 /**
- * @brief Get a list of currently pressed keys.
+ * @brief Get a list of currently pressed keys, excluding modifiers.
  *
  * @return std::vector<UsbHidKeyboardReport::KeyCode> The list of pressed keys.
  */
 std::vector<UsbHidKeyboardReport::KeyCode> UsbHidKeyboardReport::getPressedKeys() const
 {
     std::vector<KeyCode> pressedKeys;
-    for (int i = 0; i < MAX_KEYS; ++i)
-    {
-        if (report_.key[i] != static_cast<uint8_t>(KeyCode::KEY_NONE))
-        {
-            pressedKeys.push_back(static_cast<KeyCode>(report_.key[i]));
-        }
-    }
+    keyState_.forEachSet([&pressedKeys](size_t keyCode)
+                         {
+                             if (keyCode < MODIFIER_USAGE_BASE)
+                             {
+                                 pressedKeys.push_back(static_cast<KeyCode>(keyCode));
+                             } });
     return pressedKeys;
 }
 
@@ -124,12 +771,11 @@ std::vector<UsbHidKeyboardReport::KeyCode> UsbHidKeyboardReport::getPressedKeys(
  * @brief Get the name of a specific key code.
  *
  * @param keyCode The key code to get the name for.
- * @return std::string The name of the key.
+ * @return std::string_view The name of the key, "Unknown" for reserved usages.
  */
-std::string UsbHidKeyboardReport::getKeyName(KeyCode keyCode)
+std::string_view UsbHidKeyboardReport::getKeyName(KeyCode keyCode)
 {
-    auto it = keyNameMap.find(keyCode);
-    return it != keyNameMap.end() ? it->second : "Unknown";
+    return KEY_NAMES[static_cast<uint8_t>(keyCode)];
 }
 
 /**
@@ -139,14 +785,9 @@ std::string UsbHidKeyboardReport::getKeyName(KeyCode keyCode)
  */
 std::string UsbHidKeyboardReport::getPressedKeyNames() const
 {
-    std::stringstream ss;
-    auto pressedKeys = getPressedKeys();
-    for (const auto &key : pressedKeys)
-    {
-        if (!ss.str().empty()) ss << ", ";
-        ss << getKeyName(key);
-    }
-    return ss.str().empty() ? "NONE" : ss.str();
+    char buffer[NAME_BUFFER_SIZE];
+    formatPressedKeyNames(buffer, sizeof(buffer));
+    return buffer;
 }
 
 /**
@@ -156,7 +797,7 @@ std::string UsbHidKeyboardReport::getPressedKeyNames() const
  */
 std::string UsbHidKeyboardReport::getActiveModifierNames() const
 {
-    return getModifierNames(report_.modifier.val);
+    return getModifierNames(getModifiers());
 }
 
 /**
@@ -167,238 +808,55 @@ std::string UsbHidKeyboardReport::getActiveModifierNames() const
  */
 std::string UsbHidKeyboardReport::getModifierNames(uint8_t modifiers)
 {
-    std::stringstream ss;
-    if (modifiers & static_cast<uint8_t>(Modifier::LEFT_CTRL)) ss << "LEFT_CTRL ";
-    if (modifiers & static_cast<uint8_t>(Modifier::LEFT_SHIFT)) ss << "LEFT_SHIFT ";
-    if (modifiers & static_cast<uint8_t>(Modifier::LEFT_ALT)) ss << "LEFT_ALT ";
-    if (modifiers & static_cast<uint8_t>(Modifier::LEFT_GUI)) ss << "LEFT_GUI ";
-    if (modifiers & static_cast<uint8_t>(Modifier::RIGHT_CTRL)) ss << "RIGHT_CTRL ";
-    if (modifiers & static_cast<uint8_t>(Modifier::RIGHT_SHIFT)) ss << "RIGHT_SHIFT ";
-    if (modifiers & static_cast<uint8_t>(Modifier::RIGHT_ALT)) ss << "RIGHT_ALT ";
-    if (modifiers & static_cast<uint8_t>(Modifier::RIGHT_GUI)) ss << "RIGHT_GUI ";
-
-    std::string result = ss.str();
-    return result.empty() ? "NONE" : result;
+    char buffer[NAME_BUFFER_SIZE];
+    formatModifierNames(modifiers, buffer, sizeof(buffer));
+    return buffer;
+}
+
+/**
+ * @brief Write a space-separated list of modifier names from a bitmask into a buffer.
+ *
+ * @param modifiers The modifier bitmask.
+ * @param buffer Destination buffer.
+ * @param size Size of the buffer in bytes.
+ * @return size_t Number of characters written, not counting the terminating NUL.
+ */
+size_t UsbHidKeyboardReport::formatModifierNames(uint8_t modifiers, char *buffer, size_t size)
+{
+    if (modifiers == 0)
+    {
+        return UsbHidFormat::append(buffer, size, 0, "NONE");
+    }
+
+    size_t pos = 0;
+    for (uint8_t bit = 0; bit < 8; ++bit)
+    {
+        if (modifiers & (1u << bit))
+        {
+            if (pos != 0) pos = UsbHidFormat::append(buffer, size, pos, " ");
+            pos = UsbHidFormat::append(buffer, size, pos, KEY_NAMES[MODIFIER_USAGE_BASE + bit]);
+        }
+    }
+    return pos;
 }
 
-// Key name map definition
-const std::unordered_map<UsbHidKeyboardReport::KeyCode, std::string> UsbHidKeyboardReport::keyNameMap = {
-    {KeyCode::KEY_NONE, "NONE"},
-    {KeyCode::KEY_ERR_ROLLOVER, "ERR_ROLLOVER"},
-    {KeyCode::KEY_POST_FAIL, "POST_FAIL"},
-    {KeyCode::KEY_ERR_UNDEFINED, "ERR_UNDEFINED"},
-    {KeyCode::KEY_A, "A"},
-    {KeyCode::KEY_B, "B"},
-    {KeyCode::KEY_C, "C"},
-    {KeyCode::KEY_D, "D"},
-    {KeyCode::KEY_E, "E"},
-    {KeyCode::KEY_F, "F"},
-    {KeyCode::KEY_G, "G"},
-    {KeyCode::KEY_H, "H"},
-    {KeyCode::KEY_I, "I"},
-    {KeyCode::KEY_J, "J"},
-    {KeyCode::KEY_K, "K"},
-    {KeyCode::KEY_L, "L"},
-    {KeyCode::KEY_M, "M"},
-    {KeyCode::KEY_N, "N"},
-    {KeyCode::KEY_O, "O"},
-    {KeyCode::KEY_P, "P"},
-    {KeyCode::KEY_Q, "Q"},
-    {KeyCode::KEY_R, "R"},
-    {KeyCode::KEY_S, "S"},
-    {KeyCode::KEY_T, "T"},
-    {KeyCode::KEY_U, "U"},
-    {KeyCode::KEY_V, "V"},
-    {KeyCode::KEY_W, "W"},
-    {KeyCode::KEY_X, "X"},
-    {KeyCode::KEY_Y, "Y"},
-    {KeyCode::KEY_Z, "Z"},
-    {KeyCode::KEY_1, "1"},
-    {KeyCode::KEY_2, "2"},
-    {KeyCode::KEY_3, "3"},
-    {KeyCode::KEY_4, "4"},
-    {KeyCode::KEY_5, "5"},
-    {KeyCode::KEY_6, "6"},
-    {KeyCode::KEY_7, "7"},
-    {KeyCode::KEY_8, "8"},
-    {KeyCode::KEY_9, "9"},
-    {KeyCode::KEY_0, "0"},
-    {KeyCode::KEY_ENTER, "ENTER"},
-    {KeyCode::KEY_ESC, "ESC"},
-    {KeyCode::KEY_BACKSPACE, "BACKSPACE"},
-    {KeyCode::KEY_TAB, "TAB"},
-    {KeyCode::KEY_SPACE, "SPACE"},
-    {KeyCode::KEY_MINUS, "MINUS"},
-    {KeyCode::KEY_EQUAL, "EQUAL"},
-    {KeyCode::KEY_BRACKET_LEFT, "BRACKET_LEFT"},
-    {KeyCode::KEY_BRACKET_RIGHT, "BRACKET_RIGHT"},
-    {KeyCode::KEY_BACKSLASH, "BACKSLASH"},
-    {KeyCode::KEY_HASHTAG, "HASHTAG"},
-    {KeyCode::KEY_SEMICOLON, "SEMICOLON"},
-    {KeyCode::KEY_QUOTE, "QUOTE"},
-    {KeyCode::KEY_TILDE, "TILDE"},
-    {KeyCode::KEY_COMMA, "COMMA"},
-    {KeyCode::KEY_DOT, "DOT"},
-    {KeyCode::KEY_SLASH, "SLASH"},
-    {KeyCode::KEY_CAPS_LOCK, "CAPS_LOCK"},
-    {KeyCode::KEY_F1, "F1"},
-    {KeyCode::KEY_F2, "F2"},
-    {KeyCode::KEY_F3, "F3"},
-    {KeyCode::KEY_F4, "F4"},
-    {KeyCode::KEY_F5, "F5"},
-    {KeyCode::KEY_F6, "F6"},
-    {KeyCode::KEY_F7, "F7"},
-    {KeyCode::KEY_F8, "F8"},
-    {KeyCode::KEY_F9, "F9"},
-    {KeyCode::KEY_F10, "F10"},
-    {KeyCode::KEY_F11, "F11"},
-    {KeyCode::KEY_F12, "F12"},
-    {KeyCode::KEY_PRINTSCREEN, "PRINTSCREEN"},
-    {KeyCode::KEY_SCROLL_LOCK, "SCROLL_LOCK"},
-    {KeyCode::KEY_PAUSE, "PAUSE"},
-    {KeyCode::KEY_INSERT, "INSERT"},
-    {KeyCode::KEY_HOME, "HOME"},
-    {KeyCode::KEY_PAGE_UP, "PAGE_UP"},
-    {KeyCode::KEY_DELETE, "DELETE"},
-    {KeyCode::KEY_END, "END"},
-    {KeyCode::KEY_PAGE_DOWN, "PAGE_DOWN"},
-    {KeyCode::KEY_ARROW_RIGHT, "ARROW_RIGHT"},
-    {KeyCode::KEY_ARROW_LEFT, "ARROW_LEFT"},
-    {KeyCode::KEY_ARROW_DOWN, "ARROW_DOWN"},
-    {KeyCode::KEY_ARROW_UP, "ARROW_UP"},
-    {KeyCode::KEY_NUM_LOCK, "NUM_LOCK"},
-    {KeyCode::KEYPAD_SLASH, "KEYPAD_SLASH"},
-    {KeyCode::KEYPAD_ASTERISK, "KEYPAD_ASTERISK"},
-    {KeyCode::KEYPAD_MINUS, "KEYPAD_MINUS"},
-    {KeyCode::KEYPAD_PLUS, "KEYPAD_PLUS"},
-    {KeyCode::KEYPAD_ENTER, "KEYPAD_ENTER"},
-    {KeyCode::KEYPAD_1, "KEYPAD_1"},
-    {KeyCode::KEYPAD_2, "KEYPAD_2"},
-    {KeyCode::KEYPAD_3, "KEYPAD_3"},
-    {KeyCode::KEYPAD_4, "KEYPAD_4"},
-    {KeyCode::KEYPAD_5, "KEYPAD_5"},
-    {KeyCode::KEYPAD_6, "KEYPAD_6"},
-    {KeyCode::KEYPAD_7, "KEYPAD_7"},
-    {KeyCode::KEYPAD_8, "KEYPAD_8"},
-    {KeyCode::KEYPAD_9, "KEYPAD_9"},
-    {KeyCode::KEYPAD_0, "KEYPAD_0"},
-    {KeyCode::KEYPAD_DOT, "KEYPAD_DOT"},
-    {KeyCode::KEY_NON_US_HASH, "NON_US_HASH"},
-    {KeyCode::KEY_APPLICATION, "APPLICATION"},
-    {KeyCode::KEY_POWER, "POWER"},
-    {KeyCode::KEYPAD_EQUAL, "KEYPAD_EQUAL"},
-    {KeyCode::KEY_F13, "F13"},
-    {KeyCode::KEY_F14, "F14"},
-    {KeyCode::KEY_F15, "F15"},
-    {KeyCode::KEY_F16, "F16"},
-    {KeyCode::KEY_F17, "F17"},
-    {KeyCode::KEY_F18, "F18"},
-    {KeyCode::KEY_F19, "F19"},
-    {KeyCode::KEY_F20, "F20"},
-    {KeyCode::KEY_F21, "F21"},
-    {KeyCode::KEY_F22, "F22"},
-    {KeyCode::KEY_F23, "F23"},
-    {KeyCode::KEY_F24, "F24"},
-    {KeyCode::KEY_EXECUTE, "EXECUTE"},
-    {KeyCode::KEY_HELP, "HELP"},
-    {KeyCode::KEY_MENU, "MENU"},
-    {KeyCode::KEY_SELECT, "SELECT"},
-    {KeyCode::KEY_STOP, "STOP"},
-    {KeyCode::KEY_AGAIN, "AGAIN"},
-    {KeyCode::KEY_UNDO, "UNDO"},
-    {KeyCode::KEY_CUT, "CUT"},
-    {KeyCode::KEY_COPY, "COPY"},
-    {KeyCode::KEY_PASTE, "PASTE"},
-    {KeyCode::KEY_FIND, "FIND"},
-    {KeyCode::KEY_MUTE, "MUTE"},
-    {KeyCode::KEY_VOLUME_UP, "VOLUME_UP"},
-    {KeyCode::KEY_VOLUME_DOWN, "VOLUME_DOWN"},
-    {KeyCode::KEY_LOCKING_CAPS, "LOCKING_CAPS"},
-    {KeyCode::KEY_LOCKING_NUM, "LOCKING_NUM"},
-    {KeyCode::KEY_LOCKING_SCROLL, "LOCKING_SCROLL"},
-    {KeyCode::KEYPAD_COMMA, "KEYPAD_COMMA"},
-    {KeyCode::KEYPAD_EQUAL_SIGN, "KEYPAD_EQUAL_SIGN"},
-    {KeyCode::KEY_INTERNATIONAL_1, "INTERNATIONAL_1"},
-    {KeyCode::KEY_INTERNATIONAL_2, "INTERNATIONAL_2"},
-    {KeyCode::KEY_INTERNATIONAL_3, "INTERNATIONAL_3"},
-    {KeyCode::KEY_INTERNATIONAL_4, "INTERNATIONAL_4"},
-    {KeyCode::KEY_INTERNATIONAL_5, "INTERNATIONAL_5"},
-    {KeyCode::KEY_INTERNATIONAL_6, "INTERNATIONAL_6"},
-    {KeyCode::KEY_INTERNATIONAL_7, "INTERNATIONAL_7"},
-    {KeyCode::KEY_INTERNATIONAL_8, "INTERNATIONAL_8"},
-    {KeyCode::KEY_INTERNATIONAL_9, "INTERNATIONAL_9"},
-    {KeyCode::KEY_LANG_1, "LANG_1"},
-    {KeyCode::KEY_LANG_2, "LANG_2"},
-    {KeyCode::KEY_LANG_3, "LANG_3"},
-    {KeyCode::KEY_LANG_4, "LANG_4"},
-    {KeyCode::KEY_LANG_5, "LANG_5"},
-    {KeyCode::KEY_LANG_6, "LANG_6"},
-    {KeyCode::KEY_LANG_7, "LANG_7"},
-    {KeyCode::KEY_LANG_8, "LANG_8"},
-    {KeyCode::KEY_LANG_9, "LANG_9"},
-    {KeyCode::KEY_ALTERNATE_ERASE, "ALTERNATE_ERASE"},
-    {KeyCode::KEY_SYSREQ, "SYSREQ"},
-    {KeyCode::KEY_CANCEL, "CANCEL"},
-    {KeyCode::KEY_CLEAR, "CLEAR"},
-    {KeyCode::KEY_PRIOR, "PRIOR"},
-    {KeyCode::KEY_RETURN, "RETURN"},
-    {KeyCode::KEY_SEPARATOR, "SEPARATOR"},
-    {KeyCode::KEY_OUT, "OUT"},
-    {KeyCode::KEY_OPER, "OPER"},
-    {KeyCode::KEY_CLEAR_AGAIN, "CLEAR_AGAIN"},
-    {KeyCode::KEY_CRSEL, "CRSEL"},
-    {KeyCode::KEY_EXSEL, "EXSEL"},
-    {KeyCode::KEYPAD_00, "KEYPAD_00"},
-    {KeyCode::KEYPAD_000, "KEYPAD_000"},
-    {KeyCode::THOUSANDS_SEPARATOR, "THOUSANDS_SEPARATOR"},
-    {KeyCode::DECIMAL_SEPARATOR, "DECIMAL_SEPARATOR"},
-    {KeyCode::CURRENCY_UNIT, "CURRENCY_UNIT"},
-    {KeyCode::CURRENCY_SUBUNIT, "CURRENCY_SUBUNIT"},
-    {KeyCode::KEYPAD_PARENTHESIS_LEFT, "KEYPAD_PARENTHESIS_LEFT"},
-    {KeyCode::KEYPAD_PARENTHESIS_RIGHT, "KEYPAD_PARENTHESIS_RIGHT"},
-    {KeyCode::KEYPAD_BRACE_LEFT, "KEYPAD_BRACE_LEFT"},
-    {KeyCode::KEYPAD_BRACE_RIGHT, "KEYPAD_BRACE_RIGHT"},
-    {KeyCode::KEYPAD_TAB, "KEYPAD_TAB"},
-    {KeyCode::KEYPAD_BACKSPACE, "KEYPAD_BACKSPACE"},
-    {KeyCode::KEYPAD_A, "KEYPAD_A"},
-    {KeyCode::KEYPAD_B, "KEYPAD_B"},
-    {KeyCode::KEYPAD_C, "KEYPAD_C"},
-    {KeyCode::KEYPAD_D, "KEYPAD_D"},
-    {KeyCode::KEYPAD_E, "KEYPAD_E"},
-    {KeyCode::KEYPAD_F, "KEYPAD_F"},
-    {KeyCode::KEYPAD_XOR, "KEYPAD_XOR"},
-    {KeyCode::KEYPAD_CARET, "KEYPAD_CARET"},
-    {KeyCode::KEYPAD_PERCENT, "KEYPAD_PERCENT"},
-    {KeyCode::KEYPAD_LESS_THAN, "KEYPAD_LESS_THAN"},
-    {KeyCode::KEYPAD_GREATER_THAN, "KEYPAD_GREATER_THAN"},
-    {KeyCode::KEYPAD_AMPERSAND, "KEYPAD_AMPERSAND"},
-    {KeyCode::KEYPAD_DOUBLE_AMPERSAND, "KEYPAD_DOUBLE_AMPERSAND"},
-    {KeyCode::KEYPAD_PIPE, "KEYPAD_PIPE"},
-    {KeyCode::KEYPAD_DOUBLE_PIPE, "KEYPAD_DOUBLE_PIPE"},
-    {KeyCode::KEYPAD_COLON, "KEYPAD_COLON"},
-    {KeyCode::KEYPAD_HASH, "KEYPAD_HASH"},
-    {KeyCode::KEYPAD_SPACE, "KEYPAD_SPACE"},
-    {KeyCode::KEYPAD_AT, "KEYPAD_AT"},
-    {KeyCode::KEYPAD_EXCLAMATION, "KEYPAD_EXCLAMATION"},
-    {KeyCode::KEYPAD_MEMORY_STORE, "KEYPAD_MEMORY_STORE"},
-    {KeyCode::KEYPAD_MEMORY_RECALL, "KEYPAD_MEMORY_RECALL"},
-    {KeyCode::KEYPAD_MEMORY_CLEAR, "KEYPAD_MEMORY_CLEAR"},
-    {KeyCode::KEYPAD_MEMORY_ADD, "KEYPAD_MEMORY_ADD"},
-    {KeyCode::KEYPAD_MEMORY_SUBTRACT, "KEYPAD_MEMORY_SUBTRACT"},
-    {KeyCode::KEYPAD_MEMORY_MULTIPLY, "KEYPAD_MEMORY_MULTIPLY"},
-    {KeyCode::KEYPAD_MEMORY_DIVIDE, "KEYPAD_MEMORY_DIVIDE"},
-    {KeyCode::KEYPAD_PLUS_MINUS, "KEYPAD_PLUS_MINUS"},
-    {KeyCode::KEYPAD_CLEAR, "KEYPAD_CLEAR"},
-    {KeyCode::KEYPAD_CLEAR_ENTRY, "KEYPAD_CLEAR_ENTRY"},
-    {KeyCode::KEYPAD_BINARY, "KEYPAD_BINARY"},
-    {KeyCode::KEYPAD_OCTAL, "KEYPAD_OCTAL"},
-    {KeyCode::KEYPAD_DECIMAL, "KEYPAD_DECIMAL"},
-    {KeyCode::KEYPAD_HEXADECIMAL, "KEYPAD_HEXADECIMAL"},
-    {KeyCode::KEY_LEFT_CTRL, "LEFT_CTRL"},
-    {KeyCode::KEY_LEFT_SHIFT, "LEFT_SHIFT"},
-    {KeyCode::KEY_LEFT_ALT, "LEFT_ALT"},
-    {KeyCode::KEY_LEFT_GUI, "LEFT_GUI"},
-    {KeyCode::KEY_RIGHT_CTRL, "RIGHT_CTRL"},
-    {KeyCode::KEY_RIGHT_SHIFT, "RIGHT_SHIFT"},
-    {KeyCode::KEY_RIGHT_ALT, "RIGHT_ALT"},
-    {KeyCode::KEY_RIGHT_GUI, "RIGHT_GUI"}};
\ No newline at end of file
+/**
+ * @brief Write a comma-separated list of currently pressed key names into a buffer.
+ *
+ * @param buffer Destination buffer.
+ * @param size Size of the buffer in bytes.
+ * @return size_t Number of characters written, not counting the terminating NUL.
+ */
+size_t UsbHidKeyboardReport::formatPressedKeyNames(char *buffer, size_t size) const
+{
+    size_t pos  = 0;
+    bool any    = false;
+    keyState_.forEachSet([&](size_t keyCode)
+                         {
+                             if (keyCode >= MODIFIER_USAGE_BASE) return;
+                             if (any) pos = UsbHidFormat::append(buffer, size, pos, ", ");
+                             pos = UsbHidFormat::append(buffer, size, pos, KEY_NAMES[keyCode]);
+                             any = true; });
+
+    return any ? pos : UsbHidFormat::append(buffer, size, 0, "NONE");
+}
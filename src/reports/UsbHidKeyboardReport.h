@@ -6,24 +6,34 @@
 #pragma once
 
 #include "UsbHidBaseReport.h"
+#include "UsbHidBitset.h"
+#include "UsbHidKeyRepeater.h"
+#include "UsbHidReportDescriptor.h"
+#include <array>
 #include <cstdint>
+#include <memory>
 #include <vector>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 
 #include "esp_log.h"
 
 /**
  * @struct UsbHidKeyboardEvent
- * @brief Represents a keyboard event with pressed keys and modifiers.
+ * @brief Represents a single key-down or key-up edge.
+ *
+ * Modifier keys produce their own edges using the usage IDs 0xE0 - 0xE7.
  */
 struct UsbHidKeyboardEvent
 {
-    UsbHidDeviceType deviceType_;   ///< Type of the USB HID device
-    uint8_t modifiers;              ///< Bitmask of active modifiers
-    std::vector<uint8_t> keyCodes;  ///< List of pressed key codes
+    UsbHidDeviceType deviceType_;  ///< Type of the USB HID device
+    uint8_t keyCode;               ///< Usage ID of the key that changed state
+    bool pressed;                  ///< true on key-down, false on key-up
+    bool repeat;                   ///< true if this key-down was generated by typematic repeat
+    uint8_t modifiers;             ///< Bitmask of active modifiers after this edge
+    uint8_t leds;                  ///< Bitmask of lock LEDs after this edge, see UsbHidKeyboardReport::Led
 
-    UsbHidKeyboardEvent() : deviceType_(UsbHidDeviceType::Keyboard), modifiers(0), keyCodes() {}
+    UsbHidKeyboardEvent() : deviceType_(UsbHidDeviceType::Keyboard), keyCode(0), pressed(false), repeat(false), modifiers(0), leds(0) {}
 };
 
 /**
@@ -31,15 +41,30 @@ struct UsbHidKeyboardEvent
  * @brief Handles processing and interpretation of USB HID keyboard reports.
  *
  * This class extends UsbHidBaseReport to provide specific functionality for keyboard devices.
- * It processes raw HID reports, tracks key states, and provides methods to query
- * the current keyboard state.
+ * Each report is decoded into a 256-bit key state, one bit per usage ID, and compared
+ * against the previous state. A callback is fired for every key and modifier that was
+ * pressed or released, releases first. The modifiers and LEDs carried by each event are
+ * the state after that single edge, not after the whole report.
+ *
+ * Reports are decoded from the 8-byte boot layout by default. After useReportProtocol()
+ * the layout is taken from the keyboard's report descriptor instead, which allows
+ * N-key-rollover keyboards that report keys as a bitmap.
+ *
+ * With enableKeyRepeat() a held key also produces repeated key-down events with
+ * the repeat flag set.
  */
 class UsbHidKeyboardReport : public UsbHidBaseReport<UsbHidKeyboardEvent, UsbHidDeviceType::Keyboard>
 {
 public:
-    /// Maximum number of keys that can be pressed simultaneously
+    /// Maximum number of keys that can be pressed simultaneously in boot protocol
     static constexpr int MAX_KEYS = 6;
 
+    /// HID usage page of keyboard keys
+    static constexpr uint16_t USAGE_PAGE_KEYBOARD = 0x07;
+
+    /// Buffer size used by the std::string name helpers
+    static constexpr size_t NAME_BUFFER_SIZE = 256;
+
     /**
      * @enum Modifier
      * @brief Enumeration of keyboard modifier keys.
@@ -56,6 +81,31 @@ public:
         RIGHT_GUI   = 1 << 7
     };
 
+    /**
+     * @enum Led
+     * @brief Keyboard LEDs, in the bit order of the boot output report.
+     */
+    enum class Led : uint8_t
+    {
+        NUM_LOCK    = 1 << 0,
+        CAPS_LOCK   = 1 << 1,
+        SCROLL_LOCK = 1 << 2,
+        COMPOSE     = 1 << 3,
+        KANA        = 1 << 4
+    };
+
+    /// HID usage page of keyboard LEDs
+    static constexpr uint16_t USAGE_PAGE_LED = 0x08;
+
+    /// Largest LED output report built by buildLedReport(), report ID included
+    static constexpr size_t MAX_LED_REPORT_SIZE = 8;
+
+    /**
+     * @typedef LedCallback
+     * @brief Function called when the lock LED state changes.
+     */
+    using LedCallback = std::function<void(uint8_t leds)>;
+
     /**
      * @enum KeyCode
      * @brief Enumeration of keyboard key codes as per USB HID specification.
@@ -296,6 +346,88 @@ public:
      */
     void processReportData(const uint8_t *const data, int length) override;
 
+    /**
+     * @brief Release all held keys and modifiers and stop key repeat.
+     *
+     * Fires a key-up event for every key that is down. The lock LED state is kept,
+     * it belongs to the host.
+     */
+    void releaseAll() override;
+
+    /**
+     * @brief Decode reports using the layout from a report descriptor.
+     *
+     * Looks for keyboard page fields in the descriptor's input reports, both bitmap
+     * (variable, one bit per key) and array (one usage per slot) encodings.
+     *
+     * @param descriptor The parsed report descriptor of the keyboard interface.
+     * @return true if a keyboard layout was found, false if the boot layout must be used.
+     */
+    bool useReportProtocol(const UsbHidReportDescriptor &descriptor);
+
+    /**
+     * @brief Decode reports using the fixed 8-byte boot layout.
+     */
+    void useBootProtocol();
+
+    /**
+     * @brief Check whether reports are decoded using a report descriptor layout.
+     */
+    bool isReportProtocol() const { return reportProtocol_; }
+
+    /**
+     * @brief Get the report ID of the keyboard input report, 0 if reports carry no ID.
+     */
+    uint8_t getInputReportId() const { return usesReportId_ ? reportId_ : 0; }
+
+    /**
+     * @brief Generate typematic repeats for held keys.
+     *
+     * @param wheel Timer wheel driving the repeats. Must outlive the report or disableKeyRepeat().
+     * @param config Typematic delay and rate.
+     */
+    void enableKeyRepeat(UsbHidTimerWheel &wheel, const UsbHidKeyRepeater::Config &config);
+
+    /**
+     * @brief Stop generating typematic repeats.
+     */
+    void disableKeyRepeat();
+
+    /**
+     * @brief Get the lock LED state, maintained from Caps, Num and Scroll Lock key presses.
+     *
+     * @return uint8_t Bitmask of Led values.
+     */
+    uint8_t getLedState() const { return ledState_; }
+
+    /**
+     * @brief Overwrite the lock LED state, e.g. to mirror the state of another keyboard.
+     *
+     * @param leds Bitmask of Led values.
+     */
+    void setLedState(uint8_t leds);
+
+    /**
+     * @brief Register the function called when the lock LED state changes.
+     *
+     * Called from the input path, so it must not block.
+     */
+    void registerLedCallback(LedCallback callback) { ledCallback_ = std::move(callback); }
+
+    /**
+     * @brief Build the output report that shows an LED state on the keyboard.
+     *
+     * Uses the boot layout (one byte) or, in report protocol, the LED fields of the
+     * report descriptor. With report IDs the buffer starts with the ID byte.
+     *
+     * @param leds Bitmask of Led values.
+     * @param buffer Receives the report.
+     * @param size Size of the buffer in bytes.
+     * @param reportId Receives the report ID to send the report with.
+     * @return size_t Length of the report, 0 if the keyboard has no LEDs or the buffer is too small.
+     */
+    size_t buildLedReport(uint8_t leds, uint8_t *buffer, size_t size, uint8_t &reportId) const;
+
     /**
      * @brief Check if a specific modifier key is active.
      *
@@ -312,27 +444,44 @@ public:
     uint8_t getModifiers() const;
 
     /**
-     * @brief Get a list of currently pressed keys.
+     * @brief Get a list of currently pressed keys, excluding modifiers.
      *
      * @return std::vector<KeyCode> The list of pressed keys.
      */
     std::vector<KeyCode> getPressedKeys() const;
 
+    /**
+     * @brief Check if a specific key is currently pressed.
+     *
+     * @param keyCode The key to check.
+     * @return true if the key is down, false otherwise.
+     */
+    bool isKeyPressed(KeyCode keyCode) const { return keyState_.test(static_cast<uint8_t>(keyCode)); }
+
+    /**
+     * @brief Get the current key state, one bit per usage ID.
+     *
+     * @return const UsbHidKeyBitset& The key state.
+     */
+    const UsbHidKeyBitset &getKeyState() const { return keyState_; }
+
     /**
      * @brief Get the name of a specific key code.
      *
+     * Indexes a compile-time table, no allocation or hashing.
+     *
      * @param keyCode The key code to get the name for.
-     * @return std::string The name of the key.
+     * @return std::string_view The name of the key, "Unknown" for reserved usages.
      */
-    static std::string getKeyName(KeyCode keyCode);
+    static std::string_view getKeyName(KeyCode keyCode);
 
     /**
      * @brief Get the name of a specific key code.
      *
      * @param keyCode The key code to get the name for.
-     * @return std::string The name of the key.
+     * @return std::string_view The name of the key, "Unknown" for reserved usages.
      */
-    static std::string getKeyName(uint8_t keyCode) { return getKeyName(static_cast<KeyCode>(keyCode)); }
+    static std::string_view getKeyName(uint8_t keyCode) { return getKeyName(static_cast<KeyCode>(keyCode)); }
 
     /**
      * @brief Get a space-separated string of modifier names from a bitmask.
@@ -345,6 +494,8 @@ public:
     /**
      * @brief Get a comma-separated string of currently pressed key names.
      *
+     * Truncated to NAME_BUFFER_SIZE - 1 characters.
+     *
      * @return std::string The names of pressed keys.
      */
     std::string getPressedKeyNames() const;
@@ -356,14 +507,64 @@ public:
      */
     std::string getActiveModifierNames() const;
 
+    /**
+     * @brief Write a space-separated list of modifier names from a bitmask into a buffer.
+     *
+     * Does not allocate. Writes "NONE" if no modifier is set.
+     *
+     * @param modifiers The modifier bitmask.
+     * @param buffer Destination buffer, always NUL-terminated if size is non-zero.
+     * @param size Size of the buffer in bytes.
+     * @return size_t Number of characters written, not counting the terminating NUL.
+     */
+    static size_t formatModifierNames(uint8_t modifiers, char *buffer, size_t size);
+
+    /**
+     * @brief Write a comma-separated list of currently pressed key names into a buffer.
+     *
+     * Does not allocate. Writes "NONE" if no key is pressed.
+     *
+     * @param buffer Destination buffer, always NUL-terminated if size is non-zero.
+     * @param size Size of the buffer in bytes.
+     * @return size_t Number of characters written, not counting the terminating NUL.
+     */
+    size_t formatPressedKeyNames(char *buffer, size_t size) const;
+
+    /**
+     * @brief Write a space-separated list of currently active modifier names into a buffer.
+     *
+     * @param buffer Destination buffer, always NUL-terminated if size is non-zero.
+     * @param size Size of the buffer in bytes.
+     * @return size_t Number of characters written, not counting the terminating NUL.
+     */
+    size_t formatActiveModifierNames(char *buffer, size_t size) const { return formatModifierNames(getModifiers(), buffer, size); }
+
 protected:
     /**
      * @brief Create a UsbHidKeyboardEvent based on the current report state.
      *
+     * The event carries the current modifiers and no key edge (keyCode is KEY_NONE).
+     *
      * @return UsbHidKeyboardEvent The created event.
      */
     UsbHidKeyboardEvent createEvent() const override;
 
+    /**
+     * @brief Create a UsbHidKeyboardEvent for a single key edge.
+     *
+     * @param keyCode Usage ID of the key that changed state.
+     * @param pressed true on key-down, false on key-up.
+     * @return UsbHidKeyboardEvent The created event.
+     */
+    UsbHidKeyboardEvent createKeyEvent(uint8_t keyCode, bool pressed) const;
+
+    /**
+     * @brief Step the key state towards @p next, firing an event for every bit that changed.
+     *
+     * @param next The new key state.
+     */
+    void updateKeyState(const UsbHidKeyBitset &next);
+
 private:
     /**
      * @struct KeyboardReportData
@@ -394,8 +595,54 @@ private:
         uint8_t key[MAX_KEYS];
     } __attribute__((packed));
 
-    KeyboardReportData report_;  ///< The current keyboard report data
+    /// First usage ID of the modifier keys, bit n of the modifier byte maps to MODIFIER_USAGE_BASE + n
+    static constexpr uint8_t MODIFIER_USAGE_BASE = 0xE0;
+
+    /// Maximum number of keyboard page fields kept from a report descriptor
+    static constexpr size_t MAX_KEY_FIELDS = 4;
+
+    /// Number of LEDs in Led, usages 0x01 - 0x05 of the LED page
+    static constexpr size_t LED_COUNT = 5;
+
+    UsbHidKeyBitset keyState_;  ///< Current key state, one bit per usage ID
+
+    std::unique_ptr<UsbHidKeyRepeater> repeater_;  ///< Typematic repeat engine, null when disabled
 
-    /// Map of key codes to their string representations
-    static const std::unordered_map<KeyCode, std::string> keyNameMap;
+    bool reportProtocol_;                                       ///< Decode using keyFields_ instead of the boot layout
+    bool usesReportId_;                                         ///< Reports are prefixed with reportId_
+    uint8_t reportId_;                                          ///< Report ID of the keyboard input report
+    size_t keyFieldCount_;                                      ///< Number of valid entries in keyFields_
+    std::array<UsbHidReportField, MAX_KEY_FIELDS> keyFields_;  ///< Keyboard page fields of the input report
+
+    uint8_t ledState_;                             ///< Lock LED state, bitmask of Led values
+    LedCallback ledCallback_;                      ///< Called when ledState_ changes
+    uint8_t ledReportId_;                          ///< Report ID of the LED output report
+    size_t ledReportSize_;                         ///< LED output report payload size, 0 if there are no LEDs
+    std::array<int16_t, LED_COUNT> ledBitOffsets_;  ///< Bit of each LED in the payload, -1 if absent
+
+    /**
+     * @brief Toggle the lock LED belonging to a lock key.
+     *
+     * @param keyCode Usage ID of the key that was pressed.
+     * @return true if the key is a lock key.
+     */
+    bool toggleLock(uint8_t keyCode);
+
+    /**
+     * @brief Decode a boot protocol report into a key state.
+     *
+     * @param report The boot protocol report.
+     * @return UsbHidKeyBitset The decoded key state.
+     */
+    static UsbHidKeyBitset decodeBootReport(const KeyboardReportData &report);
+
+    /**
+     * @brief Decode a report protocol payload into a key state.
+     *
+     * @param payload Report data, not including the report ID byte.
+     * @param length Length of the payload in bytes.
+     * @param keys Receives the decoded key state.
+     * @return true on success, false if the keyboard reported a rollover error.
+     */
+    bool decodeReport(const uint8_t *payload, size_t length, UsbHidKeyBitset &keys) const;
 };
\ No newline at end of file
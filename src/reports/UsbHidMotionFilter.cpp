@@ -0,0 +1,87 @@
+/**
+ * @file UsbHidMotionFilter.cpp
+ * @brief Implements the UsbHidMotionFilter class, a fixed-point jitter filter for relative motion.
+ */
+
+#include "UsbHidMotionFilter.h"
+#include "UsbHidMotionMath.h"
+
+#include <cstdlib>
+
+UsbHidMotionFilter::UsbHidMotionFilter()
+    : UsbHidMotionFilter(Config::passthrough())
+{
+}
+
+UsbHidMotionFilter::UsbHidMotionFilter(const Config& config)
+    : config_(config),
+      velocityX_(0),
+      velocityY_(0),
+      remainderX_(0),
+      remainderY_(0)
+{
+}
+
+void UsbHidMotionFilter::setConfig(const Config& config)
+{
+    config_ = config;
+    reset();
+}
+
+void UsbHidMotionFilter::reset()
+{
+    velocityX_  = 0;
+    velocityY_  = 0;
+    remainderX_ = 0;
+    remainderY_ = 0;
+}
+
+bool UsbHidMotionFilter::filter(int32_t dx, int32_t dy, int32_t& outX, int32_t& outY)
+{
+    const uint32_t speed = UsbHidMotionMath::speed(dx, dy);
+
+    if (speed <= config_.deadZone && atRest())
+    {
+        dx = 0;
+        dy = 0;
+    }
+
+    // velocity += alpha * (sample - velocity), all in Q8
+    const int64_t alpha = alphaFor(speed);
+    velocityX_ += static_cast<int32_t>((alpha * (static_cast<int64_t>(dx) * FULL_ALPHA - velocityX_)) >> FRACTION_BITS);
+    velocityY_ += static_cast<int32_t>((alpha * (static_cast<int64_t>(dy) * FULL_ALPHA - velocityY_)) >> FRACTION_BITS);
+
+    // Whole counts are output, the signed fraction is carried over
+    outX = UsbHidMotionMath::carryWhole<int32_t>(velocityX_, remainderX_, FULL_ALPHA);
+    outY = UsbHidMotionMath::carryWhole<int32_t>(velocityY_, remainderY_, FULL_ALPHA);
+
+    if (dx == 0 && dy == 0 && atRest())
+    {
+        // Settled: drop what is left so it does not leak out with the next movement
+        reset();
+    }
+
+    return outX != 0 || outY != 0;
+}
+
+uint32_t UsbHidMotionFilter::alphaFor(uint32_t speed) const
+{
+    if (speed <= config_.speedLow || config_.speedHigh <= config_.speedLow)
+    {
+        return speed <= config_.speedLow ? config_.minAlpha : config_.maxAlpha;
+    }
+    if (speed >= config_.speedHigh)
+    {
+        return config_.maxAlpha;
+    }
+
+    const int32_t span = config_.speedHigh - config_.speedLow;
+    const int32_t frac = static_cast<int32_t>(speed - config_.speedLow);
+    return static_cast<uint32_t>(config_.minAlpha + (static_cast<int32_t>(config_.maxAlpha) - config_.minAlpha) * frac / span);
+}
+
+bool UsbHidMotionFilter::atRest() const
+{
+    // Smoothed speed below one count per sample
+    return std::abs(velocityX_) < FULL_ALPHA && std::abs(velocityY_) < FULL_ALPHA;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file UsbHidMotionFilter.h
+ * @brief Defines the UsbHidMotionFilter class, a fixed-point jitter filter for relative motion.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @class UsbHidMotionFilter
+ * @brief Dead-zone and adaptive exponential smoothing for noisy relative motion, e.g. air mice.
+ *
+ * Each sample is blended into a smoothed velocity with a weight (alpha) that rises with the
+ * sample's speed: slow movement is smoothed hard to remove tremor, fast movement passes
+ * with little lag. While the device is at rest, samples inside the dead zone are dropped so
+ * sensor noise does not creep the cursor. The output carries its sub-count fraction to the
+ * next sample, so smoothing does not lose motion.
+ *
+ * All arithmetic is integer; alphas are Q8 (256 = take the sample as is). The filter is
+ * per sample and keeps no clock of its own.
+ */
+class UsbHidMotionFilter
+{
+public:
+    /// Fractional bits of alphas and of the smoothed state
+    static constexpr int FRACTION_BITS = 8;
+    /// Alpha of 1.0, no smoothing
+    static constexpr uint16_t FULL_ALPHA = 1 << FRACTION_BITS;
+
+    /**
+     * @struct Config
+     * @brief Filter parameters, set per device.
+     */
+    struct Config
+    {
+        uint16_t deadZone;   ///< Speed in counts dropped while at rest, 0 to disable
+        uint16_t minAlpha;   ///< Q8 weight of a sample at speedLow or slower
+        uint16_t maxAlpha;   ///< Q8 weight of a sample at speedHigh or faster
+        uint16_t speedLow;   ///< Speed in counts per sample where smoothing starts to ease off
+        uint16_t speedHigh;  ///< Speed in counts per sample where smoothing reaches maxAlpha
+
+        /**
+         * @brief Parameters for gyro air mice: drop +-1 count tremor, smooth slow pointing.
+         */
+        static constexpr Config airMouse() { return Config{1, 64, 230, 2, 24}; }
+
+        /**
+         * @brief Parameters that pass samples through unchanged.
+         */
+        static constexpr Config passthrough() { return Config{0, FULL_ALPHA, FULL_ALPHA, 0, 1}; }
+    };
+
+    /**
+     * @brief Construct a new UsbHidMotionFilter object that passes samples through.
+     */
+    UsbHidMotionFilter();
+
+    /**
+     * @brief Construct a new UsbHidMotionFilter object.
+     */
+    explicit UsbHidMotionFilter(const Config& config);
+
+    /**
+     * @brief Change the parameters and reset the state.
+     */
+    void setConfig(const Config& config);
+    const Config& getConfig() const { return config_; }
+
+    /**
+     * @brief Filter one sample.
+     *
+     * @param dx Relative X in counts.
+     * @param dy Relative Y in counts.
+     * @param outX Filtered X in counts.
+     * @param outY Filtered Y in counts.
+     * @return true if the filtered motion is non-zero.
+     */
+    bool filter(int32_t dx, int32_t dy, int32_t& outX, int32_t& outY);
+
+    /**
+     * @brief Forget the smoothed velocity and carried fractions, e.g. on disconnect.
+     */
+    void reset();
+
+private:
+    Config config_;
+    int32_t velocityX_;   ///< Smoothed velocity, Q8 counts per sample
+    int32_t velocityY_;
+    int32_t remainderX_;  ///< Output fraction carried over, Q8 counts
+    int32_t remainderY_;
+
+    uint32_t alphaFor(uint32_t speed) const;
+    bool atRest() const;
+};
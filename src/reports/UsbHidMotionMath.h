@@ -0,0 +1,52 @@
+/**
+ * @file UsbHidMotionMath.h
+ * @brief Fixed-point helpers shared by the relative motion stages.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+/**
+ * @namespace UsbHidMotionMath
+ * @brief Integer-only arithmetic for motion measured in counts per report.
+ *
+ * Used by UsbHidMotionFilter and UsbHidPointerProcessor, which both run once per mouse
+ * report and must agree on what a speed is.
+ */
+namespace UsbHidMotionMath
+{
+/**
+ * @brief Approximate the length of a motion vector.
+ *
+ * Octagonal approximation, max + min / 2: no square root, within 12% of the true length.
+ *
+ * @return uint32_t Speed in counts per report.
+ */
+inline uint32_t speed(int32_t dx, int32_t dy)
+{
+    const uint32_t ax = std::abs(dx);
+    const uint32_t ay = std::abs(dy);
+    return std::max(ax, ay) + std::min(ax, ay) / 2;
+}
+
+/**
+ * @brief Split a fixed-point value into whole units, carrying the signed fraction over.
+ *
+ * @tparam T Integer type wide enough for value + remainder.
+ * @param value Fixed-point value to output.
+ * @param remainder Fraction left from the previous call, updated with the new one.
+ * @param unit Fixed-point value of one whole unit, e.g. 256 for Q8.
+ * @return T Whole units, rounded towards zero.
+ */
+template <typename T>
+inline T carryWhole(T value, int32_t& remainder, int32_t unit)
+{
+    const T total = remainder + value;
+    const T whole = total / unit;
+    remainder     = static_cast<int32_t>(total - whole * unit);
+    return whole;
+}
+}  // namespace UsbHidMotionMath
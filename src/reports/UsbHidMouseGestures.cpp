@@ -0,0 +1,164 @@
+/**
+ * @file UsbHidMouseGestures.cpp
+ * @brief Implements the UsbHidMouseGestures class, which detects clicks, double-clicks and long presses.
+ */
+
+#include "UsbHidMouseGestures.h"
+
+#include <cstdlib>
+
+namespace
+{
+/// Wrap-safe "a is at or after b" for millisecond timestamps
+constexpr bool reached(uint32_t a, uint32_t b)
+{
+    return static_cast<int32_t>(a - b) >= 0;
+}
+}  // namespace
+
+UsbHidMouseGestures::UsbHidMouseGestures(UsbHidTimerWheel& wheel)
+    : UsbHidMouseGestures(wheel, Config())
+{
+}
+
+UsbHidMouseGestures::UsbHidMouseGestures(UsbHidTimerWheel& wheel, const Config& config)
+    : wheel_(wheel),
+      timer_([this](Millis now) { onTimeout(now); }),
+      config_(config),
+      buttons_{}
+{
+}
+
+UsbHidMouseGestures::~UsbHidMouseGestures()
+{
+    wheel_.stop(timer_);
+}
+
+void UsbHidMouseGestures::onMouseEvent(const UsbHidMouseEvent& event)
+{
+    if (!callback_)
+    {
+        return;
+    }
+
+    const Millis now = wheel_.now();
+
+    // Motion in a report happened while the buttons of the previous report were held
+    const uint32_t motion = std::abs(event.x_delta) + std::abs(event.y_delta);
+    if (motion != 0)
+    {
+        for (auto& state : buttons_)
+        {
+            if (!state.held || state.used)
+            {
+                continue;
+            }
+            state.travel += motion;
+            if (state.travel > config_.moveTolerance)
+            {
+                state.used         = true;  // A drag
+                state.clickPending = false;
+            }
+        }
+    }
+
+    for (uint8_t button = 0; button < MAX_BUTTONS; ++button)
+    {
+        if (event.wasReleased(button))
+        {
+            onRelease(button, now);
+        }
+        else if (event.wasPressed(button))
+        {
+            ButtonState& state = buttons_[button];
+            state.pressTime    = now;
+            state.travel       = 0;
+            state.held         = true;
+            state.used         = false;
+        }
+    }
+
+    armTimer(now);
+}
+
+void UsbHidMouseGestures::reset()
+{
+    wheel_.stop(timer_);
+    buttons_ = {};
+}
+
+void UsbHidMouseGestures::onRelease(uint8_t button, Millis now)
+{
+    ButtonState& state = buttons_[button];
+    if (!state.held)
+    {
+        return;  // Pressed before the last reset()
+    }
+    state.held = false;
+
+    if (state.used)
+    {
+        return;
+    }
+
+    if (state.clickPending && now - state.lastClickTime <= config_.doubleClickMs)
+    {
+        state.clickPending = false;
+        emit(UsbHidMouseGesture::DOUBLE_CLICK, button, now);
+        return;
+    }
+
+    state.clickPending  = true;
+    state.lastClickTime = now;
+    emit(UsbHidMouseGesture::CLICK, button, now);
+}
+
+void UsbHidMouseGestures::onTimeout(Millis now)
+{
+    for (uint8_t button = 0; button < MAX_BUTTONS; ++button)
+    {
+        ButtonState& state = buttons_[button];
+        if (state.held && !state.used && reached(now, state.pressTime + config_.longPressMs))
+        {
+            state.used         = true;
+            state.clickPending = false;
+            emit(UsbHidMouseGesture::LONG_PRESS, button, now);
+        }
+    }
+    armTimer(now);
+}
+
+void UsbHidMouseGestures::armTimer(Millis now)
+{
+    bool armed      = false;
+    Millis earliest = 0;
+    for (const auto& state : buttons_)
+    {
+        if (!state.held || state.used)
+        {
+            continue;
+        }
+        const Millis deadline = state.pressTime + config_.longPressMs;
+        if (!armed || !reached(deadline, earliest))
+        {
+            earliest = deadline;
+            armed    = true;
+        }
+    }
+
+    if (!armed)
+    {
+        wheel_.stop(timer_);
+        return;
+    }
+    wheel_.start(timer_, reached(now, earliest) ? 0 : earliest - now);
+}
+
+void UsbHidMouseGestures::emit(UsbHidMouseGesture gesture, uint8_t button, Millis now)
+{
+    UsbHidMouseGestureEvent event;
+    event.gesture = gesture;
+    event.button  = button;
+    event.time    = now;
+    callback_(event);
+}
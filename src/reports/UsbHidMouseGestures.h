@@ -0,0 +1,133 @@
+/**
+ * @file UsbHidMouseGestures.h
+ * @brief Defines the UsbHidMouseGestures class, which detects clicks, double-clicks and long presses.
+ */
+
+#pragma once
+
+#include "UsbHidMouseReport.h"
+#include "UsbHidTimerWheel.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+
+/**
+ * @enum UsbHidMouseGesture
+ * @brief Gestures detected from mouse button edges.
+ */
+enum class UsbHidMouseGesture : uint8_t
+{
+    CLICK,         ///< Press and release without a long press or dragging
+    DOUBLE_CLICK,  ///< Second click within the double-click interval; replaces its click
+    LONG_PRESS     ///< Button held for the long-press time without dragging; no click follows
+};
+
+/**
+ * @struct UsbHidMouseGestureEvent
+ * @brief A detected gesture.
+ */
+struct UsbHidMouseGestureEvent
+{
+    UsbHidMouseGesture gesture;
+    uint8_t button;  ///< 0-based: 0 left, 1 right, 2 middle, ...
+    uint32_t time;   ///< Timer wheel time of the detection, in milliseconds
+
+    UsbHidMouseGestureEvent() : gesture(UsbHidMouseGesture::CLICK), button(0), time(0) {}
+};
+
+/**
+ * @class UsbHidMouseGestures
+ * @brief Detects click, double-click and long press from UsbHidMouseEvent button edges.
+ *
+ * Reports are timestamped with the time of a shared UsbHidTimerWheel, which the host
+ * advances before each report is dispatched; long presses fire from a wheel timer while
+ * the button is still held. Driving the wheel from a simulated clock makes detection
+ * fully deterministic.
+ *
+ * Motion while a button is held adds up; past the move tolerance the press is a drag
+ * and produces no gesture. The layer does nothing until a callback is registered.
+ */
+class UsbHidMouseGestures
+{
+public:
+    using Millis = UsbHidTimerWheel::Millis;
+
+    /**
+     * @typedef GestureCallback
+     * @brief Function called when a gesture is detected.
+     */
+    using GestureCallback = std::function<void(const UsbHidMouseGestureEvent&)>;
+
+    /**
+     * @struct Config
+     * @brief Gesture timing and tolerance.
+     */
+    struct Config
+    {
+        Millis longPressMs     = 500;  ///< Hold time of a long press
+        Millis doubleClickMs   = 400;  ///< Maximum time from one click's release to the next
+        uint16_t moveTolerance = 4;    ///< Counts of motion, |dx| + |dy|, a press may travel
+    };
+
+    /**
+     * @brief Construct a new UsbHidMouseGestures object with the default configuration.
+     *
+     * @param wheel Timer wheel providing report timestamps and long-press timeouts.
+     */
+    explicit UsbHidMouseGestures(UsbHidTimerWheel& wheel);
+
+    /**
+     * @brief Construct a new UsbHidMouseGestures object.
+     *
+     * @param wheel Timer wheel providing report timestamps and long-press timeouts.
+     * @param config Gesture timing and tolerance.
+     */
+    UsbHidMouseGestures(UsbHidTimerWheel& wheel, const Config& config);
+
+    UsbHidMouseGestures(const UsbHidMouseGestures&)            = delete;
+    UsbHidMouseGestures& operator=(const UsbHidMouseGestures&) = delete;
+
+    ~UsbHidMouseGestures();
+
+    void setConfig(const Config& config) { config_ = config; }
+    const Config& getConfig() const { return config_; }
+
+    /**
+     * @brief Register the function called when a gesture is detected.
+     */
+    void registerCallback(GestureCallback callback) { callback_ = std::move(callback); }
+
+    /**
+     * @brief Feed a mouse event.
+     */
+    void onMouseEvent(const UsbHidMouseEvent& event);
+
+    /**
+     * @brief Forget held buttons and pending double-clicks, e.g. before a disconnect.
+     */
+    void reset();
+
+private:
+    static constexpr size_t MAX_BUTTONS = UsbHidMouseReport::MAX_BUTTONS;
+
+    struct ButtonState
+    {
+        Millis pressTime;      ///< Time the button went down
+        Millis lastClickTime;  ///< Time of the last click's release
+        uint32_t travel;       ///< Motion since the press
+        bool held;
+        bool used;             ///< Long press fired or dragged: the release is not a click
+        bool clickPending;     ///< A click that a second one may turn into a double-click
+    };
+
+    UsbHidTimerWheel& wheel_;
+    UsbHidTimerWheel::Timer timer_;
+    Config config_;
+    GestureCallback callback_;
+    std::array<ButtonState, MAX_BUTTONS> buttons_;
+
+    void onRelease(uint8_t button, Millis now);
+    void onTimeout(Millis now);
+    void armTimer(Millis now);
+    void emit(UsbHidMouseGesture gesture, uint8_t button, Millis now);
+};
@@ -1,74 +1,257 @@
 // UsbHidMouseReport.cpp
 #include "UsbHidMouseReport.h"
+#include "UsbHidFormat.h"
+
+#include <algorithm>
+
+UsbHidMouseReport::UsbHidMouseReport()
+    : UsbHidBaseReport(),
+      state_{},
+      pressed_(0),
+      released_(0),
+      reportProtocol_(false),
+      usesReportId_(false),
+      reportId_(0),
+      xField_{},
+      yField_{},
+      wheelField_{},
+      panField_{},
+      buttonFieldCount_(0),
+      buttonFields_{}
+{
+}
 
 void UsbHidMouseReport::processReportData(const uint8_t *const data, int length)
 {
     rawReport_.assign(data, data + length);
 
     // Print raw data in hexadecimal format
-    std::string raw;
-    for (int i = 0; i < length; ++i)
+    char raw[RAW_LOG_SIZE];
+    UsbHidFormat::hex(data, length, raw, sizeof(raw));
+    ESP_LOGI("MouseReport", "Raw data: %s", raw);
+
+    MouseState next{};
+
+    if (reportProtocol_)
+    {
+        const uint8_t *payload = data;
+        size_t payloadLength   = length;
+
+        if (usesReportId_)
+        {
+            if (length < 1 || data[0] != reportId_)
+            {
+                return;
+            }
+            ++payload;
+            --payloadLength;
+        }
+
+        if (!decodeReport(payload, payloadLength, next))
+        {
+            ESP_LOGW("MouseReport", "Invalid report data length: %d", length);
+            return;
+        }
+    }
+    else if (length >= static_cast<int>(sizeof(MouseReportData)))
+    {
+        MouseReportData report;
+        std::memcpy(&report, data, sizeof(MouseReportData));
+        next.buttons = report.buttons.val;
+        next.x       = report.x_delta;
+        next.y       = report.y_delta;
+    }
+    else
+    {
+        ESP_LOGW("MouseReport", "Invalid report data length: %d", length);
+        return;
+    }
+
+    updateState(next);
+}
+
+void UsbHidMouseReport::updateState(const MouseState &next)
+{
+    // Motion is relative, every report that moves counts; otherwise only button changes do
+    const bool moved = next.x != 0 || next.y != 0 || next.wheel != 0 || next.pan != 0;
+    const bool changed = next.buttons != state_.buttons;
+
+    pressed_  = next.buttons & ~state_.buttons;
+    released_ = state_.buttons & ~next.buttons;
+    state_    = next;
+    if (moved || changed)
     {
-        char buffer[3];                                                // Each byte to hex requires 2 characters + null terminator
-        sprintf(buffer, "%02X", static_cast<unsigned char>(data[i]));  // Convert byte to hex
-        raw += buffer;
-        raw += " ";  // Add space between bytes for readability
+        triggerEvent(createEvent());
     }
-    ESP_LOGI("MouseReport", "Raw data: %s", raw.c_str());
+}
+
+bool UsbHidMouseReport::useReportProtocol(const UsbHidReportDescriptor &descriptor)
+{
+    xField_ = findElement(descriptor, USAGE_PAGE_GENERIC_DESKTOP, USAGE_X);
+    yField_ = findElement(descriptor, USAGE_PAGE_GENERIC_DESKTOP, USAGE_Y);
 
-    if (length >= sizeof(MouseReportData))
+    if (!xField_.valid || !yField_.valid || !xField_.field.isRelative() ||
+        xField_.field.reportId != yField_.field.reportId)
     {
-        MouseReportData newReport;
-        std::memcpy(&newReport, data, sizeof(MouseReportData));
+        ESP_LOGW("MouseReport", "No relative X/Y in report descriptor");
+        useBootProtocol();
+        return false;
+    }
+
+    reportId_     = xField_.field.reportId;
+    usesReportId_ = descriptor.usesReportIds();
 
-        if (memcmp(&newReport, &report_, sizeof(MouseReportData)) != 0)
+    wheelField_ = findElement(descriptor, USAGE_PAGE_GENERIC_DESKTOP, USAGE_WHEEL);
+    panField_   = findElement(descriptor, USAGE_PAGE_CONSUMER, USAGE_AC_PAN);
+    wheelField_.valid = wheelField_.valid && wheelField_.field.reportId == reportId_;
+    panField_.valid   = panField_.valid && panField_.field.reportId == reportId_;
+
+    buttonFieldCount_ = 0;
+    for (const auto &field : descriptor.fields())
+    {
+        if (field.type != UsbHidReportType::Input || field.usagePage != USAGE_PAGE_BUTTON ||
+            field.reportId != reportId_ || !field.isVariable() || field.usageMin > MAX_BUTTONS)
         {
-            report_ = newReport;
-            triggerEvent(createEvent());
+            continue;
         }
+        if (buttonFieldCount_ == MAX_BUTTON_FIELDS)
+        {
+            break;
+        }
+        buttonFields_[buttonFieldCount_++] = field;
     }
-    else
+
+    reportProtocol_ = true;
+    ESP_LOGI("MouseReport", "Report protocol: report ID 0x%02X, %u button fields, wheel %d, pan %d",
+             reportId_, static_cast<unsigned>(buttonFieldCount_), wheelField_.valid, panField_.valid);
+    return true;
+}
+
+void UsbHidMouseReport::useBootProtocol()
+{
+    reportProtocol_   = false;
+    usesReportId_     = false;
+    reportId_         = 0;
+    xField_.valid     = false;
+    yField_.valid     = false;
+    wheelField_.valid = false;
+    panField_.valid   = false;
+    buttonFieldCount_ = 0;
+}
+
+UsbHidMouseReport::FieldRef UsbHidMouseReport::findElement(const UsbHidReportDescriptor &descriptor, uint16_t usagePage, uint16_t usage)
+{
+    FieldRef ref{};
+    const UsbHidReportField *field = descriptor.findField(UsbHidReportType::Input, usagePage, usage);
+    if (field != nullptr && field->isVariable())
     {
-        // Handle error: report data is too short
-        std::memset(&report_, 0, sizeof(MouseReportData));
+        ref.field = *field;
+        ref.index = usage - field->usageMin;
+        ref.valid = ref.index < field->count;
     }
+    return ref;
 }
 
-bool UsbHidMouseReport::isButtonPressed(int button) const
+int16_t UsbHidMouseReport::readElement(const FieldRef &ref, const uint8_t *payload, size_t length)
+{
+    if (!ref.valid)
+    {
+        return 0;
+    }
+
+    // Deltas wider than 16 bits are clamped, none of our consumers go further
+    const int32_t value = ref.field.extract(payload, length, ref.index);
+    return static_cast<int16_t>(std::clamp<int32_t>(value, INT16_MIN, INT16_MAX));
+}
+
+bool UsbHidMouseReport::decodeReport(const uint8_t *payload, size_t length, MouseState &state) const
 {
-    switch (button)
+    // The report must at least reach the end of X and Y
+    const size_t xyEnd = std::max(xField_.field.bitOffset + (xField_.index + 1u) * xField_.field.bitSize,
+                                  yField_.field.bitOffset + (yField_.index + 1u) * yField_.field.bitSize);
+    if (length * 8 < xyEnd)
     {
-    case 0:  // LEFT
-        return report_.buttons.left;
-    case 1:  // RIGHT
-        return report_.buttons.right;
-    case 2:  // MIDDLE
-        return report_.buttons.middle;
-    default:
         return false;
     }
+
+    state.x     = readElement(xField_, payload, length);
+    state.y     = readElement(yField_, payload, length);
+    state.wheel = readElement(wheelField_, payload, length);
+    state.pan   = readElement(panField_, payload, length);
+
+    state.buttons = 0;
+    for (size_t f = 0; f < buttonFieldCount_; ++f)
+    {
+        const UsbHidReportField &field = buttonFields_[f];
+        for (uint16_t i = 0; i < field.count; ++i)
+        {
+            const uint32_t button = field.usageMin + i;
+            if (button < 1 || button > MAX_BUTTONS)
+            {
+                continue;
+            }
+            if (field.extract(payload, length, i) != 0)
+            {
+                state.buttons |= 1u << (button - 1);
+            }
+        }
+    }
+    return true;
+}
+
+void UsbHidMouseReport::releaseAll()
+{
+    const bool held = state_.buttons != 0;
+    pressed_        = 0;
+    released_       = state_.buttons;
+    state_          = {};
+    rawReport_.clear();
+
+    if (held)
+    {
+        triggerEvent(createEvent());
+    }
+}
+
+bool UsbHidMouseReport::isButtonPressed(int button) const
+{
+    return button >= 0 && button < static_cast<int>(MAX_BUTTONS) && (state_.buttons & (1u << button)) != 0;
+}
+
+uint16_t UsbHidMouseReport::getButtons() const
+{
+    return state_.buttons;
 }
 
-uint8_t UsbHidMouseReport::getButtons() const
+int16_t UsbHidMouseReport::getXDelta() const
 {
-    return report_.buttons.val;
+    return state_.x;
 }
 
-int8_t UsbHidMouseReport::getXDelta() const
+int16_t UsbHidMouseReport::getYDelta() const
 {
-    return report_.x_delta;
+    return state_.y;
 }
 
-int8_t UsbHidMouseReport::getYDelta() const
+int16_t UsbHidMouseReport::getWheel() const
 {
-    return report_.y_delta;
+    return state_.wheel;
+}
+
+int16_t UsbHidMouseReport::getPan() const
+{
+    return state_.pan;
 }
 
 UsbHidMouseEvent UsbHidMouseReport::createEvent() const
 {
     UsbHidMouseEvent event;
-    event.buttons = report_.buttons.val;
-    event.x_delta = report_.x_delta;
-    event.y_delta = report_.y_delta;
+    event.buttons  = state_.buttons;
+    event.pressed  = pressed_;
+    event.released = released_;
+    event.x_delta  = state_.x;
+    event.y_delta  = state_.y;
+    event.wheel    = state_.wheel;
+    event.pan      = state_.pan;
     return event;
-}
\ No newline at end of file
+}
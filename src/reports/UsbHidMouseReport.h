@@ -2,6 +2,8 @@
 #pragma once
 
 #include "UsbHidBaseReport.h"
+#include "UsbHidReportDescriptor.h"
+#include <array>
 #include <cstdint>
 #include <cstring>
 #include <string>
@@ -11,28 +13,59 @@
 struct UsbHidMouseEvent
 {
     UsbHidDeviceType deviceType_;
-    uint8_t buttons;
-    int8_t x_delta;
-    int8_t y_delta;
+    uint16_t buttons;   // Button n (1-based) in bit n-1, up to 16 buttons
+    uint16_t pressed;   // Buttons that went down in this report
+    uint16_t released;  // Buttons that went up in this report
+    int16_t x_delta;
+    int16_t y_delta;
+    int16_t wheel;  // Vertical wheel, positive away from the user
+    int16_t pan;    // Horizontal wheel / tilt (AC Pan), positive to the right
 
-    UsbHidMouseEvent() : deviceType_(UsbHidDeviceType::Mouse), buttons(0), x_delta(0), y_delta(0) {}
+    UsbHidMouseEvent() : deviceType_(UsbHidDeviceType::Mouse), buttons(0), pressed(0), released(0), x_delta(0), y_delta(0), wheel(0), pan(0) {}
+
+    // 0-based buttons, as UsbHidMouseReport::isButtonPressed()
+    bool wasPressed(int button) const { return button >= 0 && button < 16 && (pressed & (1u << button)) != 0; }
+    bool wasReleased(int button) const { return button >= 0 && button < 16 && (released & (1u << button)) != 0; }
+    bool hasMotion() const { return x_delta != 0 || y_delta != 0 || wheel != 0 || pan != 0; }
 };
 
 class UsbHidMouseReport : public UsbHidBaseReport<UsbHidMouseEvent, UsbHidDeviceType::Mouse>
 {
 public:
-    UsbHidMouseReport() : UsbHidBaseReport() {}  // Is this correct?
+    static constexpr size_t MAX_BUTTONS = 16;
+
+    UsbHidMouseReport();
     void processReportData(const uint8_t* const data, int length) override;
+    void releaseAll() override;  // Releases held buttons with a final event
+
+    // Decode reports using the layout from the mouse's report descriptor (16-bit deltas, wheel,
+    // AC pan, up to 16 buttons). Returns false, and keeps the boot layout, if the descriptor
+    // has no relative X/Y.
+    bool useReportProtocol(const UsbHidReportDescriptor& descriptor);
+    void useBootProtocol();
+    bool isReportProtocol() const { return reportProtocol_; }
+    uint8_t getInputReportId() const { return usesReportId_ ? reportId_ : 0; }  // 0 if reports carry no ID
 
-    bool isButtonPressed(int button) const;
-    uint8_t getButtons() const;
-    int8_t getXDelta() const;
-    int8_t getYDelta() const;
+    bool isButtonPressed(int button) const;  // 0-based: 0 left, 1 right, 2 middle, ...
+    uint16_t getButtons() const;
+    int16_t getXDelta() const;
+    int16_t getYDelta() const;
+    int16_t getWheel() const;
+    int16_t getPan() const;
 
 protected:
     UsbHidMouseEvent createEvent() const override;
 
 private:
+    static constexpr uint16_t USAGE_PAGE_GENERIC_DESKTOP = 0x01;
+    static constexpr uint16_t USAGE_PAGE_BUTTON          = 0x09;
+    static constexpr uint16_t USAGE_PAGE_CONSUMER        = 0x0C;
+    static constexpr uint16_t USAGE_X                    = 0x30;
+    static constexpr uint16_t USAGE_Y                    = 0x31;
+    static constexpr uint16_t USAGE_WHEEL                = 0x38;
+    static constexpr uint16_t USAGE_AC_PAN               = 0x238;
+    static constexpr size_t MAX_BUTTON_FIELDS            = 2;
+
     struct MouseReportData
     {
         union
@@ -50,5 +83,39 @@ private:
         int8_t y_delta;
     } __attribute__((packed));
 
-    MouseReportData report_;
-};
\ No newline at end of file
+    // One element of a report descriptor field
+    struct FieldRef
+    {
+        UsbHidReportField field;
+        uint16_t index;
+        bool valid;
+    };
+
+    struct MouseState
+    {
+        uint16_t buttons;
+        int16_t x;
+        int16_t y;
+        int16_t wheel;
+        int16_t pan;
+    };
+
+    MouseState state_;
+    uint16_t pressed_;   // Edges of the last report
+    uint16_t released_;
+
+    bool reportProtocol_;
+    bool usesReportId_;
+    uint8_t reportId_;
+    FieldRef xField_;
+    FieldRef yField_;
+    FieldRef wheelField_;
+    FieldRef panField_;
+    size_t buttonFieldCount_;
+    std::array<UsbHidReportField, MAX_BUTTON_FIELDS> buttonFields_;
+
+    static FieldRef findElement(const UsbHidReportDescriptor& descriptor, uint16_t usagePage, uint16_t usage);
+    static int16_t readElement(const FieldRef& ref, const uint8_t* payload, size_t length);
+    bool decodeReport(const uint8_t* payload, size_t length, MouseState& state) const;
+    void updateState(const MouseState& next);
+};
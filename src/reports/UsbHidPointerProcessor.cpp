@@ -0,0 +1,104 @@
+/**
+ * @file UsbHidPointerProcessor.cpp
+ * @brief Implements the UsbHidPointerProcessor class, a fixed-point pointer acceleration stage.
+ */
+
+#include "UsbHidPointerProcessor.h"
+#include "UsbHidMotionMath.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+UsbHidPointerProcessor::UsbHidPointerProcessor()
+    : UsbHidPointerProcessor(Config())
+{
+}
+
+UsbHidPointerProcessor::UsbHidPointerProcessor(const Config& config)
+    : config_(config),
+      x_(config.viewport.x + config.viewport.width / 2),
+      y_(config.viewport.y + config.viewport.height / 2),
+      remainderX_(0),
+      remainderY_(0)
+{
+}
+
+void UsbHidPointerProcessor::setConfig(const Config& config)
+{
+    config_ = config;
+    setPosition(x_, y_);
+}
+
+void UsbHidPointerProcessor::setPosition(int32_t x, int32_t y)
+{
+    x_          = clamp(x, config_.viewport.x, config_.viewport.width);
+    y_          = clamp(y, config_.viewport.y, config_.viewport.height);
+    remainderX_ = 0;
+    remainderY_ = 0;
+}
+
+uint32_t UsbHidPointerProcessor::curveGain(uint32_t speed) const
+{
+    const uint32_t step = std::max<uint32_t>(config_.speedStep, 1);
+    const uint32_t index = speed / step;
+    if (index >= CURVE_POINTS - 1)
+    {
+        return config_.curve[CURVE_POINTS - 1];
+    }
+
+    // Linear interpolation between the two neighbouring entries
+    const int32_t low  = config_.curve[index];
+    const int32_t high = config_.curve[index + 1];
+    const int32_t frac = static_cast<int32_t>(speed - index * step);
+    return static_cast<uint32_t>(low + (high - low) * frac / static_cast<int32_t>(step));
+}
+
+bool UsbHidPointerProcessor::move(int32_t dx, int32_t dy, UsbHidDeviceType deviceType)
+{
+    if (dx == 0 && dy == 0)
+    {
+        return false;
+    }
+
+    // Q8.8 * Q8.8 >> 8 leaves 1/256 pixel units
+    const uint32_t speed = UsbHidMotionMath::speed(dx, dy);
+    const int64_t gain   = static_cast<int64_t>(config_.sensitivity) * curveGain(speed) >> FRACTION_BITS;
+
+    // Whole pixels move the cursor, the signed fraction is carried over
+    const int64_t px = UsbHidMotionMath::carryWhole<int64_t>(dx * gain, remainderX_, UNITY_GAIN);
+    const int64_t py = UsbHidMotionMath::carryWhole<int64_t>(dy * gain, remainderY_, UNITY_GAIN);
+
+    const int64_t wantX = x_ + px;
+    const int64_t wantY = y_ + py;
+    const int32_t newX  = clamp(static_cast<int32_t>(std::clamp<int64_t>(wantX, INT32_MIN, INT32_MAX)), config_.viewport.x, config_.viewport.width);
+    const int32_t newY  = clamp(static_cast<int32_t>(std::clamp<int64_t>(wantY, INT32_MIN, INT32_MAX)), config_.viewport.y, config_.viewport.height);
+
+    // Pushing against an edge must not build up motion to be released later
+    if (newX != wantX) remainderX_ = 0;
+    if (newY != wantY) remainderY_ = 0;
+
+    if (newX == x_ && newY == y_)
+    {
+        return false;
+    }
+
+    UsbHidPointerEvent event;
+    event.deviceType_ = deviceType;
+    event.dx          = newX - x_;
+    event.dy          = newY - y_;
+    event.x           = newX;
+    event.y           = newY;
+    x_                = newX;
+    y_                = newY;
+
+    if (callback_)
+    {
+        callback_(event);
+    }
+    return true;
+}
+
+int32_t UsbHidPointerProcessor::clamp(int32_t value, int32_t origin, int32_t size)
+{
+    return std::clamp(value, origin, origin + std::max<int32_t>(size, 1) - 1);
+}
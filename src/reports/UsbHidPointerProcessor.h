@@ -0,0 +1,193 @@
+/**
+ * @file UsbHidPointerProcessor.h
+ * @brief Defines the UsbHidPointerProcessor class, a fixed-point pointer acceleration stage.
+ */
+
+#pragma once
+
+#include "UsbHidBaseReport.h"
+#include "UsbHidG20sProReport.h"
+#include "UsbHidMouseReport.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+
+/**
+ * @struct UsbHidPointerEvent
+ * @brief Cursor position after a relative motion report.
+ */
+struct UsbHidPointerEvent
+{
+    UsbHidDeviceType deviceType_;  ///< Device the motion came from
+    int32_t x;                     ///< Absolute cursor X, inside the viewport
+    int32_t y;                     ///< Absolute cursor Y, inside the viewport
+    int32_t dx;                    ///< Cursor movement in pixels, after acceleration and clamping
+    int32_t dy;                    ///< Cursor movement in pixels, after acceleration and clamping
+
+    UsbHidPointerEvent() : deviceType_(UsbHidDeviceType::Mouse), x(0), y(0), dx(0), dy(0) {}
+};
+
+/**
+ * @class UsbHidPointerProcessor
+ * @brief Turns relative motion into an accelerated, clamped absolute cursor position.
+ *
+ * All arithmetic is integer. Gains are Q8.8 fixed point (256 = 1.0). The acceleration
+ * curve is a lookup table of gains indexed by report speed, linearly interpolated between
+ * entries. Motion is accumulated in 1/256 pixel units and the fraction that does not make
+ * a whole pixel is carried into the next report, so slow movements are not lost.
+ *
+ * The processor keeps no time of its own; speed is measured per report, in counts.
+ */
+class UsbHidPointerProcessor
+{
+public:
+    /// Fractional bits of gains and of the sub-pixel accumulators
+    static constexpr int FRACTION_BITS = 8;
+    /// Gain of 1.0 in Q8.8
+    static constexpr uint16_t UNITY_GAIN = 1 << FRACTION_BITS;
+    /// Number of entries in an acceleration curve
+    static constexpr size_t CURVE_POINTS = 16;
+
+    /// Gains in Q8.8, entry i applies at speed i * speedStep counts per report
+    using Curve = std::array<uint16_t, CURVE_POINTS>;
+
+    /**
+     * @typedef PointerCallback
+     * @brief Function called when the cursor moves.
+     */
+    using PointerCallback = std::function<void(const UsbHidPointerEvent&)>;
+
+    /**
+     * @struct Viewport
+     * @brief Rectangle the cursor is clamped to.
+     */
+    struct Viewport
+    {
+        int32_t x      = 0;
+        int32_t y      = 0;
+        int32_t width  = 320;
+        int32_t height = 240;
+    };
+
+    /**
+     * @struct Config
+     * @brief Sensitivity, acceleration and viewport.
+     */
+    struct Config
+    {
+        uint16_t sensitivity = UNITY_GAIN;  ///< Base gain in Q8.8
+        Curve curve          = flatCurve(); ///< Acceleration gains in Q8.8
+        uint16_t speedStep   = 2;           ///< Speed in counts per report between curve entries
+        Viewport viewport;
+    };
+
+    /**
+     * @brief A curve without acceleration.
+     */
+    static constexpr Curve flatCurve()
+    {
+        Curve curve{};
+        for (auto& gain : curve) gain = UNITY_GAIN;
+        return curve;
+    }
+
+    /**
+     * @brief A curve rising linearly from lowGain to highGain between two entries.
+     *
+     * @param lowGain Gain in Q8.8 up to entry from.
+     * @param highGain Gain in Q8.8 from entry to on.
+     * @param from First entry of the ramp.
+     * @param to Last entry of the ramp, greater than from.
+     */
+    static constexpr Curve rampCurve(uint16_t lowGain, uint16_t highGain, size_t from, size_t to)
+    {
+        Curve curve{};
+        for (size_t i = 0; i < CURVE_POINTS; ++i)
+        {
+            if (i <= from)
+            {
+                curve[i] = lowGain;
+            }
+            else if (i >= to)
+            {
+                curve[i] = highGain;
+            }
+            else
+            {
+                curve[i] = static_cast<uint16_t>(lowGain + (int32_t(highGain) - lowGain) * int32_t(i - from) / int32_t(to - from));
+            }
+        }
+        return curve;
+    }
+
+    /**
+     * @brief Construct a new UsbHidPointerProcessor object with the default configuration.
+     */
+    UsbHidPointerProcessor();
+
+    /**
+     * @brief Construct a new UsbHidPointerProcessor object, cursor centred in the viewport.
+     */
+    explicit UsbHidPointerProcessor(const Config& config);
+
+    /**
+     * @brief Change the configuration. The cursor is clamped to the new viewport.
+     */
+    void setConfig(const Config& config);
+
+    /**
+     * @brief Get the configuration.
+     */
+    const Config& getConfig() const { return config_; }
+
+    /**
+     * @brief Move the cursor to an absolute position, clamped to the viewport.
+     */
+    void setPosition(int32_t x, int32_t y);
+
+    int32_t getX() const { return x_; }
+    int32_t getY() const { return y_; }
+
+    /**
+     * @brief Register the function called when the cursor moves.
+     */
+    void registerCallback(PointerCallback callback) { callback_ = std::move(callback); }
+
+    /**
+     * @brief Apply one relative motion report.
+     *
+     * @param dx Relative X in device counts.
+     * @param dy Relative Y in device counts.
+     * @param deviceType Device the motion came from.
+     * @return true if the cursor moved.
+     */
+    bool move(int32_t dx, int32_t dy, UsbHidDeviceType deviceType = UsbHidDeviceType::Mouse);
+
+    /**
+     * @brief Feed a mouse event.
+     */
+    void onMouseEvent(const UsbHidMouseEvent& event) { move(event.x_delta, event.y_delta, UsbHidDeviceType::Mouse); }
+
+    /**
+     * @brief Feed a G20s Pro event; only its motion is used.
+     */
+    void onRemoteEvent(const UsbHidG20sProEvent& event) { move(event.mouseX, event.mouseY, UsbHidDeviceType::G20sPro); }
+
+    /**
+     * @brief Get the gain the curve applies at a speed.
+     *
+     * @param speed Speed in counts per report.
+     * @return uint32_t Gain in Q8.8.
+     */
+    uint32_t curveGain(uint32_t speed) const;
+
+private:
+    Config config_;
+    PointerCallback callback_;
+    int32_t x_;
+    int32_t y_;
+    int32_t remainderX_;  ///< Sub-pixel motion carried over, in 1/256 pixel
+    int32_t remainderY_;  ///< Sub-pixel motion carried over, in 1/256 pixel
+
+    static int32_t clamp(int32_t value, int32_t origin, int32_t size);
+};
@@ -0,0 +1,157 @@
+/**
+ * @file UsbHidRemoteProfile.cpp
+ * @brief Implements UsbHidRemoteProfileImage, which loads vendor remote profiles from binary images.
+ */
+
+#include "UsbHidRemoteProfile.h"
+
+#include <esp_log.h>
+
+namespace
+{
+constexpr const char* TAG = "RemoteProfile";
+
+/**
+ * @class ImageReader
+ * @brief Bounds-checked little-endian reader over an image.
+ */
+class ImageReader
+{
+public:
+    ImageReader(const uint8_t* data, size_t length) : data_(data), length_(length), offset_(0), ok_(true) {}
+
+    uint8_t u8()
+    {
+        if (!need(1))
+        {
+            return 0;
+        }
+        return data_[offset_++];
+    }
+
+    uint16_t u16()
+    {
+        const uint8_t low  = u8();
+        const uint8_t high = u8();
+        return static_cast<uint16_t>(low | (high << 8));
+    }
+
+    std::string string()
+    {
+        const uint8_t size = u8();
+        if (!need(size))
+        {
+            return {};
+        }
+        std::string value(reinterpret_cast<const char*>(data_ + offset_), size);
+        offset_ += size;
+        return value;
+    }
+
+    bool ok() const { return ok_; }
+    bool atEnd() const { return offset_ == length_; }
+
+private:
+    const uint8_t* data_;
+    size_t length_;
+    size_t offset_;
+    bool ok_;
+
+    bool need(size_t size)
+    {
+        ok_ = ok_ && length_ - offset_ >= size;
+        return ok_;
+    }
+};
+}  // namespace
+
+UsbHidRemoteProfileImage::UsbHidRemoteProfileImage()
+    : profile_{},
+      frozen_(false)
+{
+    profile_.mouseLeft    = UsbHidRemoteProfile::NO_BUTTON;
+    profile_.mouseRight   = UsbHidRemoteProfile::NO_BUTTON;
+    profile_.motionFilter = UsbHidMotionFilter::Config::passthrough();
+}
+
+bool UsbHidRemoteProfileImage::load(const uint8_t* data, size_t length)
+{
+    if (frozen_)
+    {
+        ESP_LOGE(TAG, "Profile \"%.*s\" is in use and cannot be replaced", static_cast<int>(profile_.name.size()),
+                 profile_.name.data());
+        return false;
+    }
+
+    ImageReader reader(data, length);
+    if (reader.u8() != 'R' || reader.u8() != 'P' || reader.u8() != VERSION)
+    {
+        ESP_LOGE(TAG, "Not a version %u remote profile image", VERSION);
+        return false;
+    }
+
+    UsbHidRemoteProfile profile{};
+    profile.vid                    = reader.u16();
+    profile.pid                    = reader.u16();
+    const uint8_t signatureCount   = reader.u8();
+    const uint8_t codeCount        = reader.u8();
+    const uint8_t buttonCount      = reader.u8();
+    profile.mouseLeft              = reader.u8();
+    profile.mouseRight             = reader.u8();
+    profile.motionFilter.deadZone  = reader.u16();
+    profile.motionFilter.minAlpha  = reader.u16();
+    profile.motionFilter.maxAlpha  = reader.u16();
+    profile.motionFilter.speedLow  = reader.u16();
+    profile.motionFilter.speedHigh = reader.u16();
+
+    std::vector<UsbHidRemoteProfile::Signature> signatures(signatureCount);
+    for (auto& signature : signatures)
+    {
+        signature.reportId = reader.u8();
+        signature.length   = reader.u8();
+        const uint8_t kind = reader.u8();
+        if (kind > static_cast<uint8_t>(UsbHidRemoteReportKind::Mouse))
+        {
+            ESP_LOGE(TAG, "Unknown report kind %u", kind);
+            return false;
+        }
+        signature.kind = static_cast<UsbHidRemoteReportKind>(kind);
+    }
+
+    std::vector<UsbHidRemoteProfile::Code> codes(codeCount);
+    for (auto& code : codes)
+    {
+        code.reportId = reader.u8();
+        code.code     = reader.u8();
+        code.button   = reader.u8();
+    }
+
+    // Sized up front: the views below point into these strings, so they must never move
+    std::vector<std::string> nameStorage;
+    nameStorage.reserve(buttonCount + 1);
+    for (uint8_t i = 0; i <= buttonCount; ++i)
+    {
+        nameStorage.push_back(reader.string());
+    }
+
+    if (!reader.ok() || !reader.atEnd())
+    {
+        ESP_LOGE(TAG, "Truncated or oversized remote profile image (%u bytes)", static_cast<unsigned>(length));
+        return false;
+    }
+
+    signatures_  = std::move(signatures);
+    codes_       = std::move(codes);
+    nameStorage_ = std::move(nameStorage);
+    buttonNames_.assign(nameStorage_.begin(), nameStorage_.begin() + buttonCount);
+
+    profile.name           = nameStorage_.back();
+    profile.signatures     = signatures_.data();
+    profile.signatureCount = signatures_.size();
+    profile.codes          = codes_.data();
+    profile.codeCount      = codes_.size();
+    profile.buttonNames    = buttonNames_.data();
+    profile.buttonCount    = buttonNames_.size();
+    profile_               = profile;
+    return true;
+}
@@ -0,0 +1,327 @@
+/**
+ * @file UsbHidRemoteProfile.h
+ * @brief Defines vendor remote profiles and the UsbHidRemoteDecoder tables compiled from them.
+ */
+
+#pragma once
+
+#include "UsbHidMotionFilter.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @enum UsbHidRemoteReportKind
+ * @brief Layout of a vendor remote report.
+ */
+enum class UsbHidRemoteReportKind : uint8_t
+{
+    Buttons,  ///< Up to two non-zero code bytes after the report ID; all zero is a release
+    Mouse     ///< Buttons byte, X and Y as int8 (after the report ID, if any)
+};
+
+/**
+ * @struct UsbHidRemoteProfile
+ * @brief Describes a vendor air remote: which device it is, how to recognise its reports
+ *        and which button each code stands for.
+ *
+ * Profiles are plain tables, written as constexpr data or loaded at runtime with
+ * UsbHidRemoteProfileImage. Buttons are numbered by the profile, 0 to buttonCount - 1.
+ */
+struct UsbHidRemoteProfile
+{
+    /// Signature report ID of reports that carry no ID; they are recognised by length alone
+    static constexpr uint8_t ANY_REPORT_ID = 0;
+    /// Button number meaning "no button"
+    static constexpr uint8_t NO_BUTTON = 0xFF;
+
+    /**
+     * @struct Signature
+     * @brief Report ID and length that identify one kind of report.
+     */
+    struct Signature
+    {
+        uint8_t reportId;  ///< ANY_REPORT_ID to match on length only
+        uint8_t length;    ///< Report length in bytes, including the report ID
+        UsbHidRemoteReportKind kind;
+    };
+
+    /**
+     * @struct Code
+     * @brief A button and the report ID and first code byte it is sent with.
+     */
+    struct Code
+    {
+        uint8_t reportId;
+        uint8_t code;
+        uint8_t button;
+    };
+
+    std::string_view name;
+    uint16_t vid;
+    uint16_t pid;
+    const Signature* signatures;
+    size_t signatureCount;
+    const Code* codes;
+    size_t codeCount;
+    const std::string_view* buttonNames;  ///< Indexed by button number
+    size_t buttonCount;
+    uint8_t mouseLeft;   ///< Button for bit 0 of mouse reports, NO_BUTTON if none
+    uint8_t mouseRight;  ///< Button for bit 1 of mouse reports, NO_BUTTON if none
+    UsbHidMotionFilter::Config motionFilter;
+};
+
+/**
+ * @class UsbHidRemoteDecoder
+ * @brief A UsbHidRemoteProfile compiled into constant-time lookup tables.
+ *
+ * Classifying a report is one lookup by report ID and, failing that, one by length;
+ * decoding a code is one lookup in a 256-entry table per button report. The decoder is a
+ * literal type, so built-in profiles compile at compile time into flash; profiles loaded
+ * at runtime compile into the same tables.
+ *
+ * The decoder keeps its own copy of the profile and of its signature and button name
+ * tables, so the profile passed in may be a temporary. Only the characters of the
+ * profile and button names are still referred to and must outlive the decoder; string
+ * literals and a UsbHidRemoteProfileImage, which freezes once handed out, both do.
+ */
+class UsbHidRemoteDecoder
+{
+public:
+    static constexpr size_t MAX_SIGNATURES     = 8;   ///< Signatures per profile
+    static constexpr size_t MAX_BUTTON_REPORTS = 4;   ///< Button report IDs per profile
+    static constexpr size_t MAX_BUTTONS        = 32;  ///< Buttons per profile
+    static constexpr size_t MAX_LENGTH         = 64;  ///< Longest report a signature can match
+
+    /// Returned by classify() and reportSlot() when nothing matches
+    static constexpr uint8_t NONE = 0xFF;
+
+    /**
+     * @brief Compile a profile. Check isValid() before use.
+     */
+    constexpr explicit UsbHidRemoteDecoder(const UsbHidRemoteProfile& profile);
+
+    /**
+     * @brief Check that the profile fits the decoder limits and is unambiguous.
+     */
+    constexpr bool isValid() const { return valid_; }
+
+    /**
+     * @brief Get the decoder's copy of the profile.
+     *
+     * The tables are compiled into the decoder, so the copy's signature, code and button
+     * name pointers are cleared; use classify() and buttonName() instead.
+     */
+    const UsbHidRemoteProfile& getProfile() const { return profile_; }
+
+    bool matches(uint16_t vid, uint16_t pid) const { return profile_.vid == vid && profile_.pid == pid; }
+
+    /**
+     * @brief Find the signature a report matches.
+     *
+     * @return const UsbHidRemoteProfile::Signature* The signature, nullptr if none matches.
+     */
+    constexpr const UsbHidRemoteProfile::Signature* classify(const uint8_t* data, size_t length) const
+    {
+        if (length == 0 || length > MAX_LENGTH)
+        {
+            return nullptr;
+        }
+        uint8_t index = byReportId_[data[0]];
+        if (index == NONE || signatures_[index].length != length)
+        {
+            index = byLength_[length];
+        }
+        return index == NONE ? nullptr : &signatures_[index];
+    }
+
+    /**
+     * @brief Get the row of a button report ID, for per-report state.
+     *
+     * @return uint8_t 0 to MAX_BUTTON_REPORTS - 1, NONE if the report ID carries no buttons.
+     */
+    constexpr uint8_t reportSlot(uint8_t reportId) const { return slots_[reportId]; }
+
+    /**
+     * @brief Get the button for a code.
+     *
+     * @return uint8_t The button, UsbHidRemoteProfile::NO_BUTTON if the code is unknown.
+     */
+    constexpr uint8_t buttonFromCode(uint8_t reportId, uint8_t code) const
+    {
+        const uint8_t slot = slots_[reportId];
+        return slot == NONE ? UsbHidRemoteProfile::NO_BUTTON : codes_[slot][code];
+    }
+
+    /**
+     * @brief Get the name of a button, "Unknown" if it has none.
+     */
+    std::string_view buttonName(uint8_t button) const
+    {
+        return button < profile_.buttonCount ? buttonNames_[button] : std::string_view("Unknown");
+    }
+
+private:
+    UsbHidRemoteProfile profile_;
+    bool valid_;
+    std::array<UsbHidRemoteProfile::Signature, MAX_SIGNATURES> signatures_;
+    std::array<std::string_view, MAX_BUTTONS> buttonNames_;
+    std::array<uint8_t, 256> byReportId_;           ///< Report ID to signature, for signatures with an ID
+    std::array<uint8_t, MAX_LENGTH + 1> byLength_;  ///< Length to signature, for ANY_REPORT_ID signatures
+    std::array<uint8_t, 256> slots_;                ///< Report ID to row of codes_
+    std::array<std::array<uint8_t, 256>, MAX_BUTTON_REPORTS> codes_;
+};
+
+constexpr UsbHidRemoteDecoder::UsbHidRemoteDecoder(const UsbHidRemoteProfile& profile)
+    : profile_(profile),
+      valid_(true),
+      signatures_{},
+      buttonNames_{},
+      byReportId_{},
+      byLength_{},
+      slots_{},
+      codes_{}
+{
+    for (auto& index : byReportId_) index = NONE;
+    for (auto& index : byLength_) index = NONE;
+    for (auto& slot : slots_) slot = NONE;
+    for (auto& row : codes_)
+    {
+        for (auto& button : row) button = UsbHidRemoteProfile::NO_BUTTON;
+    }
+
+    // Only the copy of the tables is used from here on, the caller's may go away
+    profile_.signatures     = nullptr;
+    profile_.signatureCount = 0;
+    profile_.codes          = nullptr;
+    profile_.codeCount      = 0;
+    profile_.buttonNames    = nullptr;
+
+    if (profile.signatureCount > MAX_SIGNATURES || profile.buttonCount > MAX_BUTTONS)
+    {
+        valid_ = false;
+        return;
+    }
+    for (size_t i = 0; i < profile.signatureCount; ++i)
+    {
+        signatures_[i] = profile.signatures[i];
+    }
+    for (size_t i = 0; i < profile.buttonCount; ++i)
+    {
+        buttonNames_[i] = profile.buttonNames[i];
+    }
+
+    // One signature per report ID, and per length among reports without an ID
+    size_t slotCount = 0;
+    for (size_t i = 0; i < profile.signatureCount; ++i)
+    {
+        const UsbHidRemoteProfile::Signature& signature = profile.signatures[i];
+        if (signature.length == 0 || signature.length > MAX_LENGTH)
+        {
+            valid_ = false;
+            return;
+        }
+
+        uint8_t& index = signature.reportId == UsbHidRemoteProfile::ANY_REPORT_ID ? byLength_[signature.length]
+                                                                                 : byReportId_[signature.reportId];
+        if (index != NONE)
+        {
+            valid_ = false;
+            return;
+        }
+        index = static_cast<uint8_t>(i);
+
+        if (signature.kind == UsbHidRemoteReportKind::Buttons)
+        {
+            // Codes are looked up by report ID, so button reports must carry one
+            if (signature.reportId == UsbHidRemoteProfile::ANY_REPORT_ID || slotCount == MAX_BUTTON_REPORTS)
+            {
+                valid_ = false;
+                return;
+            }
+            slots_[signature.reportId] = static_cast<uint8_t>(slotCount++);
+        }
+    }
+
+    // Every code must belong to a button report and name a button, and no code may be taken twice
+    for (size_t i = 0; i < profile.codeCount; ++i)
+    {
+        const UsbHidRemoteProfile::Code& code = profile.codes[i];
+        const uint8_t slot                    = slots_[code.reportId];
+        if (slot == NONE || code.button >= profile.buttonCount || codes_[slot][code.code] != UsbHidRemoteProfile::NO_BUTTON)
+        {
+            valid_ = false;
+            return;
+        }
+        codes_[slot][code.code] = code.button;
+    }
+
+    if ((profile.mouseLeft != UsbHidRemoteProfile::NO_BUTTON && profile.mouseLeft >= profile.buttonCount) ||
+        (profile.mouseRight != UsbHidRemoteProfile::NO_BUTTON && profile.mouseRight >= profile.buttonCount))
+    {
+        valid_ = false;
+    }
+}
+
+/**
+ * @class UsbHidRemoteProfileImage
+ * @brief A UsbHidRemoteProfile loaded from a compact binary image, e.g. read from flash or a file.
+ *
+ * Image layout, multi-byte values little-endian:
+ * | Field                        | Size                                                  |
+ * | ---------------------------- | ----------------------------------------------------- |
+ * | Magic "RP", version 1        | 3                                                     |
+ * | VID, PID                     | 2 + 2                                                 |
+ * | Signature, code, button count| 1 + 1 + 1                                             |
+ * | Mouse left, mouse right      | 1 + 1                                                 |
+ * | Motion filter                | 5 x 2: dead zone, min/max alpha, low/high speed       |
+ * | Signatures                   | 3 each: report ID, length, kind (0 buttons, 1 mouse)  |
+ * | Codes                        | 3 each: report ID, code, button                       |
+ * | Button names                 | 1 + n each: length, bytes                             |
+ * | Profile name                 | 1 + n: length, bytes                                  |
+ *
+ * The image owns the tables its profile points to. Once the profile has been handed out
+ * with getProfile(), e.g. to compile a UsbHidRemoteDecoder, the image is frozen and load()
+ * refuses to replace it, so the names the decoder refers to stay valid.
+ */
+class UsbHidRemoteProfileImage
+{
+public:
+    static constexpr uint8_t VERSION = 1;
+
+    UsbHidRemoteProfileImage();
+
+    // The profile points into the image's own storage
+    UsbHidRemoteProfileImage(const UsbHidRemoteProfileImage&)            = delete;
+    UsbHidRemoteProfileImage& operator=(const UsbHidRemoteProfileImage&) = delete;
+
+    /**
+     * @brief Parse an image.
+     *
+     * @return true if the image is well formed; false, keeping the previous profile, if it
+     *         is not or the image is frozen.
+     */
+    bool load(const uint8_t* data, size_t length);
+
+    /**
+     * @brief Get the loaded profile. Freezes the image, see load().
+     */
+    const UsbHidRemoteProfile& getProfile() const
+    {
+        frozen_ = true;
+        return profile_;
+    }
+
+    bool isFrozen() const { return frozen_; }
+
+private:
+    UsbHidRemoteProfile profile_;
+    mutable bool frozen_;  ///< Set once the profile was handed out
+    std::vector<UsbHidRemoteProfile::Signature> signatures_;
+    std::vector<UsbHidRemoteProfile::Code> codes_;
+    std::vector<std::string> nameStorage_;  ///< Button names, then the profile name
+    std::vector<std::string_view> buttonNames_;
+};
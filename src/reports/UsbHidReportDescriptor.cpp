@@ -0,0 +1,456 @@
+/**
+ * @file UsbHidReportDescriptor.cpp
+ * @brief Implements the UsbHidReportDescriptor class for parsing USB HID report descriptors.
+ */
+
+#include "UsbHidReportDescriptor.h"
+
+#include <cinttypes>
+
+#include <esp_log.h>
+
+namespace
+{
+constexpr const char* TAG = "ReportDescriptor";
+
+// Item types, see 6.2.2.2 Short Items of the HID 1.11 specification
+constexpr uint8_t ITEM_TYPE_MAIN   = 0;
+constexpr uint8_t ITEM_TYPE_GLOBAL = 1;
+constexpr uint8_t ITEM_TYPE_LOCAL  = 2;
+
+// Main item tags
+constexpr uint8_t MAIN_INPUT          = 0x8;
+constexpr uint8_t MAIN_OUTPUT         = 0x9;
+constexpr uint8_t MAIN_COLLECTION     = 0xA;
+constexpr uint8_t MAIN_FEATURE        = 0xB;
+constexpr uint8_t MAIN_END_COLLECTION = 0xC;
+
+// Global item tags
+constexpr uint8_t GLOBAL_USAGE_PAGE   = 0x0;
+constexpr uint8_t GLOBAL_LOGICAL_MIN  = 0x1;
+constexpr uint8_t GLOBAL_LOGICAL_MAX  = 0x2;
+constexpr uint8_t GLOBAL_REPORT_SIZE  = 0x7;
+constexpr uint8_t GLOBAL_REPORT_ID    = 0x8;
+constexpr uint8_t GLOBAL_REPORT_COUNT = 0x9;
+constexpr uint8_t GLOBAL_PUSH         = 0xA;
+constexpr uint8_t GLOBAL_POP          = 0xB;
+
+// Local item tags
+constexpr uint8_t LOCAL_USAGE     = 0x0;
+constexpr uint8_t LOCAL_USAGE_MIN = 0x1;
+constexpr uint8_t LOCAL_USAGE_MAX = 0x2;
+
+constexpr uint8_t LONG_ITEM_PREFIX = 0xFE;
+
+/// Collection item data of an application collection
+constexpr uint32_t COLLECTION_APPLICATION = 0x01;
+
+/// Largest report the parser accepts, in bits
+constexpr uint32_t MAX_REPORT_BITS = 0xFFFF;
+
+/// Largest number of explicit usages kept for one main item
+constexpr size_t MAX_LOCAL_USAGES = 64;
+
+/// Deepest push stack the parser accepts
+constexpr size_t MAX_PUSH_DEPTH = 8;
+
+/// Deepest collection nesting the parser accepts
+constexpr size_t MAX_COLLECTION_DEPTH = 16;
+
+/**
+ * @struct GlobalState
+ * @brief Global item state, saved and restored as a whole by push and pop.
+ */
+struct GlobalState
+{
+    uint16_t usagePage  = 0;
+    int32_t logicalMin  = 0;
+    int32_t logicalMax  = 0;
+    uint8_t reportSize  = 0;
+    uint16_t reportCnt  = 0;
+    uint8_t reportId    = 0;
+    uint8_t logicalSize = 0;  ///< Byte size of the logical maximum item, used to fix up unsigned ranges
+};
+
+int32_t signExtend(uint32_t value, uint8_t size)
+{
+    switch (size)
+    {
+    case 1:
+        return static_cast<int8_t>(value);
+    case 2:
+        return static_cast<int16_t>(value);
+    default:
+        return static_cast<int32_t>(value);
+    }
+}
+}  // namespace
+
+int32_t UsbHidReportField::extract(const uint8_t* payload, size_t length, uint16_t index) const
+{
+    const uint32_t bit   = bitOffset + static_cast<uint32_t>(index) * bitSize;
+    const size_t first   = bit / 8;
+    const uint32_t shift = bit % 8;
+    const size_t bytes   = (shift + bitSize + 7) / 8;
+
+    if (first + bytes > length)
+    {
+        return 0;
+    }
+
+    uint64_t window = 0;
+    for (size_t b = 0; b < bytes; ++b)
+    {
+        window |= static_cast<uint64_t>(payload[first + b]) << (8 * b);
+    }
+
+    uint32_t value = static_cast<uint32_t>(window >> shift);
+    if (bitSize < 32)
+    {
+        value &= (1u << bitSize) - 1;
+        if (isSigned() && (value & (1u << (bitSize - 1))))
+        {
+            value |= ~((1u << bitSize) - 1);
+        }
+    }
+    return static_cast<int32_t>(value);
+}
+
+bool UsbHidReportDescriptor::parse(const uint8_t* data, size_t length)
+{
+    fields_.clear();
+    extents_.clear();
+    applications_.clear();
+    usesReportIds_ = false;
+
+    if (data == nullptr)
+    {
+        return false;
+    }
+
+    // Global state, with the stack of pushed states
+    GlobalState global;
+    GlobalState pushed[MAX_PUSH_DEPTH];
+    size_t pushDepth = 0;
+
+    size_t collectionDepth     = 0;
+    uint8_t currentApplication = UsbHidReportField::NO_APPLICATION;
+
+    // Local state
+    std::vector<uint32_t> usages;
+    uint32_t usageMin = 0;
+    uint32_t usageMax = 0;
+    bool hasRange     = false;
+
+    size_t pos = 0;
+    while (pos < length)
+    {
+        const uint8_t prefix = data[pos++];
+
+        if (prefix == LONG_ITEM_PREFIX)
+        {
+            // Long items carry no information we use, skip them
+            if (pos + 2 > length)
+            {
+                ESP_LOGW(TAG, "Truncated long item at %u", static_cast<unsigned>(pos));
+                return false;
+            }
+            pos += 2 + data[pos];
+            continue;
+        }
+
+        const uint8_t size = (prefix & 0x03) == 3 ? 4 : (prefix & 0x03);
+        const uint8_t type = (prefix >> 2) & 0x03;
+        const uint8_t tag  = prefix >> 4;
+
+        if (pos + size > length)
+        {
+            ESP_LOGW(TAG, "Truncated item 0x%02X at %u", prefix, static_cast<unsigned>(pos));
+            return false;
+        }
+
+        uint32_t value = 0;
+        for (uint8_t i = 0; i < size; ++i)
+        {
+            value |= static_cast<uint32_t>(data[pos + i]) << (8 * i);
+        }
+        pos += size;
+
+        switch (type)
+        {
+        case ITEM_TYPE_MAIN:
+        {
+            UsbHidReportType reportType;
+            if (tag == MAIN_INPUT)
+                reportType = UsbHidReportType::Input;
+            else if (tag == MAIN_OUTPUT)
+                reportType = UsbHidReportType::Output;
+            else if (tag == MAIN_FEATURE)
+                reportType = UsbHidReportType::Feature;
+            else
+            {
+                if (tag == MAIN_COLLECTION && ++collectionDepth > MAX_COLLECTION_DEPTH)
+                {
+                    ESP_LOGW(TAG, "Collections nested too deep at %u", static_cast<unsigned>(pos));
+                    return false;
+                }
+                if (tag == MAIN_END_COLLECTION && collectionDepth-- == 0)
+                {
+                    ESP_LOGW(TAG, "End collection without collection at %u", static_cast<unsigned>(pos));
+                    return false;
+                }
+
+                if (tag == MAIN_COLLECTION && collectionDepth == 1 && (value & 0xFF) == COLLECTION_APPLICATION &&
+                    applications_.size() < MAX_APPLICATIONS)
+                {
+                    // The collection is named by its first usage
+                    const uint32_t usage = !usages.empty() ? usages.front() : (hasRange ? usageMin : 0);
+                    applications_.push_back({usage > 0xFFFF ? static_cast<uint16_t>(usage >> 16) : global.usagePage,
+                                             static_cast<uint16_t>(usage)});
+                    currentApplication = static_cast<uint8_t>(applications_.size() - 1);
+                }
+                else if (tag == MAIN_END_COLLECTION && collectionDepth == 0)
+                {
+                    currentApplication = UsbHidReportField::NO_APPLICATION;
+                }
+
+                // Collections and end collections only reset the local state
+                usages.clear();
+                hasRange = false;
+                break;
+            }
+
+            if (global.reportSize == 0 || global.reportSize > 32)
+            {
+                ESP_LOGW(TAG, "Unsupported report size %u", global.reportSize);
+                return false;
+            }
+
+            uint32_t& bits        = extentBits(reportType, global.reportId);
+            const uint32_t offset = bits;
+            bits += static_cast<uint32_t>(global.reportSize) * global.reportCnt;
+            if (bits > MAX_REPORT_BITS)
+            {
+                ESP_LOGW(TAG, "Report 0x%02X too large", global.reportId);
+                return false;
+            }
+
+            UsbHidReportField field;
+            field.type       = reportType;
+            field.reportId    = global.reportId;
+            field.application = currentApplication;
+            field.flags       = static_cast<uint16_t>(value);
+            field.usagePage  = global.usagePage;
+            field.bitOffset  = static_cast<uint16_t>(offset);
+            field.bitSize    = global.reportSize;
+            field.count      = global.reportCnt;
+            field.logicalMin = global.logicalMin;
+            field.logicalMax = global.logicalMax;
+
+            // Constant items are padding, they only move the offset
+            if (!field.isConstant() && global.reportCnt > 0)
+            {
+                // Extended usages carry their own page in the upper 16 bits
+                auto pageOf = [&global](uint32_t usage)
+                { return usage > 0xFFFF ? static_cast<uint16_t>(usage >> 16) : global.usagePage; };
+
+                if (field.isVariable() && !hasRange && !usages.empty())
+                {
+                    // One field per element, the last usage repeats for the remaining elements
+                    field.count = 1;
+                    for (uint16_t i = 0; i < global.reportCnt && fields_.size() < MAX_FIELDS; ++i)
+                    {
+                        const uint32_t usage = usages[i < usages.size() ? i : usages.size() - 1];
+                        field.usagePage      = pageOf(usage);
+                        field.usageMin       = static_cast<uint16_t>(usage);
+                        field.usageMax       = static_cast<uint16_t>(usage);
+                        field.bitOffset      = static_cast<uint16_t>(offset + i * global.reportSize);
+                        fields_.push_back(field);
+                    }
+                }
+                else if (fields_.size() < MAX_FIELDS)
+                {
+                    uint32_t first = hasRange ? usageMin : (usages.empty() ? 0 : usages.front());
+                    uint32_t last  = hasRange ? usageMax : (usages.empty() ? 0 : usages.back());
+                    if (field.isVariable() && (last - first + 1) > global.reportCnt)
+                    {
+                        last = first + global.reportCnt - 1;
+                    }
+                    field.usagePage = pageOf(first);
+                    field.usageMin  = static_cast<uint16_t>(first);
+                    field.usageMax  = static_cast<uint16_t>(last);
+                    fields_.push_back(field);
+                }
+            }
+
+            usages.clear();
+            hasRange = false;
+            break;
+        }
+
+        case ITEM_TYPE_GLOBAL:
+            switch (tag)
+            {
+            case GLOBAL_USAGE_PAGE:
+                global.usagePage = static_cast<uint16_t>(value);
+                break;
+            case GLOBAL_LOGICAL_MIN:
+                global.logicalMin = signExtend(value, size);
+                break;
+            case GLOBAL_LOGICAL_MAX:
+                global.logicalMax  = signExtend(value, size);
+                global.logicalSize = size;
+                break;
+            case GLOBAL_REPORT_SIZE:
+                global.reportSize = value > 32 ? 0 : static_cast<uint8_t>(value);
+                break;
+            case GLOBAL_REPORT_ID:
+                if (value == 0 || value > 0xFF)
+                {
+                    ESP_LOGW(TAG, "Invalid report ID %" PRIu32, value);
+                    return false;
+                }
+                global.reportId = static_cast<uint8_t>(value);
+                usesReportIds_  = true;
+                break;
+            case GLOBAL_REPORT_COUNT:
+                if (value > MAX_REPORT_BITS)
+                {
+                    ESP_LOGW(TAG, "Invalid report count %" PRIu32, value);
+                    return false;
+                }
+                global.reportCnt = static_cast<uint16_t>(value);
+                break;
+            case GLOBAL_PUSH:
+                if (pushDepth == MAX_PUSH_DEPTH)
+                {
+                    ESP_LOGW(TAG, "Push stack overflow at %u", static_cast<unsigned>(pos));
+                    return false;
+                }
+                pushed[pushDepth++] = global;
+                break;
+            case GLOBAL_POP:
+                if (pushDepth == 0)
+                {
+                    ESP_LOGW(TAG, "Pop without push at %u", static_cast<unsigned>(pos));
+                    return false;
+                }
+                global = pushed[--pushDepth];
+                break;
+            default:
+                // Physical extents and units do not affect field layout
+                break;
+            }
+
+            // A maximum that only looks negative because of the sign bit is an unsigned range
+            if ((tag == GLOBAL_LOGICAL_MIN || tag == GLOBAL_LOGICAL_MAX) && global.logicalMax < global.logicalMin &&
+                global.logicalSize > 0 && global.logicalSize < 4)
+            {
+                global.logicalMax = static_cast<int32_t>(static_cast<uint32_t>(global.logicalMax) & ((1u << (8 * global.logicalSize)) - 1));
+            }
+            break;
+
+        case ITEM_TYPE_LOCAL:
+            switch (tag)
+            {
+            case LOCAL_USAGE:
+                if (usages.size() < MAX_LOCAL_USAGES)
+                {
+                    usages.push_back(value);
+                }
+                break;
+            case LOCAL_USAGE_MIN:
+                usageMin = value;
+                hasRange = true;
+                break;
+            case LOCAL_USAGE_MAX:
+                usageMax = value;
+                hasRange = true;
+                break;
+            default:
+                // Designators and strings are not used
+                break;
+            }
+            break;
+
+        default:
+            ESP_LOGW(TAG, "Reserved item type at %u", static_cast<unsigned>(pos));
+            return false;
+        }
+    }
+
+    if (collectionDepth != 0)
+    {
+        // Some devices omit the final end collection; the fields are still complete
+        ESP_LOGW(TAG, "%u collection(s) left open", static_cast<unsigned>(collectionDepth));
+    }
+
+    return !fields_.empty();
+}
+
+const UsbHidReportField* UsbHidReportDescriptor::findField(UsbHidReportType type, uint16_t usagePage, uint16_t usage) const
+{
+    for (const auto& field : fields_)
+    {
+        if (field.type == type && field.hasUsage(usagePage, usage))
+        {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+size_t UsbHidReportDescriptor::reportSize(UsbHidReportType type, uint8_t reportId) const
+{
+    for (const auto& extent : extents_)
+    {
+        if (extent.type == type && extent.reportId == reportId)
+        {
+            return (extent.bits + 7) / 8;
+        }
+    }
+    return 0;
+}
+
+UsbHidReportDescriptor UsbHidReportDescriptor::inputReport(uint8_t reportId) const
+{
+    static_assert(MAX_APPLICATIONS <= 32, "applications are tracked in a 32-bit mask");
+
+    UsbHidReportDescriptor report;
+    report.extents_       = extents_;
+    report.applications_  = applications_;
+    report.usesReportIds_ = usesReportIds_;
+
+    uint32_t owners = 0;  // Applications with fields in the input report
+    for (const auto& field : fields_)
+    {
+        if (field.type == UsbHidReportType::Input && field.reportId == reportId &&
+            field.application != UsbHidReportField::NO_APPLICATION)
+        {
+            owners |= 1u << field.application;
+        }
+    }
+
+    for (const auto& field : fields_)
+    {
+        const bool owned = field.application != UsbHidReportField::NO_APPLICATION && (owners & (1u << field.application));
+        if (field.type == UsbHidReportType::Input ? field.reportId == reportId : owned)
+        {
+            report.fields_.push_back(field);
+        }
+    }
+    return report;
+}
+
+uint32_t& UsbHidReportDescriptor::extentBits(UsbHidReportType type, uint8_t reportId)
+{
+    for (auto& extent : extents_)
+    {
+        if (extent.type == type && extent.reportId == reportId)
+        {
+            return extent.bits;
+        }
+    }
+    extents_.push_back({type, reportId, 0});
+    return extents_.back().bits;
+}
@@ -0,0 +1,178 @@
+/**
+ * @file UsbHidReportDescriptor.h
+ * @brief Defines the UsbHidReportDescriptor class for parsing USB HID report descriptors.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @enum UsbHidReportType
+ * @brief Type of report a main item belongs to.
+ */
+enum class UsbHidReportType : uint8_t
+{
+    Input,    ///< Input report (device to host)
+    Output,   ///< Output report (host to device)
+    Feature   ///< Feature report
+};
+
+/**
+ * @struct UsbHidApplicationCollection
+ * @brief A top-level application collection, named by its usage (e.g. Generic Desktop / Keyboard).
+ */
+struct UsbHidApplicationCollection
+{
+    uint16_t usagePage;
+    uint16_t usage;
+};
+
+/**
+ * @struct UsbHidReportField
+ * @brief A run of equally sized elements produced by one main item.
+ *
+ * For variable items every element has its own usage, usageMin + index.
+ * For array items every element holds an index into usageMin..usageMax.
+ */
+struct UsbHidReportField
+{
+    /// Main item data bits
+    static constexpr uint16_t FLAG_CONSTANT = 1 << 0;
+    static constexpr uint16_t FLAG_VARIABLE = 1 << 1;
+    static constexpr uint16_t FLAG_RELATIVE = 1 << 2;
+
+    /// Application index of fields outside any application collection
+    static constexpr uint8_t NO_APPLICATION = 0xFF;
+
+    UsbHidReportType type;  ///< Input, output or feature
+    uint8_t reportId;       ///< Report ID, 0 if the descriptor does not use report IDs
+    uint8_t application;    ///< Index into UsbHidReportDescriptor::applications(), or NO_APPLICATION
+    uint16_t flags;         ///< Main item data bits
+    uint16_t usagePage;     ///< Usage page of the elements
+    uint16_t usageMin;      ///< Usage of the first element (variable) or of logical minimum (array)
+    uint16_t usageMax;      ///< Usage of the last element (variable) or of logical maximum (array)
+    uint16_t bitOffset;     ///< Offset of the first element, not counting the report ID byte
+    uint8_t bitSize;        ///< Size of one element in bits (1 - 32)
+    uint16_t count;         ///< Number of elements
+    int32_t logicalMin;     ///< Logical minimum
+    int32_t logicalMax;     ///< Logical maximum
+
+    bool isConstant() const { return (flags & FLAG_CONSTANT) != 0; }
+    bool isVariable() const { return (flags & FLAG_VARIABLE) != 0; }
+    bool isArray() const { return !isVariable(); }
+    bool isRelative() const { return (flags & FLAG_RELATIVE) != 0; }
+    bool isSigned() const { return logicalMin < 0; }
+
+    /**
+     * @brief Check whether a usage falls inside this field.
+     */
+    bool hasUsage(uint16_t page, uint16_t usage) const
+    {
+        return page == usagePage && usage >= usageMin && usage <= usageMax;
+    }
+
+    /**
+     * @brief Extract one element from a report payload.
+     *
+     * @param payload Report data, not including the report ID byte.
+     * @param length Length of the payload in bytes.
+     * @param index Element index (0 - count-1).
+     * @return int32_t The element value, sign extended if the logical minimum is negative.
+     *         Elements outside the payload read as 0.
+     */
+    int32_t extract(const uint8_t* payload, size_t length, uint16_t index) const;
+};
+
+/**
+ * @class UsbHidReportDescriptor
+ * @brief Parses a HID report descriptor into a list of report fields.
+ *
+ * Supports the global, local and main items needed to locate fields: usage pages,
+ * usages and usage ranges (including extended 32-bit usages), logical extents,
+ * report size/count, report IDs, push/pop of the global state, collection nesting
+ * and the top-level application collections. Malformed descriptors are rejected.
+ */
+class UsbHidReportDescriptor
+{
+public:
+    /// Upper bound on fields kept from one descriptor
+    static constexpr size_t MAX_FIELDS = 256;
+    /// Upper bound on application collections kept from one descriptor
+    static constexpr size_t MAX_APPLICATIONS = 16;
+
+    /**
+     * @brief Parse a report descriptor.
+     *
+     * @param data Pointer to the descriptor.
+     * @param length Length of the descriptor in bytes.
+     * @return true on success, false if the descriptor is malformed.
+     */
+    bool parse(const uint8_t* data, size_t length);
+
+    /**
+     * @brief Get all fields found by the last successful parse.
+     */
+    const std::vector<UsbHidReportField>& fields() const { return fields_; }
+
+    /**
+     * @brief Check whether reports are prefixed with a report ID byte.
+     */
+    bool usesReportIds() const { return usesReportIds_; }
+
+    /**
+     * @brief Get the top-level application collections, in descriptor order.
+     */
+    const std::vector<UsbHidApplicationCollection>& applications() const { return applications_; }
+
+    /**
+     * @brief Find the field of a given type containing a usage.
+     *
+     * @param type Report type to search.
+     * @param usagePage Usage page.
+     * @param usage Usage ID.
+     * @return const UsbHidReportField* The field, or nullptr if none matches.
+     */
+    const UsbHidReportField* findField(UsbHidReportType type, uint16_t usagePage, uint16_t usage) const;
+
+    /**
+     * @brief Get the payload size of a report, not counting the report ID byte.
+     *
+     * @param type Report type.
+     * @param reportId Report ID, 0 if the descriptor does not use report IDs.
+     * @return size_t Size in bytes.
+     */
+    size_t reportSize(UsbHidReportType type, uint8_t reportId) const;
+
+    /**
+     * @brief Get a copy reduced to one input report.
+     *
+     * Keeps the input fields of that report ID, and the output and feature fields of the
+     * application collections they belong to (e.g. the LEDs of a keyboard), so a decoder
+     * configured from it ignores the other collections of a composite descriptor.
+     *
+     * @param reportId Report ID, 0 if the descriptor does not use report IDs.
+     */
+    UsbHidReportDescriptor inputReport(uint8_t reportId) const;
+
+private:
+    /**
+     * @struct ReportExtent
+     * @brief Total size of one report, padding included.
+     */
+    struct ReportExtent
+    {
+        UsbHidReportType type;
+        uint8_t reportId;
+        uint32_t bits;
+    };
+
+    std::vector<UsbHidReportField> fields_;                  ///< Fields in descriptor order
+    std::vector<ReportExtent> extents_;                      ///< Size of every report seen
+    std::vector<UsbHidApplicationCollection> applications_;  ///< Top-level application collections
+    bool usesReportIds_ = false;                             ///< Reports carry a leading report ID byte
+
+    uint32_t& extentBits(UsbHidReportType type, uint8_t reportId);
+};
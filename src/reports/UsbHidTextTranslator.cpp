@@ -0,0 +1,246 @@
+/**
+ * @file UsbHidTextTranslator.cpp
+ * @brief Implements the UsbHidTextTranslator class, which turns keyboard events into text.
+ */
+
+#include "UsbHidTextTranslator.h"
+
+namespace
+{
+using KeyCode  = UsbHidKeyboardReport::KeyCode;
+using Modifier = UsbHidKeyboardReport::Modifier;
+using Led      = UsbHidKeyboardReport::Led;
+
+constexpr uint8_t mask(Modifier modifier)
+{
+    return static_cast<uint8_t>(modifier);
+}
+
+constexpr uint8_t mask(Led led)
+{
+    return static_cast<uint8_t>(led);
+}
+
+constexpr uint8_t key(KeyCode keyCode)
+{
+    return static_cast<uint8_t>(keyCode);
+}
+
+constexpr uint8_t SHIFT_MASK = mask(Modifier::LEFT_SHIFT) | mask(Modifier::RIGHT_SHIFT);
+constexpr uint8_t SHORTCUT_MASK = mask(Modifier::LEFT_CTRL) | mask(Modifier::RIGHT_CTRL) |
+                                  mask(Modifier::LEFT_GUI) | mask(Modifier::RIGHT_GUI) |
+                                  mask(Modifier::LEFT_ALT);
+
+constexpr char32_t CHAR_BACKSPACE = 0x08;
+constexpr char32_t CHAR_TAB       = 0x09;
+constexpr char32_t CHAR_NEWLINE   = 0x0A;
+constexpr char32_t CHAR_ESCAPE    = 0x1B;
+constexpr char32_t CHAR_SPACE     = 0x20;
+constexpr char32_t CHAR_DELETE    = 0x7F;
+
+/// Keypad 1 - 9, 0 with num lock on
+constexpr char KEYPAD_DIGITS[] = "1234567890";
+}  // namespace
+
+UsbHidTextTranslator::UsbHidTextTranslator(const UsbHidKeyboardLayout& layout)
+    : layout_(&layout),
+      deadKey_(0)
+{
+}
+
+void UsbHidTextTranslator::setLayout(const UsbHidKeyboardLayout& layout)
+{
+    layout_  = &layout;
+    deadKey_ = 0;
+}
+
+size_t UsbHidTextTranslator::translate(const UsbHidKeyboardEvent& event, char32_t (&out)[MAX_OUTPUT])
+{
+    if (!event.pressed)
+    {
+        return 0;
+    }
+
+    const uint8_t keyCode = event.keyCode;
+    const bool capsLock   = event.leds & mask(Led::CAPS_LOCK);
+    const bool numLock    = event.leds & mask(Led::NUM_LOCK);
+
+    const bool altGrHeld = layout_->hasAltGr && (event.modifiers & mask(Modifier::RIGHT_ALT));
+    uint8_t shortcutMask = SHORTCUT_MASK;
+    if (!layout_->hasAltGr)
+    {
+        shortcutMask |= mask(Modifier::RIGHT_ALT);
+    }
+    if (event.modifiers & shortcutMask)
+    {
+        return 0;
+    }
+
+    switch (keyCode)
+    {
+    case key(KeyCode::KEY_ENTER):
+    case key(KeyCode::KEYPAD_ENTER):
+        deadKey_ = 0;
+        return emit(CHAR_NEWLINE, out);
+    case key(KeyCode::KEY_TAB):
+        deadKey_ = 0;
+        return emit(CHAR_TAB, out);
+    case key(KeyCode::KEY_BACKSPACE):
+        deadKey_ = 0;
+        return emit(CHAR_BACKSPACE, out);
+    case key(KeyCode::KEY_ESC):
+        deadKey_ = 0;
+        return emit(CHAR_ESCAPE, out);
+    case key(KeyCode::KEY_DELETE):
+        deadKey_ = 0;
+        return emit(CHAR_DELETE, out);
+    default:
+        break;
+    }
+
+    if (keyCode >= key(KeyCode::KEYPAD_SLASH) && keyCode <= key(KeyCode::KEYPAD_DOT))
+    {
+        const char32_t codePoint = translateKeypad(keyCode, numLock);
+        return codePoint ? emit(codePoint, out) : 0;
+    }
+
+    const int index = UsbHidKeyboardLayout::keyIndex(keyCode);
+    if (index < 0)
+    {
+        return 0;
+    }
+
+    const UsbHidKeyboardLayout::Key& layoutKey = layout_->keys[index];
+    bool shift = event.modifiers & SHIFT_MASK;
+    if (capsLock && !altGrHeld && (layoutKey.flags & UsbHidKeyboardLayout::FLAG_CAPS))
+    {
+        shift = !shift;
+    }
+
+    const uint8_t level = (altGrHeld ? UsbHidKeyboardLayout::LEVEL_ALTGR : UsbHidKeyboardLayout::LEVEL_BASE) +
+                          (shift ? UsbHidKeyboardLayout::LEVEL_SHIFT : 0);
+    const char32_t codePoint = layoutKey.level[level];
+    if (codePoint == 0)
+    {
+        return 0;
+    }
+
+    if (layoutKey.flags & (UsbHidKeyboardLayout::FLAG_DEAD << level))
+    {
+        if (deadKey_ == 0)
+        {
+            deadKey_ = codePoint;
+            return 0;
+        }
+        // A second dead key: the same one types it once, another types both
+        const char32_t pending = deadKey_;
+        deadKey_ = 0;
+        if (pending == codePoint)
+        {
+            return emit(codePoint, out);
+        }
+        emit(pending, out);
+        out[1] = codePoint;
+        return 2;
+    }
+
+    return emit(codePoint, out);
+}
+
+void UsbHidTextTranslator::onKeyEvent(const UsbHidKeyboardEvent& event)
+{
+    char32_t text[MAX_OUTPUT];
+    const size_t count = translate(event, text);
+    if (!callback_)
+    {
+        return;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        callback_(text[i]);
+    }
+}
+
+char32_t UsbHidTextTranslator::translateKeypad(uint8_t keyCode, bool numLock) const
+{
+    switch (keyCode)
+    {
+    case key(KeyCode::KEYPAD_SLASH):
+        return U'/';
+    case key(KeyCode::KEYPAD_ASTERISK):
+        return U'*';
+    case key(KeyCode::KEYPAD_MINUS):
+        return U'-';
+    case key(KeyCode::KEYPAD_PLUS):
+        return U'+';
+    case key(KeyCode::KEYPAD_DOT):
+        return numLock ? layout_->keypadDecimal : 0;
+    default:
+        // Keypad 1 - 0, navigation keys without num lock
+        return numLock ? KEYPAD_DIGITS[keyCode - key(KeyCode::KEYPAD_1)] : 0;
+    }
+}
+
+size_t UsbHidTextTranslator::emit(char32_t codePoint, char32_t (&out)[MAX_OUTPUT])
+{
+    if (deadKey_ == 0)
+    {
+        out[0] = codePoint;
+        return 1;
+    }
+
+    const char32_t pending = deadKey_;
+    deadKey_ = 0;
+    if (codePoint == CHAR_SPACE)
+    {
+        out[0] = pending;
+        return 1;
+    }
+
+    const char32_t composed = UsbHidKeyboardLayout::compose(pending, codePoint);
+    if (composed != 0)
+    {
+        out[0] = composed;
+        return 1;
+    }
+
+    // Not composable: type the accent on its own, then the character
+    out[0] = pending;
+    out[1] = codePoint;
+    return 2;
+}
+
+size_t UsbHidTextTranslator::toUtf8(char32_t codePoint, char* out)
+{
+    if (codePoint < 0x80)
+    {
+        out[0] = static_cast<char>(codePoint);
+        return 1;
+    }
+    if (codePoint < 0x800)
+    {
+        out[0] = static_cast<char>(0xC0 | (codePoint >> 6));
+        out[1] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        return 2;
+    }
+    if (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+    {
+        return 0;  // UTF-16 surrogates are not code points
+    }
+    if (codePoint < 0x10000)
+    {
+        out[0] = static_cast<char>(0xE0 | (codePoint >> 12));
+        out[1] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        return 3;
+    }
+    if (codePoint <= 0x10FFFF)
+    {
+        out[0] = static_cast<char>(0xF0 | (codePoint >> 18));
+        out[1] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out[2] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out[3] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        return 4;
+    }
+    return 0;
+}
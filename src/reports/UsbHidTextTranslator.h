@@ -0,0 +1,104 @@
+/**
+ * @file UsbHidTextTranslator.h
+ * @brief Defines the UsbHidTextTranslator class, which turns keyboard events into text.
+ */
+
+#pragma once
+
+#include "UsbHidKeyboardLayout.h"
+#include "UsbHidKeyboardReport.h"
+#include <cstddef>
+#include <functional>
+
+/**
+ * @class UsbHidTextTranslator
+ * @brief Translates key edges into Unicode text using a keyboard layout.
+ *
+ * Caps lock and num lock are taken from the event's LED state, which the keyboard
+ * report maintains; the translator itself only tracks a pending dead key. Only key-down
+ * events (including typematic repeats) produce text; a single event yields at most
+ * MAX_OUTPUT code points, e.g. an unused dead key followed by the next character.
+ *
+ * Keys held with Ctrl, GUI or Alt produce no text, they are shortcuts. Right Alt is
+ * treated as AltGr when the layout has one.
+ *
+ * The translator keeps no timing state and is fed from the keyboard callback, so it
+ * runs unchanged on the host.
+ */
+class UsbHidTextTranslator
+{
+public:
+    /// Maximum number of code points produced by one key event
+    static constexpr size_t MAX_OUTPUT = 2;
+
+    /// Maximum length of a code point in UTF-8
+    static constexpr size_t MAX_UTF8_LENGTH = 4;
+
+    /**
+     * @typedef TextCallback
+     * @brief Function called for every code point produced.
+     */
+    using TextCallback = std::function<void(char32_t codePoint)>;
+
+    /**
+     * @brief Construct a new UsbHidTextTranslator object.
+     *
+     * @param layout Keyboard layout, must outlive the translator.
+     */
+    explicit UsbHidTextTranslator(const UsbHidKeyboardLayout& layout = UsbHidKeyboardLayouts::US);
+
+    /**
+     * @brief Select a different layout. Drops a pending dead key.
+     *
+     * @param layout Keyboard layout, must outlive the translator.
+     */
+    void setLayout(const UsbHidKeyboardLayout& layout);
+
+    /**
+     * @brief Get the active layout.
+     */
+    const UsbHidKeyboardLayout& getLayout() const { return *layout_; }
+
+    /**
+     * @brief Translate a key event.
+     *
+     * @param event Key event from UsbHidKeyboardReport.
+     * @param out Receives the produced code points.
+     * @return size_t Number of code points written to out.
+     */
+    size_t translate(const UsbHidKeyboardEvent& event, char32_t (&out)[MAX_OUTPUT]);
+
+    /**
+     * @brief Translate a key event and pass the produced code points to the callback.
+     *
+     * @param event Key event from UsbHidKeyboardReport.
+     */
+    void onKeyEvent(const UsbHidKeyboardEvent& event);
+
+    /**
+     * @brief Register the function called for every produced code point.
+     */
+    void registerCallback(TextCallback callback) { callback_ = std::move(callback); }
+
+    /**
+     * @brief Drop the pending dead key.
+     */
+    void reset() { deadKey_ = 0; }
+
+    /**
+     * @brief Encode a code point as UTF-8.
+     *
+     * @param codePoint Unicode code point.
+     * @param out Receives up to MAX_UTF8_LENGTH bytes, not null-terminated.
+     * @return size_t Number of bytes written, 0 for an invalid code point.
+     */
+    static size_t toUtf8(char32_t codePoint, char* out);
+
+private:
+    const UsbHidKeyboardLayout* layout_;
+    TextCallback callback_;
+    char32_t deadKey_;  ///< Pending dead key, 0 if none
+
+    char32_t translateKeypad(uint8_t keyCode, bool numLock) const;
+    size_t emit(char32_t codePoint, char32_t (&out)[MAX_OUTPUT]);
+};
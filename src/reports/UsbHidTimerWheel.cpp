@@ -0,0 +1,174 @@
+/**
+ * @file UsbHidTimerWheel.cpp
+ * @brief Implements the UsbHidTimerWheel class, a hashed timing wheel for software timers.
+ */
+
+#include "UsbHidTimerWheel.h"
+
+UsbHidTimerWheel::Timer::~Timer()
+{
+    if (wheel_ != nullptr)
+    {
+        wheel_->stop(*this);
+    }
+}
+
+UsbHidTimerWheel::UsbHidTimerWheel(Millis tickMs, Millis now)
+    : tickMs_(tickMs == 0 ? 1 : tickMs),
+      now_(now),
+      remainder_(0),
+      currentTick_(0),
+      armed_(0),
+      slots_{}
+{
+}
+
+UsbHidTimerWheel::~UsbHidTimerWheel()
+{
+    for (auto& head : slots_)
+    {
+        while (head != nullptr)
+        {
+            unlink(*head);
+        }
+    }
+}
+
+void UsbHidTimerWheel::start(Timer& timer, Millis delayMs)
+{
+    if (timer.wheel_ != nullptr)
+    {
+        timer.wheel_->stop(timer);
+    }
+
+    // Count from the start of the current tick, so the timer never fires early
+    uint32_t ticks = (delayMs + remainder_ + tickMs_ - 1) / tickMs_;
+    if (ticks == 0)
+    {
+        ticks = 1;
+    }
+
+    timer.expiryTick_ = currentTick_ + ticks;
+    link(timer);
+}
+
+void UsbHidTimerWheel::stop(Timer& timer)
+{
+    if (timer.wheel_ == this)
+    {
+        unlink(timer);
+    }
+}
+
+void UsbHidTimerWheel::advance(Millis now)
+{
+    remainder_ += now - now_;
+    now_ = now;
+
+    const uint32_t steps = remainder_ / tickMs_;
+    remainder_ %= tickMs_;
+    if (steps == 0)
+    {
+        return;
+    }
+
+    const uint32_t firstTick = currentTick_ + 1;
+    currentTick_ += steps;
+
+    if (armed_ == 0)
+    {
+        return;
+    }
+
+    // A jump of a full revolution or more visits every slot once
+    const uint32_t visits = steps < SLOTS ? steps : SLOTS;
+    for (uint32_t i = 0; i < visits; ++i)
+    {
+        fireSlot((firstTick + i) % SLOTS);
+    }
+}
+
+bool UsbHidTimerWheel::timeToNextExpiry(Millis& delayMs) const
+{
+    if (armed_ == 0)
+    {
+        return false;
+    }
+
+    uint32_t earliest = 0;
+    bool found        = false;
+    for (const Timer* head : slots_)
+    {
+        for (const Timer* timer = head; timer != nullptr; timer = timer->next_)
+        {
+            if (!found || tickReached(timer->expiryTick_, earliest))
+            {
+                earliest = timer->expiryTick_;
+                found    = true;
+            }
+        }
+    }
+
+    const uint32_t ticks = earliest - currentTick_;
+    delayMs              = ticks * tickMs_ > remainder_ ? ticks * tickMs_ - remainder_ : 0;
+    return true;
+}
+
+void UsbHidTimerWheel::link(Timer& timer)
+{
+    Timer*& head = slots_[timer.expiryTick_ % SLOTS];
+
+    timer.wheel_ = this;
+    timer.prev_  = nullptr;
+    timer.next_  = head;
+    if (head != nullptr)
+    {
+        head->prev_ = &timer;
+    }
+    head = &timer;
+    ++armed_;
+}
+
+void UsbHidTimerWheel::unlink(Timer& timer)
+{
+    if (timer.prev_ != nullptr)
+    {
+        timer.prev_->next_ = timer.next_;
+    }
+    else
+    {
+        slots_[timer.expiryTick_ % SLOTS] = timer.next_;
+    }
+    if (timer.next_ != nullptr)
+    {
+        timer.next_->prev_ = timer.prev_;
+    }
+
+    timer.wheel_ = nullptr;
+    timer.prev_  = nullptr;
+    timer.next_  = nullptr;
+    --armed_;
+}
+
+void UsbHidTimerWheel::fireSlot(size_t slot)
+{
+    Timer* timer = slots_[slot];
+    while (timer != nullptr)
+    {
+        if (!tickReached(timer->expiryTick_, currentTick_))
+        {
+            // Due on a later revolution
+            timer = timer->next_;
+            continue;
+        }
+
+        unlink(*timer);
+        if (timer->callback_)
+        {
+            timer->callback_(now_);
+        }
+
+        // The callback may have armed or stopped timers in this slot, rescan it
+        timer = slots_[slot];
+    }
+}
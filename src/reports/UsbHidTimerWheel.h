@@ -0,0 +1,135 @@
+/**
+ * @file UsbHidTimerWheel.h
+ * @brief Defines the UsbHidTimerWheel class, a hashed timing wheel for software timers.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/**
+ * @class UsbHidTimerWheel
+ * @brief Hashed timing wheel driving any number of software timers from one clock.
+ *
+ * Timers are intrusive: the owner keeps the Timer object and the wheel only links it
+ * into one of its slots, so starting and stopping a timer is O(1) and never allocates.
+ *
+ * The wheel has no clock of its own. Time only moves when advance() is called with the
+ * current time in milliseconds, which makes it deterministic under a simulated clock.
+ * Expired timers are fired from inside advance().
+ */
+class UsbHidTimerWheel
+{
+public:
+    using Millis = uint32_t;
+
+    /// Number of slots in the wheel
+    static constexpr size_t SLOTS = 64;
+
+    /**
+     * @class Timer
+     * @brief A one-shot timer that can be armed on a UsbHidTimerWheel.
+     */
+    class Timer
+    {
+    public:
+        /**
+         * @typedef Callback
+         * @brief Function called when the timer expires, with the wheel time in milliseconds.
+         */
+        using Callback = std::function<void(Millis now)>;
+
+        explicit Timer(Callback callback) : callback_(std::move(callback)) {}
+        ~Timer();
+
+        Timer(const Timer&)            = delete;
+        Timer& operator=(const Timer&) = delete;
+
+        /**
+         * @brief Check whether the timer is armed.
+         */
+        bool isArmed() const { return wheel_ != nullptr; }
+
+    private:
+        friend class UsbHidTimerWheel;
+
+        Callback callback_;                  ///< Called on expiry
+        UsbHidTimerWheel* wheel_ = nullptr;  ///< Wheel the timer is armed on, nullptr if idle
+        Timer* prev_             = nullptr;  ///< Previous timer in the slot
+        Timer* next_             = nullptr;  ///< Next timer in the slot
+        uint32_t expiryTick_     = 0;        ///< Tick at which the timer expires
+    };
+
+    /**
+     * @brief Construct a new UsbHidTimerWheel object.
+     *
+     * @param tickMs Resolution of the wheel in milliseconds.
+     * @param now Initial time in milliseconds.
+     */
+    explicit UsbHidTimerWheel(Millis tickMs = 5, Millis now = 0);
+
+    /**
+     * @brief Destroy the UsbHidTimerWheel object, disarming all timers.
+     */
+    ~UsbHidTimerWheel();
+
+    UsbHidTimerWheel(const UsbHidTimerWheel&)            = delete;
+    UsbHidTimerWheel& operator=(const UsbHidTimerWheel&) = delete;
+
+    /**
+     * @brief Arm a timer, re-arming it if it is already armed.
+     *
+     * @param timer The timer to arm.
+     * @param delayMs Delay from the current wheel time. Rounded up to whole ticks, at least one.
+     */
+    void start(Timer& timer, Millis delayMs);
+
+    /**
+     * @brief Disarm a timer. Does nothing if the timer is not armed.
+     *
+     * @param timer The timer to disarm.
+     */
+    void stop(Timer& timer);
+
+    /**
+     * @brief Move the wheel to the given time and fire every timer that expired.
+     *
+     * @param now Current time in milliseconds. May wrap around.
+     */
+    void advance(Millis now);
+
+    /**
+     * @brief Get the wheel time, as passed to the last advance().
+     */
+    Millis now() const { return now_; }
+
+    /**
+     * @brief Get the number of armed timers.
+     */
+    size_t armedCount() const { return armed_; }
+
+    /**
+     * @brief Get the time until the earliest armed timer expires.
+     *
+     * @param delayMs Receives the delay in milliseconds.
+     * @return true if a timer is armed, false otherwise.
+     */
+    bool timeToNextExpiry(Millis& delayMs) const;
+
+private:
+    Millis tickMs_;          ///< Wheel resolution
+    Millis now_;             ///< Time passed to the last advance()
+    Millis remainder_;       ///< Milliseconds accumulated towards the next tick
+    uint32_t currentTick_;   ///< Last tick processed
+    size_t armed_;           ///< Number of armed timers
+    Timer* slots_[SLOTS];    ///< Heads of the per-slot timer lists
+
+    void link(Timer& timer);
+    void unlink(Timer& timer);
+    void fireSlot(size_t slot);
+
+    /// Wrap-safe "a is at or before b"
+    static bool tickReached(uint32_t a, uint32_t b) { return static_cast<int32_t>(a - b) <= 0; }
+};
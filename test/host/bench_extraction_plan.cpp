@@ -0,0 +1,109 @@
+/**
+ * @file bench_extraction_plan.cpp
+ * @brief Benchmarks of the extraction kernels: scalar, SIMD (AVX2 in usbhid_benchmarks_avx2) and readBits().
+ */
+
+#include "UsbHidExtractionPlan.h"
+#include "UsbHidReportDescriptor.h"
+#include "descriptors.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace
+{
+/**
+ * @struct Layout
+ * @brief A built plan and a full report for it.
+ */
+struct Layout
+{
+    UsbHidReportDescriptor descriptor;
+    UsbHidExtractionPlan plan;
+    std::vector<uint8_t> report;
+};
+
+/// range(0): 0 the NKRO keyboard, 1 a wide report of 64 signed 12-bit elements (e.g. touch or sensor data)
+Layout makeLayout(const benchmark::State& state)
+{
+    Layout layout;
+    if (state.range(0) == 0)
+    {
+        layout.descriptor.parse(descriptors::NKRO_KEYBOARD, sizeof(descriptors::NKRO_KEYBOARD));
+        layout.report.assign(std::begin(descriptors::NKRO_KEYBOARD_REPORT), std::end(descriptors::NKRO_KEYBOARD_REPORT));
+    }
+    else
+    {
+        const std::vector<uint8_t> bytes = descriptors::makeVariables(std::vector<descriptors::Variable>(64, {12, true}));
+        layout.descriptor.parse(bytes.data(), bytes.size());
+        layout.report.resize(64 * 12 / 8);
+        for (size_t i = 0; i < layout.report.size(); ++i)
+        {
+            layout.report[i] = static_cast<uint8_t>(i * 37 + 11);
+        }
+    }
+    layout.plan.build(layout.descriptor);
+    return layout;
+}
+
+void label(benchmark::State& state, size_t values)
+{
+    state.SetItemsProcessed(state.iterations() * values);
+    state.SetLabel(state.range(0) == 0 ? "nkro_keyboard" : "64x12bit");
+}
+
+void extract(benchmark::State& state, bool allowSimd)
+{
+    const Layout layout = makeLayout(state);
+    std::vector<int32_t> out(layout.plan.maxValues());
+    size_t count = 0;
+    for (auto _ : state)
+    {
+        count = layout.plan.extract(layout.report.data(), layout.report.size(), out.data(), out.size(), allowSimd);
+        benchmark::DoNotOptimize(out.data());
+    }
+    label(state, count);
+}
+
+void BM_ExtractScalar(benchmark::State& state)
+{
+    extract(state, false);
+}
+
+void BM_ExtractSimd(benchmark::State& state)
+{
+    if (!UsbHidExtractionPlan::hasSimdKernel())
+    {
+        state.SkipWithError("no SIMD kernel in this build");
+        return;
+    }
+    extract(state, true);
+}
+
+/// One readBits() per entry, the reference the kernels are tested against
+void BM_ReadBits(benchmark::State& state)
+{
+    const Layout layout = makeLayout(state);
+    const bool ids      = layout.plan.usesReportIds();
+    size_t count        = 0;
+    const auto* entries = layout.plan.entries(ids ? layout.report[0] : 0, count);
+    const uint8_t* data = layout.report.data() + (ids ? 1 : 0);
+    const size_t length = layout.report.size() - (ids ? 1 : 0);
+    std::vector<int32_t> out(count);
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            out[i] = static_cast<int32_t>(
+                UsbHidExtractionPlan::readBits(data, length, entries[i].bitOffset, entries[i].bitSize));
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    label(state, count);
+}
+}  // namespace
+
+BENCHMARK(BM_ExtractScalar)->Arg(0)->Arg(1);
+BENCHMARK(BM_ExtractSimd)->Arg(0)->Arg(1);
+BENCHMARK(BM_ReadBits)->Arg(0)->Arg(1);
@@ -0,0 +1,124 @@
+/**
+ * @file bench_motion_filter.cpp
+ * @brief Per-sample cost of UsbHidMotionFilter over an air-mouse report trace.
+ *
+ * Reports time per sample and, on x86, time-stamp counter ticks per sample. The TSC runs
+ * at a fixed rate rather than the core clock, so treat the tick count as cycles at the
+ * nominal frequency.
+ */
+
+#include "UsbHidG20sProReport.h"
+#include "UsbHidMotionFilter.h"
+#include "trace.h"
+
+#include <benchmark/benchmark.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define USBHID_HAVE_TSC 1
+#endif
+
+#include <vector>
+
+namespace
+{
+const char* const TRACE = "g20s_air_mouse.trace";
+
+struct Sample
+{
+    int8_t x;
+    int8_t y;
+};
+
+/// X and Y of every 4-byte mouse report in the trace
+std::vector<Sample> loadSamples()
+{
+    std::vector<Sample> samples;
+    for (const auto& report : trace::load(TRACE))
+    {
+        if (report.size() == 4)
+        {
+            samples.push_back({static_cast<int8_t>(report[1]), static_cast<int8_t>(report[2])});
+        }
+    }
+    return samples;
+}
+
+void setCounters(benchmark::State& state, size_t perIteration, uint64_t ticks)
+{
+    const double samples = static_cast<double>(state.iterations() * perIteration);
+    state.SetItemsProcessed(static_cast<int64_t>(samples));
+    state.counters["ns/sample"] = benchmark::Counter(samples, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+#if defined(USBHID_HAVE_TSC)
+    state.counters["tsc/sample"] = static_cast<double>(ticks) / samples;
+#endif
+}
+
+/// range(0): 0 the air-mouse preset, 1 passthrough
+void BM_MotionFilterTrace(benchmark::State& state)
+{
+    const std::vector<Sample> samples = loadSamples();
+    if (samples.empty())
+    {
+        state.SkipWithError("trace not found");
+        return;
+    }
+    UsbHidMotionFilter filter(state.range(0) == 0 ? UsbHidMotionFilter::Config::airMouse()
+                                                  : UsbHidMotionFilter::Config::passthrough());
+    uint64_t ticks = 0;
+    for (auto _ : state)
+    {
+        filter.reset();
+#if defined(USBHID_HAVE_TSC)
+        const uint64_t start = __rdtsc();
+#endif
+        for (const Sample& sample : samples)
+        {
+            int32_t x = 0;
+            int32_t y = 0;
+            benchmark::DoNotOptimize(filter.filter(sample.x, sample.y, x, y));
+            benchmark::DoNotOptimize(x);
+            benchmark::DoNotOptimize(y);
+        }
+#if defined(USBHID_HAVE_TSC)
+        ticks += __rdtsc() - start;
+#endif
+    }
+    setCounters(state, samples.size(), ticks);
+    state.SetLabel(state.range(0) == 0 ? "airMouse" : "passthrough");
+}
+
+/// The whole report path: classify, button edges, filter and event dispatch
+void BM_G20sProReportTrace(benchmark::State& state)
+{
+    const std::vector<trace::Report> reports = trace::load(TRACE);
+    if (reports.empty())
+    {
+        state.SkipWithError("trace not found");
+        return;
+    }
+    UsbHidG20sProReport remote;
+    int events = 0;
+    remote.registerCallback([&events](const UsbHidG20sProEvent&) { ++events; });
+    uint64_t ticks = 0;
+    for (auto _ : state)
+    {
+#if defined(USBHID_HAVE_TSC)
+        const uint64_t start = __rdtsc();
+#endif
+        for (const auto& report : reports)
+        {
+            remote.processReportData(report.data(), static_cast<int>(report.size()));
+        }
+#if defined(USBHID_HAVE_TSC)
+        ticks += __rdtsc() - start;
+#endif
+        remote.releaseAll();
+    }
+    benchmark::DoNotOptimize(events);
+    setCounters(state, reports.size(), ticks);
+}
+}  // namespace
+
+BENCHMARK(BM_MotionFilterTrace)->Arg(0)->Arg(1);
+BENCHMARK(BM_G20sProReportTrace);
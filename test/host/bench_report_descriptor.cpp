@@ -0,0 +1,111 @@
+/**
+ * @file bench_report_descriptor.cpp
+ * @brief Benchmarks of descriptor parsing, plan building and report decoding, per sample device.
+ */
+
+#include "UsbHidExtractionPlan.h"
+#include "UsbHidReportDescriptor.h"
+#include "descriptors.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace
+{
+const descriptors::Sample& sample(const benchmark::State& state)
+{
+    return descriptors::SAMPLES[state.range(0)];
+}
+
+void nameAfterSample(benchmark::State& state)
+{
+    state.SetLabel(sample(state).name);
+}
+
+void BM_Parse(benchmark::State& state)
+{
+    const auto& s = sample(state);
+    UsbHidReportDescriptor descriptor;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(descriptor.parse(s.descriptor, s.descriptorLength));
+    }
+    state.SetBytesProcessed(state.iterations() * s.descriptorLength);
+    nameAfterSample(state);
+}
+
+void BM_BuildPlan(benchmark::State& state)
+{
+    const auto& s = sample(state);
+    UsbHidReportDescriptor descriptor;
+    descriptor.parse(s.descriptor, s.descriptorLength);
+    UsbHidExtractionPlan plan;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(plan.build(descriptor));
+    }
+    nameAfterSample(state);
+}
+
+void BM_Decode(benchmark::State& state)
+{
+    const auto& s = sample(state);
+    UsbHidReportDescriptor descriptor;
+    descriptor.parse(s.descriptor, s.descriptorLength);
+    UsbHidExtractionPlan plan;
+    plan.build(descriptor);
+    std::vector<UsbHidFieldValue> values(plan.maxValues());
+    size_t decoded = 0;
+    for (auto _ : state)
+    {
+        decoded = plan.decode(s.report, s.reportLength, values.data(), values.size());
+        benchmark::DoNotOptimize(values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * decoded);
+    nameAfterSample(state);
+}
+
+/// The field-by-field path decoding used before extraction plans, for comparison
+void BM_DecodeFields(benchmark::State& state)
+{
+    const auto& s = sample(state);
+    UsbHidReportDescriptor descriptor;
+    descriptor.parse(s.descriptor, s.descriptorLength);
+    const uint8_t reportId = descriptor.usesReportIds() ? s.report[0] : 0;
+    const uint8_t* payload = descriptor.usesReportIds() ? s.report + 1 : s.report;
+    const size_t length    = descriptor.usesReportIds() ? s.reportLength - 1 : s.reportLength;
+    size_t decoded         = 0;
+    for (auto _ : state)
+    {
+        decoded = 0;
+        for (const auto& field : descriptor.fields())
+        {
+            if (field.type != UsbHidReportType::Input || field.reportId != reportId || field.isConstant())
+            {
+                continue;
+            }
+            for (uint16_t i = 0; i < field.count; ++i)
+            {
+                benchmark::DoNotOptimize(field.extract(payload, length, i));
+                ++decoded;
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * decoded);
+    nameAfterSample(state);
+}
+
+void samples(benchmark::internal::Benchmark* benchmark)
+{
+    for (size_t i = 0; i < std::size(descriptors::SAMPLES); ++i)
+    {
+        benchmark->Arg(static_cast<int64_t>(i));
+    }
+}
+}  // namespace
+
+BENCHMARK(BM_Parse)->Apply(samples);
+BENCHMARK(BM_BuildPlan)->Apply(samples);
+BENCHMARK(BM_Decode)->Apply(samples);
+BENCHMARK(BM_DecodeFields)->Apply(samples);
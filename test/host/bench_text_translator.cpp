@@ -0,0 +1,122 @@
+/**
+ * @file bench_text_translator.cpp
+ * @brief Bulk translation of typed text through UsbHidTextTranslator.
+ *
+ * The key events are generated by inverting the layout table for a paragraph of text,
+ * one key-down and one key-up per character, as a keyboard would deliver them.
+ */
+
+#include "UsbHidKeyboardLayout.h"
+#include "UsbHidKeyboardReport.h"
+#include "UsbHidTextTranslator.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+namespace
+{
+constexpr uint8_t SHIFT = 0x02;  // Left Shift in the modifiers bitmask
+
+const std::u32string US_TEXT = U"The quick brown fox jumps over the lazy dog, 1234567890 times! "
+                               U"Pack my box with five dozen liquor jugs; (really?) \"Yes\" - 100% sure.\n";
+const std::u32string DE_TEXT = U"Zwölf Boxkämpfer jagen Viktor quer über den großen Sylter Deich, "
+                               U"für 1234567890 Euro? Jeder Fußgänger weiß: Öl & Übermaß!\n";
+
+/// Key-down and key-up events typing @p text on @p layout; characters the layout cannot type are skipped
+std::vector<UsbHidKeyboardEvent> typeText(const UsbHidKeyboardLayout& layout, const std::u32string& text)
+{
+    std::vector<UsbHidKeyboardEvent> events;
+    for (const char32_t c : text)
+    {
+        uint8_t usage     = 0;
+        uint8_t modifiers = 0;
+        if (c == U'\n')
+        {
+            usage = static_cast<uint8_t>(UsbHidKeyboardReport::KeyCode::KEY_ENTER);
+        }
+        for (int u = 0; usage == 0 && u < 256; ++u)
+        {
+            const int index = UsbHidKeyboardLayout::keyIndex(static_cast<uint8_t>(u));
+            if (index < 0)
+            {
+                continue;
+            }
+            const auto& key = layout.keys[index];
+            for (uint8_t level : {UsbHidKeyboardLayout::LEVEL_BASE, UsbHidKeyboardLayout::LEVEL_SHIFT})
+            {
+                const bool dead = key.flags & (UsbHidKeyboardLayout::FLAG_DEAD << level);
+                if (usage == 0 && !dead && key.level[level] == c)
+                {
+                    usage     = static_cast<uint8_t>(u);
+                    modifiers = level == UsbHidKeyboardLayout::LEVEL_SHIFT ? SHIFT : 0;
+                }
+            }
+        }
+        if (usage == 0)
+        {
+            continue;
+        }
+
+        UsbHidKeyboardEvent event;
+        event.keyCode   = usage;
+        event.modifiers = modifiers;
+        event.pressed   = true;
+        events.push_back(event);
+        event.pressed = false;
+        events.push_back(event);
+    }
+    return events;
+}
+
+/// range(0): 0 US layout and text, 1 German
+void BM_Translate(benchmark::State& state)
+{
+    const bool german                  = state.range(0) == 1;
+    const UsbHidKeyboardLayout& layout = german ? UsbHidKeyboardLayouts::DE : UsbHidKeyboardLayouts::US;
+    const std::vector<UsbHidKeyboardEvent> events = typeText(layout, german ? DE_TEXT : US_TEXT);
+    UsbHidTextTranslator translator(layout);
+    char32_t out[UsbHidTextTranslator::MAX_OUTPUT];
+    size_t produced = 0;
+    for (auto _ : state)
+    {
+        produced = 0;
+        for (const auto& event : events)
+        {
+            produced += translator.translate(event, out);
+            benchmark::DoNotOptimize(out);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * produced);
+    state.SetLabel(std::string(layout.name) + ", " + std::to_string(produced) + " characters");
+}
+
+/// Translation and UTF-8 encoding, as a text field fed by the host would do
+void BM_TranslateToUtf8(benchmark::State& state)
+{
+    const std::vector<UsbHidKeyboardEvent> events = typeText(UsbHidKeyboardLayouts::DE, DE_TEXT);
+    UsbHidTextTranslator translator(UsbHidKeyboardLayouts::DE);
+    std::string text;
+    text.reserve(4 * events.size());
+    for (auto _ : state)
+    {
+        text.clear();
+        for (const auto& event : events)
+        {
+            char32_t out[UsbHidTextTranslator::MAX_OUTPUT];
+            const size_t count = translator.translate(event, out);
+            for (size_t i = 0; i < count; ++i)
+            {
+                char utf8[4];
+                text.append(utf8, UsbHidTextTranslator::toUtf8(out[i], utf8));
+            }
+        }
+        benchmark::DoNotOptimize(text.data());
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+}  // namespace
+
+BENCHMARK(BM_Translate)->Arg(0)->Arg(1);
+BENCHMARK(BM_TranslateToUtf8);
@@ -0,0 +1,198 @@
+/**
+ * @file descriptors.h
+ * @brief Report descriptors of typical devices, shared by the host tests, benchmarks and fuzz seeds.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace descriptors
+{
+/// Boot keyboard: modifiers, reserved byte, five LEDs, six key array slots (HID 1.11 appendix B.1)
+inline constexpr uint8_t BOOT_KEYBOARD[] = {
+    0x05, 0x01, 0x09, 0x06, 0xA1, 0x01,              // Generic Desktop, Keyboard, Application
+    0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7,              //   Keyboard page, modifiers
+    0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x08,  //
+    0x81, 0x02,                                      //   Input (Data, Var, Abs)
+    0x95, 0x01, 0x75, 0x08, 0x81, 0x01,              //   Input (Const), reserved byte
+    0x95, 0x05, 0x75, 0x01, 0x05, 0x08,              //   LED page
+    0x19, 0x01, 0x29, 0x05, 0x91, 0x02,              //   Output (Data, Var, Abs)
+    0x95, 0x01, 0x75, 0x03, 0x91, 0x01,              //   Output (Const), padding
+    0x95, 0x06, 0x75, 0x08, 0x15, 0x00, 0x25, 0x65,  //   Six key slots
+    0x05, 0x07, 0x19, 0x00, 0x29, 0x65, 0x81, 0x00,  //   Input (Data, Array)
+    0xC0,                                            // End Collection
+};
+
+/// N-key-rollover keyboard, report ID 1: modifiers and a 120-key bitmap, plus LEDs
+inline constexpr uint8_t NKRO_KEYBOARD[] = {
+    0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, 0x85, 0x01,  // Keyboard, Application, Report ID 1
+    0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7,              //   Modifiers
+    0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x08,  //
+    0x81, 0x02,                                      //   Input (Data, Var, Abs)
+    0x19, 0x00, 0x29, 0x77, 0x95, 0x78, 0x81, 0x02,  //   Key bitmap, usages 0x00 - 0x77
+    0x05, 0x08, 0x19, 0x01, 0x29, 0x05,              //   LED page
+    0x95, 0x05, 0x91, 0x02, 0x95, 0x03, 0x91, 0x01,  //   Output, padding
+    0xC0,                                            // End Collection
+};
+
+/// Composite: report ID 1 a mouse with 16-bit motion, wheel and AC Pan; report ID 2 consumer control
+inline constexpr uint8_t MOUSE_AND_CONSUMER[] = {
+    0x05, 0x01, 0x09, 0x02, 0xA1, 0x01, 0x85, 0x01,  // Mouse, Application, Report ID 1
+    0x09, 0x01, 0xA1, 0x00,                          //   Pointer, Physical
+    0x05, 0x09, 0x19, 0x01, 0x29, 0x05,              //     Buttons 1 - 5
+    0x15, 0x00, 0x25, 0x01, 0x95, 0x05, 0x75, 0x01,  //
+    0x81, 0x02,                                      //     Input (Data, Var, Abs)
+    0x95, 0x01, 0x75, 0x03, 0x81, 0x01,              //     Padding
+    0x05, 0x01, 0x09, 0x30, 0x09, 0x31,              //     X, Y
+    0x16, 0x01, 0x80, 0x26, 0xFF, 0x7F,              //     -32767 - 32767
+    0x75, 0x10, 0x95, 0x02, 0x81, 0x06,              //     Input (Data, Var, Rel)
+    0x09, 0x38, 0x15, 0x81, 0x25, 0x7F,              //     Wheel
+    0x75, 0x08, 0x95, 0x01, 0x81, 0x06,              //
+    0x05, 0x0C, 0x0A, 0x38, 0x02, 0x81, 0x06,        //     AC Pan
+    0xC0, 0xC0,                                      //   End Collections
+    0x05, 0x0C, 0x09, 0x01, 0xA1, 0x01, 0x85, 0x02,  // Consumer Control, Application, Report ID 2
+    0x15, 0x00, 0x26, 0xFF, 0x03,                    //
+    0x19, 0x00, 0x2A, 0xFF, 0x03,                    //   Usages 0x000 - 0x3FF
+    0x75, 0x10, 0x95, 0x02, 0x81, 0x00,              //   Input (Data, Array), two slots
+    0xC0,                                            // End Collection
+};
+
+/// Gamepad: four 8-bit axes, a hat switch and 16 buttons
+inline constexpr uint8_t GAMEPAD[] = {
+    0x05, 0x01, 0x09, 0x05, 0xA1, 0x01,              // Game Pad, Application
+    0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08,        //   0 - 255
+    0x95, 0x04, 0x09, 0x30, 0x09, 0x31,              //   X, Y
+    0x09, 0x32, 0x09, 0x35, 0x81, 0x02,              //   Z, Rz
+    0x09, 0x39, 0x15, 0x00, 0x25, 0x07,              //   Hat switch, 0 - 7
+    0x35, 0x00, 0x46, 0x3B, 0x01, 0x65, 0x14,        //   0 - 315 degrees
+    0x75, 0x04, 0x95, 0x01, 0x81, 0x42,              //   Input (Data, Var, Abs, Null)
+    0x65, 0x00, 0x81, 0x01,                          //   Padding
+    0x05, 0x09, 0x19, 0x01, 0x29, 0x10,              //   Buttons 1 - 16
+    0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x10,  //
+    0x81, 0x02,                                      //   Input (Data, Var, Abs)
+    0xC0,                                            // End Collection
+};
+
+/// Composite: report ID 1 a mouse with 8-bit motion, report ID 2 a gamepad with X, Y and 8 buttons
+inline constexpr uint8_t MOUSE_AND_GAMEPAD[] = {
+    0x05, 0x01, 0x09, 0x02, 0xA1, 0x01, 0x85, 0x01,  // Mouse, Application, Report ID 1
+    0x05, 0x09, 0x19, 0x01, 0x29, 0x03,              //   Buttons 1 - 3
+    0x15, 0x00, 0x25, 0x01, 0x95, 0x03, 0x75, 0x01,  //
+    0x81, 0x02, 0x95, 0x01, 0x75, 0x05, 0x81, 0x01,  //   Input (Data, Var, Abs), padding
+    0x05, 0x01, 0x09, 0x30, 0x09, 0x31,              //   X, Y
+    0x15, 0x81, 0x25, 0x7F, 0x75, 0x08, 0x95, 0x02,  //   -127 - 127
+    0x81, 0x06,                                      //   Input (Data, Var, Rel)
+    0xC0,                                            // End Collection
+    0x05, 0x01, 0x09, 0x05, 0xA1, 0x01, 0x85, 0x02,  // Game Pad, Application, Report ID 2
+    0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08,        //   0 - 255
+    0x95, 0x02, 0x09, 0x30, 0x09, 0x31, 0x81, 0x02,  //   X, Y
+    0x05, 0x09, 0x19, 0x01, 0x29, 0x08,              //   Buttons 1 - 8
+    0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x08,  //
+    0x81, 0x02,                                      //   Input (Data, Var, Abs)
+    0xC0,                                            // End Collection
+};
+
+/// Consumer control bitmaps: report ID 3 Play/Pause, Mute, Volume Up/Down; report ID 4 Next, Previous, Stop, Play
+inline constexpr uint8_t CONSUMER_BITMAP[] = {
+    0x05, 0x0C, 0x09, 0x01, 0xA1, 0x01, 0x85, 0x03,  // Consumer Control, Application, Report ID 3
+    0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x04,  //
+    0x09, 0xCD, 0x09, 0xE2, 0x09, 0xE9, 0x09, 0xEA,  //   Play/Pause, Mute, Volume Up, Volume Down
+    0x81, 0x02, 0x95, 0x04, 0x81, 0x01,              //   Input (Data, Var, Abs), padding
+    0x85, 0x04, 0x95, 0x04,                          //   Report ID 4
+    0x09, 0xB5, 0x09, 0xB6, 0x09, 0xB7, 0x09, 0xB0,  //   Next Track, Previous Track, Stop, Play
+    0x81, 0x02, 0x95, 0x04, 0x81, 0x01,              //   Input (Data, Var, Abs), padding
+    0xC0,                                            // End Collection
+};
+
+/// Hybrid-mode touch screen, report ID 1: two fingers per report with 16-bit IDs, then Contact Count
+inline constexpr uint8_t TOUCH_SCREEN[] = {
+    0x05, 0x0D, 0x09, 0x04, 0xA1, 0x01, 0x85, 0x01,  // Digitizer, Touch Screen, Application, Report ID 1
+    0x09, 0x22, 0xA1, 0x02,                          //   Finger, Logical
+    0x09, 0x42, 0x09, 0x47, 0x15, 0x00, 0x25, 0x01,  //     Tip Switch, Confidence
+    0x75, 0x01, 0x95, 0x02, 0x81, 0x02,              //     Input (Data, Var, Abs)
+    0x95, 0x06, 0x81, 0x01,                          //     Padding
+    0x09, 0x51, 0x27, 0xFF, 0xFF, 0x00, 0x00,        //     Contact Identifier, 0 - 65535
+    0x75, 0x10, 0x95, 0x01, 0x81, 0x02,              //     Input (Data, Var, Abs)
+    0x05, 0x01, 0x26, 0xFF, 0x0F, 0x09, 0x30,        //     X, 0 - 4095
+    0x09, 0x31, 0x95, 0x02, 0x81, 0x02,              //     Y, Input (Data, Var, Abs)
+    0x05, 0x0D, 0xC0,                                //   End Collection
+    0x09, 0x22, 0xA1, 0x02,                          //   Finger, Logical
+    0x09, 0x42, 0x09, 0x47, 0x15, 0x00, 0x25, 0x01,  //     Tip Switch, Confidence
+    0x75, 0x01, 0x95, 0x02, 0x81, 0x02,              //     Input (Data, Var, Abs)
+    0x95, 0x06, 0x81, 0x01,                          //     Padding
+    0x09, 0x51, 0x27, 0xFF, 0xFF, 0x00, 0x00,        //     Contact Identifier, 0 - 65535
+    0x75, 0x10, 0x95, 0x01, 0x81, 0x02,              //     Input (Data, Var, Abs)
+    0x05, 0x01, 0x26, 0xFF, 0x0F, 0x09, 0x30,        //     X, 0 - 4095
+    0x09, 0x31, 0x95, 0x02, 0x81, 0x02,              //     Y, Input (Data, Var, Abs)
+    0x05, 0x0D, 0xC0,                                //   End Collection
+    0x09, 0x54, 0x25, 0x0A, 0x75, 0x08, 0x95, 0x01,  //   Contact Count, 0 - 10
+    0x81, 0x02,                                      //   Input (Data, Var, Abs)
+    0xC0,                                            // End Collection
+};
+
+/**
+ * @struct Sample
+ * @brief A descriptor and one input report it describes.
+ */
+struct Sample
+{
+    const char* name;
+    const uint8_t* descriptor;
+    size_t descriptorLength;
+    const uint8_t* report;
+    size_t reportLength;
+};
+
+inline constexpr uint8_t BOOT_KEYBOARD_REPORT[] = {0x02, 0x00, 0x04, 0x05, 0x2C, 0x00, 0x00, 0x00};
+inline constexpr uint8_t NKRO_KEYBOARD_REPORT[] = {0x01, 0x22, 0x30, 0x00, 0x10, 0x00, 0x00, 0x80, 0x00,
+                                                   0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x04, 0x00};
+inline constexpr uint8_t MOUSE_REPORT[]         = {0x01, 0x05, 0x34, 0x12, 0xCC, 0xFF, 0x01, 0xFF};
+inline constexpr uint8_t CONSUMER_REPORT[]      = {0x02, 0xE9, 0x00, 0xCD, 0x00};
+inline constexpr uint8_t GAMEPAD_REPORT[]       = {0x80, 0x7F, 0x00, 0xFF, 0x02, 0x5A, 0xA5};
+
+inline constexpr Sample SAMPLES[] = {
+    {"boot_keyboard", BOOT_KEYBOARD, sizeof(BOOT_KEYBOARD), BOOT_KEYBOARD_REPORT, sizeof(BOOT_KEYBOARD_REPORT)},
+    {"nkro_keyboard", NKRO_KEYBOARD, sizeof(NKRO_KEYBOARD), NKRO_KEYBOARD_REPORT, sizeof(NKRO_KEYBOARD_REPORT)},
+    {"mouse", MOUSE_AND_CONSUMER, sizeof(MOUSE_AND_CONSUMER), MOUSE_REPORT, sizeof(MOUSE_REPORT)},
+    {"consumer", MOUSE_AND_CONSUMER, sizeof(MOUSE_AND_CONSUMER), CONSUMER_REPORT, sizeof(CONSUMER_REPORT)},
+    {"gamepad", GAMEPAD, sizeof(GAMEPAD), GAMEPAD_REPORT, sizeof(GAMEPAD_REPORT)},
+};
+
+/**
+ * @struct Variable
+ * @brief One variable input element of a synthetic descriptor.
+ */
+struct Variable
+{
+    uint8_t bitSize;  ///< 1 - 32
+    bool isSigned;
+};
+
+/**
+ * @brief Build a vendor-page descriptor with one input element per entry of @p variables,
+ *        packed back to back in that order.
+ */
+inline std::vector<uint8_t> makeVariables(const std::vector<Variable>& variables)
+{
+    std::vector<uint8_t> d = {0x06, 0x00, 0xFF, 0x09, 0x01, 0xA1, 0x01};  // Vendor page, Application
+    uint16_t usage         = 1;
+    for (const Variable& v : variables)
+    {
+        d.insert(d.end(), {0x75, v.bitSize, 0x95, 0x01, 0x09, static_cast<uint8_t>(usage++)});
+        if (v.isSigned)
+        {
+            d.insert(d.end(), {0x17, 0x00, 0x00, 0x00, 0x80, 0x27, 0xFF, 0xFF, 0xFF, 0x7F});  // INT32_MIN - INT32_MAX
+        }
+        else
+        {
+            d.insert(d.end(), {0x15, 0x00, 0x27, 0xFF, 0xFF, 0xFF, 0x7F});  // 0 - INT32_MAX
+        }
+        d.insert(d.end(), {0x81, 0x02});  // Input (Data, Var, Abs)
+    }
+    d.push_back(0xC0);
+    return d;
+}
+}  // namespace descriptors
@@ -0,0 +1,116 @@
+/**
+ * @file fuzz_main.cpp
+ * @brief Stand-alone driver for the fuzz targets, for compilers without libFuzzer.
+ *
+ *   fuzz_report_descriptor FILE...      Replay inputs, e.g. a crash found by libFuzzer
+ *   fuzz_report_descriptor [-runs=N]    Run N mutations of the seed descriptors (default 10000)
+ *
+ * Mutations are random byte flips, insertions, deletions and truncations from a fixed
+ * seed, so a run is reproducible; build with sanitizers to catch memory errors.
+ */
+
+#include "descriptors.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+namespace
+{
+std::vector<uint8_t> seedInput(const descriptors::Sample& sample)
+{
+    std::vector<uint8_t> input = {static_cast<uint8_t>(sample.descriptorLength),
+                                  static_cast<uint8_t>(sample.descriptorLength >> 8)};
+    input.insert(input.end(), sample.descriptor, sample.descriptor + sample.descriptorLength);
+    input.insert(input.end(), sample.report, sample.report + sample.reportLength);
+    return input;
+}
+
+void mutate(std::vector<uint8_t>& input, std::mt19937& random)
+{
+    const int edits = 1 + static_cast<int>(random() % 8);
+    for (int i = 0; i < edits; ++i)
+    {
+        const size_t at = input.empty() ? 0 : random() % input.size();
+        switch (random() % 5)
+        {
+        case 0:
+            if (!input.empty())
+            {
+                input[at] ^= static_cast<uint8_t>(1u << (random() % 8));
+            }
+            break;
+        case 1:
+            if (!input.empty())
+            {
+                input[at] = static_cast<uint8_t>(random());
+            }
+            break;
+        case 2:
+            input.insert(input.begin() + at, static_cast<uint8_t>(random()));
+            break;
+        case 3:
+            if (!input.empty())
+            {
+                input.erase(input.begin() + at);
+            }
+            break;
+        default:
+            input.resize(at);
+            break;
+        }
+    }
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    long runs = 10000;
+    std::vector<const char*> files;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], "-runs=", 6) == 0)
+        {
+            runs = std::strtol(argv[i] + 6, nullptr, 10);
+        }
+        else
+        {
+            files.push_back(argv[i]);
+        }
+    }
+
+    if (!files.empty())
+    {
+        for (const char* file : files)
+        {
+            std::ifstream in(file, std::ios::binary);
+            const std::vector<uint8_t> input((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            std::printf("Replaying %s (%zu bytes)\n", file, input.size());
+            LLVMFuzzerTestOneInput(input.data(), input.size());
+        }
+        return 0;
+    }
+
+    std::mt19937 random(12345);
+    for (const auto& sample : descriptors::SAMPLES)
+    {
+        const std::vector<uint8_t> seed = seedInput(sample);
+        LLVMFuzzerTestOneInput(seed.data(), seed.size());
+    }
+    for (long run = 0; run < runs; ++run)
+    {
+        const auto& sample         = descriptors::SAMPLES[random() % std::size(descriptors::SAMPLES)];
+        std::vector<uint8_t> input = seedInput(sample);
+        mutate(input, random);
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+    std::printf("Done %ld runs\n", runs);
+    return 0;
+}
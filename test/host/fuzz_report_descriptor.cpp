@@ -0,0 +1,95 @@
+/**
+ * @file fuzz_report_descriptor.cpp
+ * @brief libFuzzer target over UsbHidReportDescriptor::parse, UsbHidExtractionPlan::build and decode.
+ *
+ * Input: a 16-bit little-endian descriptor length, the descriptor, then one report.
+ * Besides crashes and sanitizer findings, every decoded report is checked against
+ * readBits(), the reference the kernels must agree with, so a wrong extraction is a
+ * finding too.
+ */
+
+#include "UsbHidExtractionPlan.h"
+#include "UsbHidReportDescriptor.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+void check(bool condition)
+{
+    if (!condition)
+    {
+        __builtin_trap();
+    }
+}
+
+int32_t reference(const uint8_t* payload, size_t length, const UsbHidExtractionPlan::Entry& entry)
+{
+    const uint32_t value = UsbHidExtractionPlan::readBits(payload, length, entry.bitOffset, entry.bitSize);
+    if ((entry.flags & UsbHidExtractionPlan::ENTRY_SIGNED) && entry.bitSize < 32 && (value >> (entry.bitSize - 1)) & 1)
+    {
+        return static_cast<int32_t>(value | ~((uint32_t(1) << entry.bitSize) - 1));
+    }
+    return static_cast<int32_t>(value);
+}
+
+void fuzzReport(const UsbHidExtractionPlan& plan, const uint8_t* report, size_t length)
+{
+    std::vector<UsbHidFieldValue> values(plan.maxValues());
+    const size_t decoded = plan.decode(report, length, values.data(), values.size());
+    check(decoded <= plan.maxValues());
+
+    std::vector<int32_t> simd(plan.maxValues());
+    std::vector<int32_t> scalar(plan.maxValues());
+    const size_t extracted = plan.extract(report, length, simd.data(), simd.size(), true);
+    check(plan.extract(report, length, scalar.data(), scalar.size(), false) == extracted);
+    check(std::equal(simd.begin(), simd.begin() + extracted, scalar.begin()));
+
+    if (plan.usesReportIds() && length == 0)
+    {
+        return;
+    }
+    const uint8_t reportId     = plan.usesReportIds() ? report[0] : 0;
+    const uint8_t* payload     = plan.usesReportIds() ? report + 1 : report;
+    const size_t payloadLength = plan.usesReportIds() ? length - 1 : length;
+
+    size_t count                               = 0;
+    const UsbHidExtractionPlan::Entry* entries = plan.entries(reportId, count);
+    check(count == extracted);
+    for (size_t i = 0; i < count; ++i)
+    {
+        check(scalar[i] == reference(payload, payloadLength, entries[i]));
+    }
+}
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    if (size < 2)
+    {
+        return 0;
+    }
+    const size_t descriptorLength = std::min<size_t>(data[0] | (data[1] << 8), size - 2);
+    const uint8_t* descriptorData = data + 2;
+    const uint8_t* report         = descriptorData + descriptorLength;
+    const size_t reportLength     = size - 2 - descriptorLength;
+
+    UsbHidReportDescriptor descriptor;
+    if (!descriptor.parse(descriptorData, descriptorLength))
+    {
+        return 0;
+    }
+    check(descriptor.fields().size() <= UsbHidReportDescriptor::MAX_FIELDS);
+    check(descriptor.applications().size() <= UsbHidReportDescriptor::MAX_APPLICATIONS);
+
+    UsbHidExtractionPlan plan;
+    for (const UsbHidReportType type : {UsbHidReportType::Output, UsbHidReportType::Feature, UsbHidReportType::Input})
+    {
+        plan.build(descriptor, type);
+    }
+    fuzzReport(plan, report, reportLength);
+    return 0;
+}
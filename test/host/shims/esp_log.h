@@ -0,0 +1,29 @@
+/**
+ * @file esp_log.h
+ * @brief Host stand-in for the ESP-IDF logging macros, for the host tests and benchmarks.
+ *
+ * The report sources log every report they decode; on the host the messages are
+ * type-checked and dropped so they neither flood the test output nor skew benchmarks.
+ */
+
+#pragma once
+
+typedef enum
+{
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+__attribute__((format(printf, 3, 4))) static inline void esp_log_host(esp_log_level_t, const char*, const char*, ...) {}
+
+static inline void esp_log_level_set(const char*, esp_log_level_t) {}
+
+#define ESP_LOGE(tag, format, ...) esp_log_host(ESP_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) esp_log_host(ESP_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) esp_log_host(ESP_LOG_INFO, tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) esp_log_host(ESP_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) esp_log_host(ESP_LOG_VERBOSE, tag, format, ##__VA_ARGS__)
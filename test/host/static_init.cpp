@@ -0,0 +1,56 @@
+/**
+ * @file static_init.cpp
+ * @brief Heap use and time of the report library's static initialisation.
+ *
+ * Every unit of src/reports is compiled into this executable, so all of their static
+ * constructors run before main(). Tables such as the key names must be constant data:
+ * on the ESP32-S3 anything built at startup costs boot time and DRAM that the heap
+ * never gets back. Fails when static initialisation allocates.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+size_t allocations = 0;
+size_t allocatedBytes = 0;
+std::chrono::steady_clock::time_point start;
+
+/// Constructed before any unprioritised static object, i.e. before the report units
+struct Start
+{
+    Start() { start = std::chrono::steady_clock::now(); }
+};
+Start startClock __attribute__((init_priority(101)));
+}  // namespace
+
+void* operator new(size_t size)
+{
+    ++allocations;
+    allocatedBytes += size;
+    if (void* p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+int main()
+{
+    const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    std::printf("static initialisation: %zu allocations, %zu bytes, %.1f us\n", allocations, allocatedBytes, us);
+    return allocations == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file test_consumer_report.cpp
+ * @brief UsbHidConsumerReport turning array and bitmap consumer reports into press and release edges.
+ */
+
+#include "UsbHidConsumerReport.h"
+#include "UsbHidReportDescriptor.h"
+#include "descriptors.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace
+{
+/// Feed one report and return the events it produced
+std::vector<UsbHidConsumerEvent> feed(UsbHidConsumerReport& consumer, std::vector<UsbHidConsumerEvent>& events,
+                                      std::initializer_list<uint8_t> report)
+{
+    events.clear();
+    const std::vector<uint8_t> data(report);
+    consumer.processReportData(data.data(), static_cast<int>(data.size()));
+    return events;
+}
+}  // namespace
+
+TEST(ConsumerReport, DecodesArraySlots)
+{
+    UsbHidReportDescriptor descriptor;
+    ASSERT_TRUE(descriptor.parse(descriptors::MOUSE_AND_CONSUMER, sizeof(descriptors::MOUSE_AND_CONSUMER)));
+    UsbHidConsumerReport consumer;
+    ASSERT_TRUE(consumer.useDescriptor(descriptor.inputReport(2)));
+    EXPECT_EQ(consumer.getInputReportId(), 2);
+    std::vector<UsbHidConsumerEvent> events;
+    consumer.registerCallback([&events](const UsbHidConsumerEvent& event) { events.push_back(event); });
+
+    ASSERT_EQ(feed(consumer, events, {0x02, 0xE9, 0x00, 0x00, 0x00}).size(), 1u);
+    EXPECT_EQ(events[0].usage, 0xE9);
+    EXPECT_TRUE(events[0].pressed);
+    EXPECT_EQ(events[0].name, "Volume Up");
+
+    // A second usage in the other slot presses only that one
+    ASSERT_EQ(feed(consumer, events, {0x02, 0xE9, 0x00, 0xCD, 0x00}).size(), 1u);
+    EXPECT_EQ(events[0].usage, 0xCD);
+    EXPECT_TRUE(events[0].pressed);
+
+    // Usages trading slots are still held
+    EXPECT_TRUE(feed(consumer, events, {0x02, 0xCD, 0x00, 0xE9, 0x00}).empty());
+    EXPECT_TRUE(consumer.isPressed(0xE9));
+    EXPECT_TRUE(consumer.isPressed(0xCD));
+
+    ASSERT_EQ(feed(consumer, events, {0x02, 0x00, 0x00, 0x00, 0x00}).size(), 2u);
+    EXPECT_FALSE(events[0].pressed);
+    EXPECT_FALSE(events[1].pressed);
+    EXPECT_FALSE(consumer.isPressed(0xE9));
+}
+
+TEST(ConsumerReport, ReleasesBeforePressing)
+{
+    UsbHidReportDescriptor descriptor;
+    ASSERT_TRUE(descriptor.parse(descriptors::MOUSE_AND_CONSUMER, sizeof(descriptors::MOUSE_AND_CONSUMER)));
+    UsbHidConsumerReport consumer;
+    ASSERT_TRUE(consumer.useDescriptor(descriptor.inputReport(2)));
+    std::vector<UsbHidConsumerEvent> events;
+    consumer.registerCallback([&events](const UsbHidConsumerEvent& event) { events.push_back(event); });
+
+    feed(consumer, events, {0x02, 0xE9, 0x00, 0x00, 0x00});
+
+    // Volume Up rolls over to Volume Down in the same slot
+    ASSERT_EQ(feed(consumer, events, {0x02, 0xEA, 0x00, 0x00, 0x00}).size(), 2u);
+    EXPECT_EQ(events[0].usage, 0xE9);
+    EXPECT_FALSE(events[0].pressed);
+    EXPECT_EQ(events[1].usage, 0xEA);
+    EXPECT_TRUE(events[1].pressed);
+}
+
+TEST(ConsumerReport, DecodesBitmaps)
+{
+    UsbHidReportDescriptor descriptor;
+    ASSERT_TRUE(descriptor.parse(descriptors::CONSUMER_BITMAP, sizeof(descriptors::CONSUMER_BITMAP)));
+    UsbHidConsumerReport consumer;
+    ASSERT_TRUE(consumer.useDescriptor(descriptor));
+    EXPECT_EQ(consumer.getInputReportId(), 3);
+    std::vector<UsbHidConsumerEvent> events;
+    consumer.registerCallback([&events](const UsbHidConsumerEvent& event) { events.push_back(event); });
+
+    // Play/Pause and Volume Up, in bit order
+    ASSERT_EQ(feed(consumer, events, {0x03, 0x05}).size(), 2u);
+    EXPECT_EQ(events[0].usage, 0xCD);
+    EXPECT_EQ(events[1].usage, 0xE9);
+    EXPECT_TRUE(events[0].pressed && events[1].pressed);
+
+    // Play/Pause released, Volume Down pressed: the release comes first
+    ASSERT_EQ(feed(consumer, events, {0x03, 0x0C}).size(), 2u);
+    EXPECT_EQ(events[0].usage, 0xCD);
+    EXPECT_FALSE(events[0].pressed);
+    EXPECT_EQ(events[1].usage, 0xEA);
+    EXPECT_TRUE(events[1].pressed);
+}
+
+TEST(ConsumerReport, KeepsUsagesHeldByOtherReportIds)
+{
+    UsbHidReportDescriptor descriptor;
+    ASSERT_TRUE(descriptor.parse(descriptors::CONSUMER_BITMAP, sizeof(descriptors::CONSUMER_BITMAP)));
+    UsbHidConsumerReport consumer;
+    ASSERT_TRUE(consumer.useDescriptor(descriptor));
+    std::vector<UsbHidConsumerEvent> events;
+    consumer.registerCallback([&events](const UsbHidConsumerEvent& event) { events.push_back(event); });
+
+    feed(consumer, events, {0x03, 0x04});
+    ASSERT_TRUE(consumer.isPressed(0xE9));
+
+    // Report ID 4 says nothing about Volume Up
+    ASSERT_EQ(feed(consumer, events, {0x04, 0x01}).size(), 1u);
+    EXPECT_EQ(events[0].usage, 0xB5);
+    EXPECT_TRUE(consumer.isPressed(0xE9));
+
+    ASSERT_EQ(feed(consumer, events, {0x04, 0x00}).size(), 1u);
+    EXPECT_EQ(events[0].usage, 0xB5);
+    EXPECT_FALSE(events[0].pressed);
+    EXPECT_TRUE(consumer.isPressed(0xE9));
+
+    // Each held usage is released once on disconnect
+    feed(consumer, events, {0x04, 0x08});
+    events.clear();
+    consumer.releaseAll();
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_FALSE(events[0].pressed);
+    EXPECT_FALSE(events[1].pressed);
+    EXPECT_FALSE(consumer.isPressed(0xE9));
+    EXPECT_FALSE(consumer.isPressed(0xB0));
+}
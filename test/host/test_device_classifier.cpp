@@ -0,0 +1,75 @@
+/**
+ * @file test_device_classifier.cpp
+ * @brief UsbHidDeviceClassifier results and its cache of parsed descriptors.
+ */
+
+#include "UsbHidDeviceClassifier.h"
+#include "descriptors.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+TEST(DeviceClassifier, ClassifiesEachReportId)
+{
+    UsbHidDeviceClassifier classifier;
+    const auto result = classifier.classify(descriptors::MOUSE_AND_CONSUMER, sizeof(descriptors::MOUSE_AND_CONSUMER));
+    ASSERT_TRUE(result->parsed);
+    EXPECT_EQ(result->classification.primary, UsbHidDeviceClass::Mouse);
+    EXPECT_TRUE(result->classification.has(UsbHidDeviceClass::Consumer));
+    EXPECT_EQ(result->reportClasses[1], UsbHidDeviceClass::Mouse);
+    EXPECT_EQ(result->reportClasses[2], UsbHidDeviceClass::Consumer);
+    EXPECT_EQ(result->reportClasses[3], UsbHidDeviceClass::Mouse) << "undeclared IDs fall back to the primary class";
+}
+
+TEST(DeviceClassifier, WithoutReportIdsEveryIdIsThePrimaryClass)
+{
+    UsbHidDeviceClassifier classifier;
+    const auto result = classifier.classify(descriptors::GAMEPAD, sizeof(descriptors::GAMEPAD));
+    ASSERT_TRUE(result->parsed);
+    EXPECT_EQ(result->reportClasses[0], UsbHidDeviceClass::Gamepad);
+    EXPECT_EQ(result->reportClasses[0x80], UsbHidDeviceClass::Gamepad);
+}
+
+TEST(DeviceClassifier, SameBytesReuseTheCachedResult)
+{
+    UsbHidDeviceClassifier classifier;
+    const auto first = classifier.classify(descriptors::NKRO_KEYBOARD, sizeof(descriptors::NKRO_KEYBOARD));
+
+    // A second device of the same model hands over its own copy of the descriptor
+    const std::vector<uint8_t> copy(std::begin(descriptors::NKRO_KEYBOARD), std::end(descriptors::NKRO_KEYBOARD));
+    EXPECT_EQ(classifier.classify(copy.data(), copy.size()), first);
+
+    // One byte different is another descriptor
+    std::vector<uint8_t> other = copy;
+    other[7]                   = 0x03;  // Report ID 3
+    const auto changed         = classifier.classify(other.data(), other.size());
+    EXPECT_NE(changed, first);
+    EXPECT_EQ(changed->reportClasses[3], UsbHidDeviceClass::Keyboard);
+}
+
+TEST(DeviceClassifier, EvictedResultsStayValid)
+{
+    UsbHidDeviceClassifier classifier;
+    const auto kept = classifier.classify(descriptors::BOOT_KEYBOARD, sizeof(descriptors::BOOT_KEYBOARD));
+    for (uint8_t i = 0; i < UsbHidDeviceClassifier::CACHE_SIZE; ++i)
+    {
+        std::vector<uint8_t> variant(std::begin(descriptors::MOUSE_AND_CONSUMER),
+                                     std::end(descriptors::MOUSE_AND_CONSUMER));
+        variant[7] = static_cast<uint8_t>(i + 3);  // The mouse's report ID
+        classifier.classify(variant.data(), variant.size());
+    }
+    EXPECT_EQ(kept->classification.primary, UsbHidDeviceClass::Keyboard);
+    EXPECT_NE(classifier.classify(descriptors::BOOT_KEYBOARD, sizeof(descriptors::BOOT_KEYBOARD)), kept)
+        << "evicted, so parsed again";
+}
+
+TEST(DeviceClassifier, MalformedDescriptorIsUnknown)
+{
+    UsbHidDeviceClassifier classifier;
+    const uint8_t truncated[] = {0x05, 0x01, 0x09, 0x06, 0xA1};
+    const auto result         = classifier.classify(truncated, sizeof(truncated));
+    EXPECT_FALSE(result->parsed);
+    EXPECT_EQ(result->classification.primary, UsbHidDeviceClass::Unknown);
+    EXPECT_FALSE(classifier.classify(nullptr, 0)->parsed);
+}
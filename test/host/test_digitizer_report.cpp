@@ -0,0 +1,200 @@
+/**
+ * @file test_digitizer_report.cpp
+ * @brief UsbHidDigitizerReport gathering hybrid-mode frames and tracking contacts from down to up.
+ */
+
+#include "UsbHidDigitizerReport.h"
+#include "UsbHidReportDescriptor.h"
+#include "UsbHidTimerWheel.h"
+#include "descriptors.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace
+{
+/// One finger of a TOUCH_SCREEN report
+struct Finger
+{
+    uint16_t id;
+    uint16_t x;
+    uint16_t y;
+    bool tip = true;
+};
+
+/// A touch panel decoding TOUCH_SCREEN, recording its events
+class DigitizerReportTest : public ::testing::Test
+{
+protected:
+    DigitizerReportTest() : wheel(1), digitizer(wheel) {}
+
+    void SetUp() override
+    {
+        UsbHidReportDescriptor descriptor;
+        ASSERT_TRUE(descriptor.parse(descriptors::TOUCH_SCREEN, sizeof(descriptors::TOUCH_SCREEN)));
+        ASSERT_TRUE(digitizer.useDescriptor(descriptor));
+        digitizer.registerCallback([this](const UsbHidTouchEvent& event) { events.push_back(event); });
+    }
+
+    /// Feed one report of up to two fingers and return the events it produced
+    const std::vector<UsbHidTouchEvent>& feed(uint8_t contactCount, std::initializer_list<Finger> fingers)
+    {
+        std::vector<uint8_t> report = {0x01};
+        for (const Finger& finger : fingers)
+        {
+            report.insert(report.end(), {static_cast<uint8_t>(finger.tip ? 0x03 : 0x02),
+                                         static_cast<uint8_t>(finger.id), static_cast<uint8_t>(finger.id >> 8),
+                                         static_cast<uint8_t>(finger.x), static_cast<uint8_t>(finger.x >> 8),
+                                         static_cast<uint8_t>(finger.y), static_cast<uint8_t>(finger.y >> 8)});
+        }
+        report.resize(1 + 2 * 7, 0);
+        report.push_back(contactCount);
+
+        events.clear();
+        digitizer.processReportData(report.data(), static_cast<int>(report.size()));
+        return events;
+    }
+
+    /// Put down contacts 1 to @p count, two per report
+    void touchDown(uint16_t count)
+    {
+        for (uint16_t id = 1; id <= count; id += 2)
+        {
+            if (id < count)
+            {
+                feed(id == 1 ? count : 0, {{id, 10, 10}, {static_cast<uint16_t>(id + 1), 20, 20}});
+            }
+            else
+            {
+                feed(id == 1 ? count : 0, {{id, 10, 10}});
+            }
+        }
+    }
+
+    UsbHidTimerWheel wheel;
+    UsbHidDigitizerReport digitizer;
+    std::vector<UsbHidTouchEvent> events;
+};
+}  // namespace
+
+TEST_F(DigitizerReportTest, GathersAFrameSpreadOverTwoReports)
+{
+    EXPECT_EQ(digitizer.getInputReportId(), 1);
+    EXPECT_EQ(digitizer.getMaxX(), 4095);
+
+    // Three contacts: nothing happens until the second report completes the frame
+    EXPECT_TRUE(feed(3, {{1, 100, 200}, {2, 300, 400}}).empty());
+    ASSERT_EQ(feed(0, {{3, 500, 600}}).size(), 3u);
+    for (size_t i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(events[i].phase, UsbHidTouchPhase::Down);
+        EXPECT_EQ(events[i].contactId, i + 1);
+        EXPECT_EQ(events[i].contactCount, i + 1);
+    }
+    EXPECT_EQ(events[2].x, 500);
+    EXPECT_EQ(events[2].y, 600);
+    EXPECT_EQ(digitizer.getContactCount(), 3u);
+}
+
+TEST_F(DigitizerReportTest, ContactCountZeroLiftsAllContacts)
+{
+    touchDown(2);
+    ASSERT_EQ(digitizer.getContactCount(), 2u);
+
+    ASSERT_EQ(feed(0, {}).size(), 2u);
+    EXPECT_EQ(events[0].phase, UsbHidTouchPhase::Up);
+    EXPECT_EQ(events[1].phase, UsbHidTouchPhase::Up);
+    EXPECT_EQ(events[1].contactCount, 0);
+    EXPECT_EQ(digitizer.getContactCount(), 0u);
+}
+
+TEST_F(DigitizerReportTest, TracksIdsSharingALowByte)
+{
+    ASSERT_EQ(feed(2, {{0x101, 10, 10}, {0x201, 20, 20}}).size(), 2u);
+    EXPECT_EQ(events[0].contactId, 0x101u);
+    EXPECT_EQ(events[1].contactId, 0x201u);
+
+    // 0x201 is found by scanning, and is not mistaken for 0x101
+    ASSERT_EQ(feed(2, {{0x101, 10, 10}, {0x201, 25, 20}}).size(), 1u);
+    EXPECT_EQ(events[0].phase, UsbHidTouchPhase::Move);
+    EXPECT_EQ(events[0].contactId, 0x201u);
+    EXPECT_EQ(events[0].x, 25);
+
+    // 0x101 lifts; 0x001 takes the low byte over while 0x201 is still scanned for
+    ASSERT_EQ(feed(2, {{0x201, 25, 20}, {0x001, 30, 30}}).size(), 2u);
+    EXPECT_EQ(events[0].phase, UsbHidTouchPhase::Down);
+    EXPECT_EQ(events[0].contactId, 0x001u);
+    EXPECT_EQ(events[1].phase, UsbHidTouchPhase::Up);
+    EXPECT_EQ(events[1].contactId, 0x101u);
+
+    ASSERT_EQ(feed(2, {{0x201, 26, 20}, {0x001, 31, 30}}).size(), 2u);
+    EXPECT_EQ(events[0].contactId, 0x201u);
+    EXPECT_EQ(events[0].phase, UsbHidTouchPhase::Move);
+    EXPECT_EQ(events[1].contactId, 0x001u);
+    EXPECT_EQ(events[1].phase, UsbHidTouchPhase::Move);
+
+    ASSERT_EQ(feed(0, {}).size(), 2u);
+    EXPECT_EQ(digitizer.getContactCount(), 0u);
+}
+
+TEST_F(DigitizerReportTest, NewContactWaitsForARowWhenTheTableIsFull)
+{
+    touchDown(UsbHidDigitizerReport::MAX_CONTACTS);
+    ASSERT_EQ(digitizer.getContactCount(), UsbHidDigitizerReport::MAX_CONTACTS);
+
+    // Contact 1 lifts while 11 arrives: 11 finds no free row before 1 is lifted
+    auto nextFrame = [this]()
+    {
+        std::vector<UsbHidTouchEvent> frame;
+        for (uint16_t id = 2; id <= 11; id += 2)
+        {
+            feed(id == 2 ? 10 : 0, {{id, 20, 20}, {static_cast<uint16_t>(id + 1), 10, 10}});
+            frame.insert(frame.end(), events.begin(), events.end());
+        }
+        return frame;
+    };
+    std::vector<UsbHidTouchEvent> frame = nextFrame();
+    ASSERT_EQ(frame.size(), 1u);
+    EXPECT_EQ(frame[0].phase, UsbHidTouchPhase::Up);
+    EXPECT_EQ(frame[0].contactId, 1u);
+
+    frame = nextFrame();
+    ASSERT_EQ(frame.size(), 1u);
+    EXPECT_EQ(frame[0].phase, UsbHidTouchPhase::Down);
+    EXPECT_EQ(frame[0].contactId, 11u);
+    EXPECT_EQ(frame[0].contactCount, UsbHidDigitizerReport::MAX_CONTACTS);
+}
+
+TEST_F(DigitizerReportTest, ReportsDownMoveUpInFrameOrderWithWheelTime)
+{
+    wheel.advance(10);
+    ASSERT_EQ(feed(2, {{1, 100, 100}, {2, 200, 200}}).size(), 2u);
+    EXPECT_EQ(events[0].time, 10u);
+
+    // Within a frame: its contacts in report order, then the ones it left out
+    wheel.advance(20);
+    ASSERT_EQ(feed(2, {{1, 110, 100}, {3, 300, 300}}).size(), 3u);
+    EXPECT_EQ(events[0].phase, UsbHidTouchPhase::Move);
+    EXPECT_EQ(events[0].contactId, 1u);
+    EXPECT_EQ(events[1].phase, UsbHidTouchPhase::Down);
+    EXPECT_EQ(events[1].contactId, 3u);
+    EXPECT_EQ(events[2].phase, UsbHidTouchPhase::Up);
+    EXPECT_EQ(events[2].contactId, 2u);
+    for (const auto& event : events)
+    {
+        EXPECT_EQ(event.time, 20u);
+    }
+
+    // A lifted tip ends the contact without waiting for it to go missing
+    wheel.advance(30);
+    ASSERT_EQ(feed(2, {{1, 110, 100, false}, {3, 300, 300}}).size(), 1u);
+    EXPECT_EQ(events[0].phase, UsbHidTouchPhase::Up);
+    EXPECT_EQ(events[0].contactId, 1u);
+    EXPECT_EQ(events[0].x, 110);
+    EXPECT_EQ(events[0].time, 30u);
+
+    // Unchanged contacts stay quiet
+    wheel.advance(40);
+    EXPECT_TRUE(feed(1, {{3, 300, 300}}).empty());
+}
@@ -0,0 +1,186 @@
+/**
+ * @file test_extraction_plan.cpp
+ * @brief The scalar and SIMD extraction kernels must both agree with readBits().
+ *
+ * Built twice: into usbhid_tests with the default flags, where only the scalar kernel
+ * exists, and into usbhid_tests_avx2 with the plan compiled for AVX2.
+ */
+
+#include "UsbHidExtractionPlan.h"
+#include "UsbHidReportDescriptor.h"
+#include "descriptors.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+namespace
+{
+/// readBits() with the sign extension extract() applies to signed entries
+int32_t reference(const uint8_t* payload, size_t length, const UsbHidExtractionPlan::Entry& entry)
+{
+    const uint32_t value = UsbHidExtractionPlan::readBits(payload, length, entry.bitOffset, entry.bitSize);
+    if ((entry.flags & UsbHidExtractionPlan::ENTRY_SIGNED) && entry.bitSize < 32 && (value >> (entry.bitSize - 1)) & 1)
+    {
+        return static_cast<int32_t>(value | ~((uint32_t(1) << entry.bitSize) - 1));
+    }
+    return static_cast<int32_t>(value);
+}
+
+/// Extract a report with both kernels and compare every value with the reference
+void expectKernelsAgree(const UsbHidExtractionPlan& plan, const uint8_t* report, size_t length)
+{
+    std::vector<int32_t> simd(plan.maxValues(), -1);
+    std::vector<int32_t> scalar(plan.maxValues(), -2);
+    const size_t count = plan.extract(report, length, simd.data(), simd.size(), true);
+    ASSERT_EQ(plan.extract(report, length, scalar.data(), scalar.size(), false), count);
+
+    const bool ids = plan.usesReportIds();
+    if (ids && length == 0)
+    {
+        EXPECT_EQ(count, 0u) << "no report ID to look up";
+        return;
+    }
+    const uint8_t* payload = ids ? report + 1 : report;
+    size_t entryCount      = 0;
+    const auto* entries    = plan.entries(ids ? report[0] : 0, entryCount);
+    ASSERT_EQ(entryCount, count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const int32_t expected = reference(payload, ids ? length - 1 : length, entries[i]);
+        ASSERT_EQ(scalar[i], expected) << "entry " << i << ", bit " << entries[i].bitOffset << ", size "
+                                       << int(entries[i].bitSize) << ", report length " << length;
+        ASSERT_EQ(simd[i], expected) << "entry " << i << ", bit " << entries[i].bitOffset << ", size "
+                                     << int(entries[i].bitSize) << ", report length " << length;
+    }
+}
+
+bool simdUsable()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return !UsbHidExtractionPlan::hasSimdKernel() || __builtin_cpu_supports("avx2");
+#else
+    return true;
+#endif
+}
+}  // namespace
+
+TEST(ExtractionPlan, ReadBitsAtEveryOffsetAndSize)
+{
+    const uint8_t payload[6] = {0xA5, 0x3C, 0xF0, 0x0F, 0x81, 0x7E};
+    for (uint32_t size = 1; size <= 32; ++size)
+    {
+        for (uint32_t offset = 0; offset + size <= 8 * sizeof(payload); ++offset)
+        {
+            uint32_t expected = 0;
+            for (uint32_t bit = 0; bit < size; ++bit)
+            {
+                const uint32_t at = offset + bit;
+                expected |= static_cast<uint32_t>((payload[at / 8] >> (at % 8)) & 1) << bit;
+            }
+            ASSERT_EQ(UsbHidExtractionPlan::readBits(payload, sizeof(payload), offset, static_cast<uint8_t>(size)),
+                      expected)
+                << "offset " << offset << ", size " << size;
+        }
+    }
+    EXPECT_EQ(UsbHidExtractionPlan::readBits(payload, sizeof(payload), 44, 8), 0u) << "crosses the end";
+}
+
+TEST(ExtractionPlan, KernelsAgreeOnSampleDevices)
+{
+    if (!simdUsable())
+    {
+        GTEST_SKIP() << "CPU lacks AVX2";
+    }
+    for (const auto& sample : descriptors::SAMPLES)
+    {
+        SCOPED_TRACE(sample.name);
+        UsbHidReportDescriptor descriptor;
+        ASSERT_TRUE(descriptor.parse(sample.descriptor, sample.descriptorLength));
+        UsbHidExtractionPlan plan;
+        ASSERT_TRUE(plan.build(descriptor));
+
+        // The full report, then every truncation of it
+        for (size_t length = sample.reportLength + 1; length-- > 0;)
+        {
+            expectKernelsAgree(plan, sample.report, length);
+        }
+    }
+}
+
+TEST(ExtractionPlan, KernelsAgreeOnRandomLayouts)
+{
+    if (!simdUsable())
+    {
+        GTEST_SKIP() << "CPU lacks AVX2";
+    }
+    std::mt19937 random(2024);
+    for (int layout = 0; layout < 200; ++layout)
+    {
+        // Up to 100 elements of 1 - 32 bits, so blocks of eight mix narrow, wide and word-crossing elements
+        std::vector<descriptors::Variable> variables(1 + random() % 100);
+        size_t bits = 0;
+        for (auto& v : variables)
+        {
+            v.bitSize  = static_cast<uint8_t>(1 + random() % 32);
+            v.isSigned = random() % 2 == 0;
+            bits += v.bitSize;
+        }
+        const std::vector<uint8_t> bytes = descriptors::makeVariables(variables);
+
+        UsbHidReportDescriptor descriptor;
+        ASSERT_TRUE(descriptor.parse(bytes.data(), bytes.size()));
+        UsbHidExtractionPlan plan;
+        ASSERT_TRUE(plan.build(descriptor));
+        ASSERT_EQ(plan.maxValues(), variables.size());
+
+        std::vector<uint8_t> report((bits + 7) / 8 + 4);
+        for (auto& byte : report)
+        {
+            byte = static_cast<uint8_t>(random());
+        }
+        // Full length, over-long, and cut short in the middle of the elements
+        for (const size_t length : {report.size(), report.size() - 4, report.size() / 2, size_t(3), size_t(0)})
+        {
+            SCOPED_TRACE(testing::Message() << "layout " << layout << ", length " << length);
+            expectKernelsAgree(plan, report.data(), length);
+        }
+    }
+}
+
+TEST(ExtractionPlan, DecodeUsesTheExtractedValues)
+{
+    UsbHidReportDescriptor descriptor;
+    ASSERT_TRUE(descriptor.parse(descriptors::MOUSE_AND_CONSUMER, sizeof(descriptors::MOUSE_AND_CONSUMER)));
+    UsbHidExtractionPlan plan;
+    ASSERT_TRUE(plan.build(descriptor));
+
+    std::vector<UsbHidFieldValue> values(plan.maxValues());
+    const size_t count = plan.decode(descriptors::MOUSE_REPORT, sizeof(descriptors::MOUSE_REPORT), values.data(),
+                                     values.size());
+    ASSERT_EQ(count, 9u);  // Five buttons, X, Y, wheel, pan
+    EXPECT_EQ(values[0].value, 1);
+    EXPECT_EQ(values[1].value, 0);
+    EXPECT_EQ(values[2].value, 1);
+    EXPECT_EQ(values[5].usage, 0x30);
+    EXPECT_EQ(values[5].value, 0x1234);
+    EXPECT_EQ(values[6].value, -52);
+    EXPECT_EQ(values[7].value, 1);
+    EXPECT_EQ(values[8].usagePage, 0x0C);
+    EXPECT_EQ(values[8].value, -1);
+
+    // Array slots yield the selected usages only
+    const size_t selected = plan.decode(descriptors::CONSUMER_REPORT, sizeof(descriptors::CONSUMER_REPORT),
+                                        values.data(), values.size());
+    ASSERT_EQ(selected, 2u);
+    EXPECT_EQ(values[0].usage, 0xE9);
+    EXPECT_EQ(values[1].usage, 0xCD);
+}
+
+TEST(ExtractionPlan, SimdKernelMatchesTheBuild)
+{
+    // Set for the build that compiles the plan for AVX2, so the comparisons above are not scalar against scalar
+    EXPECT_EQ(UsbHidExtractionPlan::hasSimdKernel(), USBHID_EXPECT_SIMD_KERNEL != 0);
+}
@@ -0,0 +1,67 @@
+/**
+ * @file test_gamepad_report.cpp
+ * @brief Which elements of a descriptor UsbHidGamepadReport takes as gamepad axes and buttons.
+ */
+
+#include "UsbHidGamepadReport.h"
+#include "UsbHidReportDescriptor.h"
+#include "descriptors.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace
+{
+/// Feed one report and return the events it produced
+std::vector<UsbHidGamepadEvent> feed(UsbHidGamepadReport& gamepad, std::vector<UsbHidGamepadEvent>& events,
+                                     std::initializer_list<uint8_t> report)
+{
+    events.clear();
+    const std::vector<uint8_t> data(report);
+    gamepad.processReportData(data.data(), static_cast<int>(data.size()));
+    return events;
+}
+}  // namespace
+
+TEST(GamepadReport, IgnoresTheMouseOfACompositeDevice)
+{
+    UsbHidReportDescriptor descriptor;
+    ASSERT_TRUE(descriptor.parse(descriptors::MOUSE_AND_GAMEPAD, sizeof(descriptors::MOUSE_AND_GAMEPAD)));
+    UsbHidGamepadReport gamepad;
+    ASSERT_TRUE(gamepad.useDescriptor(descriptor));
+    std::vector<UsbHidGamepadEvent> events;
+    gamepad.registerCallback([&events](const UsbHidGamepadEvent& event) { events.push_back(event); });
+
+    EXPECT_EQ(gamepad.getInputReportId(), 2);
+    EXPECT_TRUE(gamepad.hasAxis(UsbHidGamepadAxis::X));
+    EXPECT_TRUE(gamepad.hasAxis(UsbHidGamepadAxis::Y));
+
+    // Mouse motion and buttons must not move the gamepad
+    EXPECT_TRUE(feed(gamepad, events, {0x01, 0x07, 0x7F, 0x81}).empty());
+    EXPECT_EQ(gamepad.getButtons(), 0u);
+    EXPECT_EQ(gamepad.getAxis(UsbHidGamepadAxis::X), 0);
+
+    // Its own report uses the 0 - 255 calibration, not the mouse's -127 - 127
+    ASSERT_EQ(feed(gamepad, events, {0x02, 0xFF, 0x00, 0x81}).size(), 1u);
+    EXPECT_EQ(events[0].axis(UsbHidGamepadAxis::X), UsbHidGamepadReport::AXIS_MAX);
+    EXPECT_EQ(events[0].axis(UsbHidGamepadAxis::Y), -UsbHidGamepadReport::AXIS_MAX);
+    EXPECT_EQ(events[0].buttons, 0x81u);
+}
+
+TEST(GamepadReport, DecodesAPlainGamepad)
+{
+    UsbHidReportDescriptor descriptor;
+    ASSERT_TRUE(descriptor.parse(descriptors::GAMEPAD, sizeof(descriptors::GAMEPAD)));
+    UsbHidGamepadReport gamepad;
+    ASSERT_TRUE(gamepad.useDescriptor(descriptor));
+
+    const std::vector<uint8_t> report(std::begin(descriptors::GAMEPAD_REPORT), std::end(descriptors::GAMEPAD_REPORT));
+    std::vector<UsbHidGamepadEvent> events;
+    gamepad.registerCallback([&events](const UsbHidGamepadEvent& event) { events.push_back(event); });
+    gamepad.processReportData(report.data(), static_cast<int>(report.size()));
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].hat, UsbHidGamepadHat::Right);
+    EXPECT_EQ(events[0].buttons, 0xA55Au);
+    EXPECT_EQ(events[0].axis(UsbHidGamepadAxis::Rz), UsbHidGamepadReport::AXIS_MAX);
+}
@@ -0,0 +1,188 @@
+/**
+ * @file test_generic_report.cpp
+ * @brief Which elements UsbHidGenericReport reports as changed, and when it stays quiet.
+ */
+
+#include "UsbHidGenericReport.h"
+#include "UsbHidReportDescriptor.h"
+#include "descriptors.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace
+{
+/// An event copied out of its callback, whose spans end with the callback
+struct Received
+{
+    std::vector<uint8_t> data;
+    std::vector<UsbHidFieldChange> changes;
+};
+
+/// A report decoding MOUSE_AND_CONSUMER, recording its events
+class GenericReportTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(descriptor.parse(descriptors::MOUSE_AND_CONSUMER, sizeof(descriptors::MOUSE_AND_CONSUMER)));
+        ASSERT_TRUE(report.useDescriptor(descriptor));
+        report.registerCallback(
+            [this](const UsbHidGenericEvent& event)
+            {
+                events.push_back({{event.data.begin(), event.data.end()}, {event.changes.begin(), event.changes.end()}});
+            });
+    }
+
+    /// Feed one report and return the events it produced
+    const std::vector<Received>& feed(std::initializer_list<uint8_t> data)
+    {
+        events.clear();
+        const std::vector<uint8_t> bytes(data);
+        report.processReportData(bytes.data(), static_cast<int>(bytes.size()));
+        return events;
+    }
+
+    UsbHidReportDescriptor descriptor;
+    UsbHidGenericReport report;
+    std::vector<Received> events;
+};
+
+/// The change of one usage in @p changes, nullptr if it did not change
+const UsbHidFieldChange* find(const std::vector<UsbHidFieldChange>& changes, uint16_t usagePage, uint16_t usage)
+{
+    for (const auto& change : changes)
+    {
+        if (change.usagePage == usagePage && change.usage == usage)
+        {
+            return &change;
+        }
+    }
+    return nullptr;
+}
+}  // namespace
+
+TEST_F(GenericReportTest, FirstReportIsComparedWithAnIdleDevice)
+{
+    ASSERT_EQ(feed({0x01, 0x05, 0x34, 0x12, 0xCC, 0xFF, 0x01, 0xFF}).size(), 1u);
+    const auto& changes = events[0].changes;
+
+    // Buttons 1 and 3, X, Y, wheel and AC Pan; the released buttons were already 0
+    EXPECT_EQ(changes.size(), 6u);
+    for (const auto& change : changes)
+    {
+        EXPECT_EQ(change.reportId, 1);
+        EXPECT_EQ(change.previous, 0);
+    }
+    ASSERT_NE(find(changes, 0x09, 1), nullptr);
+    ASSERT_NE(find(changes, 0x09, 3), nullptr);
+    EXPECT_EQ(find(changes, 0x09, 2), nullptr);
+    ASSERT_NE(find(changes, 0x01, 0x30), nullptr);
+    EXPECT_EQ(find(changes, 0x01, 0x30)->value, 0x1234);
+    ASSERT_NE(find(changes, 0x01, 0x31), nullptr);
+    EXPECT_EQ(find(changes, 0x01, 0x31)->value, -52);
+    ASSERT_NE(find(changes, 0x0C, 0x238), nullptr);
+    EXPECT_EQ(find(changes, 0x0C, 0x238)->value, -1);
+
+    // The event views the report it came from
+    EXPECT_EQ(events[0].data, report.getReportData());
+
+    // An idle report after a release starts from zero again
+    report.releaseAll();
+    EXPECT_TRUE(feed({0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}).empty());
+}
+
+TEST_F(GenericReportTest, EachReportIdKeepsItsOwnValues)
+{
+    ASSERT_EQ(feed({0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}).size(), 1u);
+    ASSERT_EQ(feed({0x02, 0xE9, 0x00, 0x00, 0x00}).size(), 1u);
+    ASSERT_EQ(events[0].changes.size(), 1u);
+    EXPECT_EQ(events[0].changes[0].reportId, 2);
+    EXPECT_EQ(events[0].changes[0].usage, 0xE9);
+    EXPECT_EQ(events[0].changes[0].value, 1);
+
+    // Neither report is compared with the other one in between
+    EXPECT_TRUE(feed({0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}).empty());
+    EXPECT_TRUE(feed({0x02, 0xE9, 0x00, 0x00, 0x00}).empty());
+
+    ASSERT_EQ(feed({0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}).size(), 1u);
+    ASSERT_EQ(events[0].changes.size(), 1u);
+    EXPECT_EQ(events[0].changes[0].usage, 1);
+    EXPECT_EQ(events[0].changes[0].value, 0);
+    EXPECT_EQ(events[0].changes[0].previous, 1);
+}
+
+TEST_F(GenericReportTest, UsageMovingBetweenArraySlotsStaysSelected)
+{
+    ASSERT_EQ(feed({0x02, 0xE9, 0x00, 0xCD, 0x00}).size(), 1u);
+    EXPECT_EQ(events[0].changes.size(), 2u);
+
+    // Both usages swap slots: nothing was pressed or released
+    EXPECT_TRUE(feed({0x02, 0xCD, 0x00, 0xE9, 0x00}).empty());
+
+    // 0xE9 moves back while 0xCD is replaced by 0xB5
+    ASSERT_EQ(feed({0x02, 0xE9, 0x00, 0xB5, 0x00}).size(), 1u);
+    const auto& changes = events[0].changes;
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(find(changes, 0x0C, 0xE9), nullptr);
+    ASSERT_NE(find(changes, 0x0C, 0xCD), nullptr);
+    EXPECT_EQ(find(changes, 0x0C, 0xCD)->value, 0);
+    ASSERT_NE(find(changes, 0x0C, 0xB5), nullptr);
+    EXPECT_EQ(find(changes, 0x0C, 0xB5)->value, 1);
+}
+
+TEST(GenericReport, ComparesWholeReportsWithoutADescriptor)
+{
+    UsbHidGenericReport report;
+    std::vector<std::vector<uint8_t>> events;
+    report.registerCallback(
+        [&events](const UsbHidGenericEvent& event)
+        {
+            EXPECT_TRUE(event.changes.empty());
+            events.emplace_back(event.data.begin(), event.data.end());
+        });
+
+    const uint8_t first[3]  = {0x01, 0x02, 0x03};
+    const uint8_t second[3] = {0x01, 0x02, 0x04};
+    report.processReportData(first, sizeof(first));
+    report.processReportData(first, sizeof(first));
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0], std::vector<uint8_t>(first, first + 3));
+
+    report.processReportData(second, sizeof(second));
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[1], std::vector<uint8_t>(second, second + 3));
+
+    // A shorter report with the same leading bytes still differs
+    report.processReportData(second, 2);
+    EXPECT_EQ(events.size(), 3u);
+}
+
+TEST(GenericReport, NotifiesTheSubscriptionsOfItsOwner)
+{
+    UsbHidReportDescriptor descriptor;
+    ASSERT_TRUE(descriptor.parse(descriptors::MOUSE_AND_CONSUMER, sizeof(descriptors::MOUSE_AND_CONSUMER)));
+
+    UsbHidGenericReport owner;
+    UsbHidGenericReport decoder;
+    ASSERT_TRUE(decoder.useDescriptor(descriptor));
+    decoder.useSubscriptionsOf(owner);
+
+    std::vector<UsbHidFieldChange> ownerChanges;
+    int decoderChanges = 0;
+    decoder.subscribe(0x0C, 0xE9, [&decoderChanges](const UsbHidFieldChange&) { ++decoderChanges; });
+
+    // Subscriptions made after binding count too, the owner's list is read on every report
+    owner.subscribe(0x0C, 0xE9, [&ownerChanges](const UsbHidFieldChange& change) { ownerChanges.push_back(change); });
+
+    const uint8_t press[5]   = {0x02, 0xE9, 0x00, 0x00, 0x00};
+    const uint8_t release[5] = {0x02, 0x00, 0x00, 0x00, 0x00};
+    decoder.processReportData(press, sizeof(press));
+    decoder.processReportData(release, sizeof(release));
+    ASSERT_EQ(ownerChanges.size(), 2u);
+    EXPECT_EQ(ownerChanges[0].value, 1);
+    EXPECT_EQ(ownerChanges[1].value, 0);
+    EXPECT_EQ(ownerChanges[1].previous, 1);
+    EXPECT_EQ(decoderChanges, 0);
+}
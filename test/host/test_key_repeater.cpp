@@ -0,0 +1,158 @@
+/**
+ * @file test_key_repeater.cpp
+ * @brief UsbHidKeyRepeater and keyboard typematic repeat, driven by a simulated clock.
+ */
+
+#include "UsbHidKeyRepeater.h"
+#include "UsbHidKeyboardReport.h"
+#include "UsbHidTimerWheel.h"
+
+#include <gtest/gtest.h>
+
+#include <utility>
+#include <vector>
+
+namespace
+{
+using Millis = UsbHidTimerWheel::Millis;
+
+constexpr uint8_t KEY_A      = 0x04;
+constexpr uint8_t KEY_B      = 0x05;
+constexpr uint8_t CAPS_LOCK  = 0x39;
+constexpr uint8_t LEFT_SHIFT = 0xE1;
+
+/**
+ * @brief A repeater on a 1 ms wheel, recording (time, key) for every repeat.
+ */
+class KeyRepeaterTest : public ::testing::Test
+{
+protected:
+    UsbHidTimerWheel wheel{1};
+    std::vector<std::pair<Millis, uint8_t>> repeats;
+    UsbHidKeyRepeater repeater{wheel, {500, 33}, [this](uint8_t keyCode)
+                               { repeats.emplace_back(wheel.now(), keyCode); }};
+
+    void advanceTo(Millis until)
+    {
+        for (Millis now = wheel.now() + 1; now <= until; ++now)
+        {
+            wheel.advance(now);
+        }
+    }
+};
+}  // namespace
+
+TEST_F(KeyRepeaterTest, RepeatsAfterDelayThenAtInterval)
+{
+    repeater.onKey(KEY_A, true);
+    advanceTo(499);
+    EXPECT_TRUE(repeats.empty());
+
+    advanceTo(566);
+    EXPECT_EQ(repeats, (std::vector<std::pair<Millis, uint8_t>>{{500, KEY_A}, {533, KEY_A}, {566, KEY_A}}));
+    EXPECT_EQ(repeater.getRepeatingKey(), KEY_A);
+}
+
+TEST_F(KeyRepeaterTest, ReleaseStopsRepeating)
+{
+    repeater.onKey(KEY_A, true);
+    advanceTo(540);
+    repeater.onKey(KEY_A, false);
+    advanceTo(2000);
+
+    EXPECT_EQ(repeats.size(), 2u);
+    EXPECT_EQ(repeater.getRepeatingKey(), 0);
+    EXPECT_EQ(wheel.armedCount(), 0u);
+}
+
+TEST_F(KeyRepeaterTest, NewestKeyTakesOver)
+{
+    repeater.onKey(KEY_A, true);
+    advanceTo(520);
+    repeater.onKey(KEY_B, true);
+
+    // Releasing the older key does not stop the newer one
+    repeater.onKey(KEY_A, false);
+    advanceTo(1019);
+    EXPECT_EQ(repeats, (std::vector<std::pair<Millis, uint8_t>>{{500, KEY_A}}));
+
+    advanceTo(1020);
+    EXPECT_EQ(repeats.back(), (std::pair<Millis, uint8_t>{1020, KEY_B}));
+}
+
+TEST_F(KeyRepeaterTest, ModifiersAndLocksDoNotRepeat)
+{
+    repeater.onKey(LEFT_SHIFT, true);
+    repeater.onKey(CAPS_LOCK, true);
+    advanceTo(2000);
+    EXPECT_TRUE(repeats.empty());
+    EXPECT_FALSE(UsbHidKeyRepeater::isRepeatable(LEFT_SHIFT));
+    EXPECT_FALSE(UsbHidKeyRepeater::isRepeatable(CAPS_LOCK));
+    EXPECT_TRUE(UsbHidKeyRepeater::isRepeatable(KEY_A));
+
+    // A modifier pressed while a key repeats leaves the repeat running
+    repeater.onKey(KEY_A, true);
+    advanceTo(2600);
+    repeater.onKey(LEFT_SHIFT, false);
+    advanceTo(2700);
+    EXPECT_EQ(repeats.size(), 7u);
+}
+
+TEST_F(KeyRepeaterTest, CancelFromTheRepeatCallback)
+{
+    UsbHidKeyRepeater* self = nullptr;
+    int count               = 0;
+    UsbHidKeyRepeater once(wheel, {100, 10}, [&](uint8_t)
+                           {
+                               ++count;
+                               self->cancel();
+                           });
+    self = &once;
+
+    once.onKey(KEY_A, true);
+    advanceTo(1000);
+    EXPECT_EQ(count, 1);
+    EXPECT_EQ(wheel.armedCount(), 0u);
+}
+
+TEST(KeyboardRepeat, HeldKeyProducesRepeatEvents)
+{
+    UsbHidTimerWheel wheel(1);
+    UsbHidKeyboardReport keyboard;
+    keyboard.enableKeyRepeat(wheel, {200, 50});
+
+    std::vector<std::pair<Millis, bool>> downs;
+    int ups = 0;
+    keyboard.registerCallback([&](const UsbHidKeyboardEvent& event)
+                              {
+                                  if (event.pressed)
+                                  {
+                                      downs.emplace_back(wheel.now(), event.repeat);
+                                  }
+                                  else
+                                  {
+                                      ++ups;
+                                  }
+                              });
+
+    const uint8_t press[8]   = {0, 0, KEY_A, 0, 0, 0, 0, 0};
+    const uint8_t release[8] = {};
+    keyboard.processReportData(press, sizeof(press));
+    for (Millis now = 1; now <= 310; ++now)
+    {
+        wheel.advance(now);
+    }
+    keyboard.processReportData(release, sizeof(release));
+    for (Millis now = 311; now <= 1000; ++now)
+    {
+        wheel.advance(now);
+    }
+
+    EXPECT_EQ(downs, (std::vector<std::pair<Millis, bool>>{{0, false}, {200, true}, {250, true}, {300, true}}));
+    EXPECT_EQ(ups, 1);
+
+    // Disconnecting stops the repeat too
+    keyboard.processReportData(press, sizeof(press));
+    keyboard.releaseAll();
+    EXPECT_EQ(wheel.armedCount(), 0u);
+}
@@ -0,0 +1,178 @@
+/**
+ * @file test_mouse_gestures.cpp
+ * @brief UsbHidMouseGestures fed by boot mouse reports on a simulated clock.
+ */
+
+#include "UsbHidMouseGestures.h"
+#include "UsbHidMouseReport.h"
+#include "UsbHidTimerWheel.h"
+
+#include <gtest/gtest.h>
+
+#include <ostream>
+#include <vector>
+
+namespace
+{
+using Millis = UsbHidTimerWheel::Millis;
+
+constexpr uint8_t LEFT  = 0x01;
+constexpr uint8_t RIGHT = 0x02;
+
+struct Gesture
+{
+    UsbHidMouseGesture gesture;
+    uint8_t button;
+    Millis time;
+
+    bool operator==(const Gesture& other) const
+    {
+        return gesture == other.gesture && button == other.button && time == other.time;
+    }
+};
+
+void PrintTo(const Gesture& g, std::ostream* os)
+{
+    *os << "{gesture " << static_cast<int>(g.gesture) << ", button " << int(g.button) << ", at " << g.time << "}";
+}
+
+/**
+ * @brief Mouse report -> gesture detector, wired as in UsbHidHost, on a 1 ms wheel.
+ */
+class MouseGesturesTest : public ::testing::Test
+{
+protected:
+    UsbHidTimerWheel wheel{1};
+    UsbHidMouseReport mouse;
+    UsbHidMouseGestures gestures{wheel};
+    std::vector<Gesture> seen;
+
+    void SetUp() override
+    {
+        mouse.registerCallback([this](const UsbHidMouseEvent& event) { gestures.onMouseEvent(event); });
+        gestures.registerCallback([this](const UsbHidMouseGestureEvent& event)
+                                  { seen.push_back({event.gesture, event.button, event.time}); });
+    }
+
+    /// Run the clock to @p time, one millisecond at a time, as the timer task would
+    void advanceTo(Millis time)
+    {
+        for (Millis now = wheel.now() + 1; now <= time; ++now)
+        {
+            wheel.advance(now);
+        }
+    }
+
+    /// Deliver a boot report at @p time
+    void report(Millis time, uint8_t buttons, int8_t dx = 0, int8_t dy = 0)
+    {
+        advanceTo(time);
+        const uint8_t data[4] = {buttons, static_cast<uint8_t>(dx), static_cast<uint8_t>(dy), 0};
+        mouse.processReportData(data, sizeof(data));
+    }
+};
+}  // namespace
+
+TEST_F(MouseGesturesTest, Click)
+{
+    report(100, LEFT);
+    report(180, 0);
+    advanceTo(2000);
+
+    EXPECT_EQ(seen, (std::vector<Gesture>{{UsbHidMouseGesture::CLICK, 0, 180}}));
+}
+
+TEST_F(MouseGesturesTest, DoubleClickReplacesTheSecondClick)
+{
+    report(100, LEFT);
+    report(150, 0);
+    report(300, LEFT);
+    report(350, 0);
+    advanceTo(2000);
+
+    EXPECT_EQ(seen, (std::vector<Gesture>{{UsbHidMouseGesture::CLICK, 0, 150},
+                                          {UsbHidMouseGesture::DOUBLE_CLICK, 0, 350}}));
+}
+
+TEST_F(MouseGesturesTest, SlowSecondClickIsAnotherClick)
+{
+    const Millis late = 150 + UsbHidMouseGestures::Config().doubleClickMs + 1;
+    report(100, LEFT);
+    report(150, 0);
+    report(late - 50, LEFT);
+    report(late, 0);
+
+    EXPECT_EQ(seen, (std::vector<Gesture>{{UsbHidMouseGesture::CLICK, 0, 150}, {UsbHidMouseGesture::CLICK, 0, late}}));
+}
+
+TEST_F(MouseGesturesTest, ThirdClickStartsANewPair)
+{
+    report(100, LEFT);
+    report(150, 0);
+    report(200, LEFT);
+    report(250, 0);
+    report(300, LEFT);
+    report(350, 0);
+
+    EXPECT_EQ(seen, (std::vector<Gesture>{{UsbHidMouseGesture::CLICK, 0, 150},
+                                          {UsbHidMouseGesture::DOUBLE_CLICK, 0, 250},
+                                          {UsbHidMouseGesture::CLICK, 0, 350}}));
+}
+
+TEST_F(MouseGesturesTest, LongPressFiresWhileHeldAndSuppressesTheClick)
+{
+    const Millis longPress = UsbHidMouseGestures::Config().longPressMs;
+    report(100, RIGHT);
+    advanceTo(100 + longPress - 1);
+    EXPECT_TRUE(seen.empty());
+
+    advanceTo(100 + longPress);
+    EXPECT_EQ(seen, (std::vector<Gesture>{{UsbHidMouseGesture::LONG_PRESS, 1, 100 + longPress}}));
+
+    report(100 + longPress + 300, 0);
+    advanceTo(3000);
+    EXPECT_EQ(seen.size(), 1u);
+}
+
+TEST_F(MouseGesturesTest, DragIsNoGesture)
+{
+    report(100, LEFT);
+    report(120, LEFT, 3, 0);
+    report(140, LEFT, 0, -3);
+    report(160, 0);
+    advanceTo(2000);
+
+    EXPECT_TRUE(seen.empty());
+}
+
+TEST_F(MouseGesturesTest, JitterWithinToleranceStillClicks)
+{
+    report(100, LEFT);
+    report(120, LEFT, 1, 1);
+    report(140, 0, -1, 0);
+
+    EXPECT_EQ(seen, (std::vector<Gesture>{{UsbHidMouseGesture::CLICK, 0, 140}}));
+}
+
+TEST_F(MouseGesturesTest, ButtonsAreIndependent)
+{
+    report(100, LEFT);
+    report(150, LEFT | RIGHT);
+    report(200, RIGHT);
+    advanceTo(650);
+
+    EXPECT_EQ(seen, (std::vector<Gesture>{{UsbHidMouseGesture::CLICK, 0, 200},
+                                          {UsbHidMouseGesture::LONG_PRESS, 1, 650}}));
+}
+
+TEST_F(MouseGesturesTest, DisconnectIsNoClick)
+{
+    // UsbHidHost resets the detector before the release forced by a disconnect
+    report(100, LEFT);
+    gestures.reset();
+    mouse.releaseAll();
+    advanceTo(2000);
+
+    EXPECT_TRUE(seen.empty());
+    EXPECT_EQ(wheel.armedCount(), 0u);
+}
@@ -0,0 +1,115 @@
+/**
+ * @file test_release_all.cpp
+ * @brief releaseAll() must release every held key and button exactly once.
+ */
+
+#include "UsbHidG20sProReport.h"
+#include "UsbHidKeyboardReport.h"
+#include "UsbHidMouseReport.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+
+TEST(ReleaseAll, KeyboardReleasesEachHeldKeyOnce)
+{
+    UsbHidKeyboardReport keyboard;
+    std::map<uint8_t, int> presses;
+    std::map<uint8_t, int> releases;
+    keyboard.registerCallback([&](const UsbHidKeyboardEvent& event)
+                              { ++(event.pressed ? presses : releases)[event.keyCode]; });
+
+    // Left Shift, then A and B held together
+    const uint8_t shift[8] = {0x02, 0, 0, 0, 0, 0, 0, 0};
+    const uint8_t keys[8]  = {0x02, 0, 0x04, 0x05, 0, 0, 0, 0};
+    keyboard.processReportData(shift, sizeof(shift));
+    keyboard.processReportData(keys, sizeof(keys));
+    ASSERT_EQ(presses.size(), 3u);
+    ASSERT_TRUE(releases.empty());
+
+    keyboard.releaseAll();
+    EXPECT_EQ(releases, (std::map<uint8_t, int>{{0x04, 1}, {0x05, 1}, {0xE1, 1}}));
+    EXPECT_TRUE(keyboard.getPressedKeys().empty());
+    EXPECT_EQ(keyboard.getModifiers(), 0);
+
+    // Nothing is held any more, a second release is silent
+    keyboard.releaseAll();
+    EXPECT_EQ(releases.size(), 3u);
+    EXPECT_EQ(releases[0x04], 1);
+}
+
+TEST(ReleaseAll, KeyboardWithNothingHeldIsSilent)
+{
+    UsbHidKeyboardReport keyboard;
+    int events = 0;
+    keyboard.registerCallback([&](const UsbHidKeyboardEvent&) { ++events; });
+
+    keyboard.releaseAll();
+    EXPECT_EQ(events, 0);
+}
+
+TEST(ReleaseAll, MouseReleasesEachHeldButtonOnce)
+{
+    UsbHidMouseReport mouse;
+    std::map<int, int> releases;
+    mouse.registerCallback([&](const UsbHidMouseEvent& event)
+                           {
+                               for (int button = 0; button < static_cast<int>(UsbHidMouseReport::MAX_BUTTONS); ++button)
+                               {
+                                   if (event.wasReleased(button))
+                                   {
+                                       ++releases[button];
+                                   }
+                               }
+                           });
+
+    // Left and middle held, with some motion
+    const uint8_t report[4] = {0x05, 3, 0xFD, 0};
+    mouse.processReportData(report, sizeof(report));
+    ASSERT_TRUE(mouse.isButtonPressed(0));
+    ASSERT_TRUE(mouse.isButtonPressed(2));
+
+    mouse.releaseAll();
+    EXPECT_EQ(releases, (std::map<int, int>{{0, 1}, {2, 1}}));
+    EXPECT_EQ(mouse.getButtons(), 0);
+
+    mouse.releaseAll();
+    EXPECT_EQ(releases.size(), 2u);
+    EXPECT_EQ(releases[0], 1);
+}
+
+TEST(ReleaseAll, G20sProReleasesEachHeldButtonOnce)
+{
+    UsbHidG20sProReport remote;
+    std::map<uint8_t, int> presses;
+    std::map<uint8_t, int> releases;
+    remote.registerCallback([&](const UsbHidG20sProEvent& event)
+                            {
+                                if (event.buttonId != UsbHidRemoteProfile::NO_BUTTON)
+                                {
+                                    ++(event.pressed ? presses : releases)[event.buttonId];
+                                }
+                            });
+
+    // 1 on the keyboard report, Vol+ on the consumer report, left button on the mouse report
+    const uint8_t key[8]      = {0x01, 0, 0x1E, 0, 0, 0, 0, 0};
+    const uint8_t consumer[3] = {0x04, 0xE9, 0x00};
+    const uint8_t mouse[4]    = {0x01, 0, 0, 0};
+    remote.processReportData(key, sizeof(key));
+    remote.processReportData(consumer, sizeof(consumer));
+    remote.processReportData(mouse, sizeof(mouse));
+
+    const uint8_t num1  = static_cast<uint8_t>(G20sProBtn::Num1);
+    const uint8_t volUp = static_cast<uint8_t>(G20sProBtn::VolUp);
+    const uint8_t left  = static_cast<uint8_t>(G20sProBtn::MouseLeft);
+    ASSERT_EQ(presses, (std::map<uint8_t, int>{{num1, 1}, {volUp, 1}, {left, 1}}));
+    ASSERT_TRUE(releases.empty());
+
+    remote.releaseAll();
+    EXPECT_EQ(releases, (std::map<uint8_t, int>{{num1, 1}, {volUp, 1}, {left, 1}}));
+    EXPECT_FALSE(remote.isButtonPressed(num1));
+
+    remote.releaseAll();
+    EXPECT_EQ(releases.size(), 3u);
+    EXPECT_EQ(releases[num1], 1);
+}
@@ -0,0 +1,116 @@
+/**
+ * @file test_report_forwarding.cpp
+ * @brief Per-device and per-report-ID decoders delivering through one shared report, as the host sets them up.
+ */
+
+#include "UsbHidG20sProReport.h"
+#include "UsbHidGenericReport.h"
+#include "UsbHidKeyboardReport.h"
+#include "UsbHidReportDescriptor.h"
+#include "descriptors.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+TEST(ReportForwarding, EachKeyboardReleasesOnlyItsOwnKeys)
+{
+    UsbHidKeyboardReport shared;
+    UsbHidKeyboardReport first;
+    UsbHidKeyboardReport second;
+    first.forwardTo(&shared);
+    second.forwardTo(&shared);
+    std::vector<UsbHidKeyboardEvent> events;
+    shared.registerCallback([&events](const UsbHidKeyboardEvent& event) { events.push_back(event); });
+
+    const uint8_t a[8] = {0, 0, 0x04, 0, 0, 0, 0, 0};
+    const uint8_t b[8] = {0, 0, 0x05, 0, 0, 0, 0, 0};
+    first.processReportData(a, sizeof(a));
+    second.processReportData(b, sizeof(b));
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].keyCode, 0x04);
+    EXPECT_EQ(events[1].keyCode, 0x05);
+
+    // The first keyboard is unplugged, B is still held on the second
+    events.clear();
+    first.releaseAll();
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].keyCode, 0x04);
+    EXPECT_FALSE(events[0].pressed);
+    EXPECT_EQ(second.getPressedKeys().size(), 1u);
+
+    // Only the decoders hold key state
+    EXPECT_TRUE(shared.getPressedKeys().empty());
+}
+
+TEST(ReportForwarding, GenericDecoderNotifiesTheSharedSubscriptions)
+{
+    UsbHidReportDescriptor descriptor;
+    ASSERT_TRUE(descriptor.parse(descriptors::MOUSE_AND_CONSUMER, sizeof(descriptors::MOUSE_AND_CONSUMER)));
+
+    UsbHidGenericReport shared;
+    std::vector<UsbHidFieldChange> wheel;
+    shared.subscribe(0x01, 0x38, [&wheel](const UsbHidFieldChange& change) { wheel.push_back(change); });
+
+    UsbHidGenericReport decoder;
+    ASSERT_TRUE(decoder.useDescriptor(descriptor));
+    decoder.useSubscriptionsOf(shared);
+    decoder.forwardTo(&shared);
+    int events = 0;
+    shared.registerCallback([&events](const UsbHidGenericEvent&) { ++events; });
+
+    decoder.processReportData(descriptors::MOUSE_REPORT, sizeof(descriptors::MOUSE_REPORT));
+    ASSERT_EQ(wheel.size(), 1u);
+    EXPECT_EQ(wheel[0].reportId, 1);
+    EXPECT_EQ(wheel[0].value, 1);
+    EXPECT_EQ(events, 1);
+}
+
+TEST(ReportForwarding, InputReportKeepsOneReportId)
+{
+    UsbHidReportDescriptor descriptor;
+    ASSERT_TRUE(descriptor.parse(descriptors::MOUSE_AND_GAMEPAD, sizeof(descriptors::MOUSE_AND_GAMEPAD)));
+
+    const UsbHidReportDescriptor gamepad = descriptor.inputReport(2);
+    ASSERT_FALSE(gamepad.fields().empty());
+    for (const auto& field : gamepad.fields())
+    {
+        EXPECT_EQ(field.reportId, 2);
+    }
+    EXPECT_TRUE(gamepad.usesReportIds());
+    EXPECT_TRUE(descriptor.inputReport(3).fields().empty());
+}
+
+TEST(ReportForwarding, InputReportKeepsTheLedsOfItsKeyboard)
+{
+    UsbHidReportDescriptor descriptor;
+    ASSERT_TRUE(descriptor.parse(descriptors::NKRO_KEYBOARD, sizeof(descriptors::NKRO_KEYBOARD)));
+
+    UsbHidKeyboardReport keyboard;
+    ASSERT_TRUE(keyboard.useReportProtocol(descriptor.inputReport(1)));
+    uint8_t report[UsbHidKeyboardReport::MAX_LED_REPORT_SIZE];
+    uint8_t reportId = 0;
+    EXPECT_EQ(keyboard.buildLedReport(0x02, report, sizeof(report), reportId), 2u);
+    EXPECT_EQ(reportId, 1);
+}
+
+TEST(ReportForwarding, RemoteDecoderTakesTheSharedMotionFilter)
+{
+    UsbHidG20sProReport shared;
+    shared.setMotionFilter(UsbHidMotionFilter::Config::passthrough());
+    std::vector<UsbHidG20sProEvent> events;
+    shared.registerCallback([&events](const UsbHidG20sProEvent& event) { events.push_back(event); });
+
+    UsbHidG20sProReport remote;
+    remote.useProfile(UsbHidG20sProReport::g20sProDecoder());
+    remote.useSettingsOf(shared);
+    remote.forwardTo(&shared);
+
+    // Passthrough: the motion of the first report arrives unsmoothed
+    const uint8_t mouse[4] = {0x00, 9, 0xFD, 0};
+    remote.processReportData(mouse, sizeof(mouse));
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_TRUE(events[0].isMotion());
+    EXPECT_EQ(events[0].mouseX, 9);
+    EXPECT_EQ(events[0].mouseY, -3);
+}
@@ -0,0 +1,187 @@
+/**
+ * @file test_timer_wheel.cpp
+ * @brief UsbHidTimerWheel driven by a simulated clock through advance().
+ */
+
+#include "UsbHidTimerWheel.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using Millis = UsbHidTimerWheel::Millis;
+
+TEST(TimerWheel, FiresOnceWhenTheDelayHasPassed)
+{
+    UsbHidTimerWheel wheel(5);
+    std::vector<Millis> fired;
+    UsbHidTimerWheel::Timer timer([&](Millis now) { fired.push_back(now); });
+
+    wheel.start(timer, 15);
+    EXPECT_TRUE(timer.isArmed());
+    EXPECT_EQ(wheel.armedCount(), 1u);
+
+    wheel.advance(14);
+    EXPECT_TRUE(fired.empty());
+    wheel.advance(15);
+    EXPECT_EQ(fired, std::vector<Millis>{15});
+    EXPECT_FALSE(timer.isArmed());
+    EXPECT_EQ(wheel.armedCount(), 0u);
+
+    wheel.advance(100);
+    EXPECT_EQ(fired.size(), 1u);
+}
+
+TEST(TimerWheel, NeverFiresEarlyWhenStartedMidTick)
+{
+    UsbHidTimerWheel wheel(5);
+    std::vector<Millis> fired;
+    UsbHidTimerWheel::Timer timer([&](Millis now) { fired.push_back(now); });
+
+    wheel.advance(3);
+    wheel.start(timer, 5);
+    for (Millis now = 4; now <= 20 && fired.empty(); ++now)
+    {
+        wheel.advance(now);
+    }
+    ASSERT_EQ(fired.size(), 1u);
+    EXPECT_GE(fired[0], 3u + 5u);
+    EXPECT_LT(fired[0], 3u + 5u + 5u);
+}
+
+TEST(TimerWheel, StopAndDestroyDisarm)
+{
+    UsbHidTimerWheel wheel(1);
+    int fired = 0;
+    UsbHidTimerWheel::Timer stopped([&](Millis) { ++fired; });
+    wheel.start(stopped, 10);
+    {
+        UsbHidTimerWheel::Timer destroyed([&](Millis) { ++fired; });
+        wheel.start(destroyed, 10);
+        EXPECT_EQ(wheel.armedCount(), 2u);
+    }
+    EXPECT_EQ(wheel.armedCount(), 1u);
+
+    wheel.stop(stopped);
+    wheel.stop(stopped);
+    EXPECT_EQ(wheel.armedCount(), 0u);
+
+    wheel.advance(50);
+    EXPECT_EQ(fired, 0);
+}
+
+TEST(TimerWheel, RestartMovesTheExpiry)
+{
+    UsbHidTimerWheel wheel(1);
+    std::vector<Millis> fired;
+    UsbHidTimerWheel::Timer timer([&](Millis now) { fired.push_back(now); });
+
+    wheel.start(timer, 10);
+    wheel.advance(8);
+    wheel.start(timer, 10);
+    EXPECT_EQ(wheel.armedCount(), 1u);
+
+    for (Millis now = 9; now <= 30; ++now)
+    {
+        wheel.advance(now);
+    }
+    EXPECT_EQ(fired, std::vector<Millis>{18});
+}
+
+TEST(TimerWheel, DelaysLongerThanOneRevolution)
+{
+    UsbHidTimerWheel wheel(5);
+    const Millis revolution = UsbHidTimerWheel::SLOTS * 5;
+    std::vector<Millis> fired;
+    UsbHidTimerWheel::Timer timer([&](Millis now) { fired.push_back(now); });
+
+    wheel.start(timer, 3 * revolution + 10);
+    for (Millis now = 5; now < 3 * revolution + 10; now += 5)
+    {
+        wheel.advance(now);
+    }
+    EXPECT_TRUE(fired.empty());
+
+    wheel.advance(3 * revolution + 10);
+    EXPECT_EQ(fired, std::vector<Millis>{3 * revolution + 10});
+}
+
+TEST(TimerWheel, LargeJumpFiresEveryDueTimerOnce)
+{
+    UsbHidTimerWheel wheel(5);
+    int fired[3] = {};
+    UsbHidTimerWheel::Timer a([&](Millis) { ++fired[0]; });
+    UsbHidTimerWheel::Timer b([&](Millis) { ++fired[1]; });
+    UsbHidTimerWheel::Timer c([&](Millis) { ++fired[2]; });
+    wheel.start(a, 5);
+    wheel.start(b, 200);
+    wheel.start(c, 100000);
+
+    wheel.advance(10000);
+    EXPECT_EQ(fired[0], 1);
+    EXPECT_EQ(fired[1], 1);
+    EXPECT_EQ(fired[2], 0);
+    EXPECT_TRUE(c.isArmed());
+}
+
+TEST(TimerWheel, CallbackMayRearmItsTimer)
+{
+    UsbHidTimerWheel wheel(1);
+    std::vector<Millis> fired;
+    UsbHidTimerWheel::Timer* self = nullptr;
+    UsbHidTimerWheel::Timer periodic([&](Millis now)
+                                     {
+                                         fired.push_back(now);
+                                         if (fired.size() < 3)
+                                         {
+                                             wheel.start(*self, 10);
+                                         }
+                                     });
+    self = &periodic;
+
+    wheel.start(periodic, 10);
+    for (Millis now = 1; now <= 100; ++now)
+    {
+        wheel.advance(now);
+    }
+    EXPECT_EQ(fired, (std::vector<Millis>{10, 20, 30}));
+    EXPECT_FALSE(periodic.isArmed());
+}
+
+TEST(TimerWheel, TimeToNextExpiry)
+{
+    UsbHidTimerWheel wheel(5);
+    UsbHidTimerWheel::Timer near([](Millis) {});
+    UsbHidTimerWheel::Timer far([](Millis) {});
+
+    Millis delay = 0;
+    EXPECT_FALSE(wheel.timeToNextExpiry(delay));
+
+    wheel.start(far, 500);
+    wheel.start(near, 20);
+    ASSERT_TRUE(wheel.timeToNextExpiry(delay));
+    EXPECT_EQ(delay, 20u);
+
+    wheel.advance(12);
+    ASSERT_TRUE(wheel.timeToNextExpiry(delay));
+    EXPECT_EQ(delay, 8u);
+
+    wheel.stop(near);
+    ASSERT_TRUE(wheel.timeToNextExpiry(delay));
+    EXPECT_EQ(delay, 488u);
+}
+
+TEST(TimerWheel, ClockWrapAround)
+{
+    const Millis start = 0xFFFFFFF0u;
+    UsbHidTimerWheel wheel(1, start);
+    std::vector<Millis> fired;
+    UsbHidTimerWheel::Timer timer([&](Millis now) { fired.push_back(now); });
+
+    wheel.start(timer, 40);
+    for (Millis now = start + 1; now != start + 50; ++now)
+    {
+        wheel.advance(now);
+    }
+    EXPECT_EQ(fired, std::vector<Millis>{start + 40});
+}
@@ -0,0 +1,59 @@
+/**
+ * @file trace.h
+ * @brief Loads recorded report traces from test/host/traces.
+ *
+ * A trace holds one report per line as space-separated hex bytes, the format of the
+ * "Raw data:" report logs; anything up to and including "Raw data:" is skipped, so
+ * serial monitor output can be used as is. Lines starting with '#' are comments.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace trace
+{
+using Report = std::vector<uint8_t>;
+
+/**
+ * @brief Load a trace by file name from the traces directory.
+ *
+ * @return std::vector<Report> The reports, empty if the file is missing.
+ */
+inline std::vector<Report> load(const std::string& name)
+{
+    std::vector<Report> reports;
+    std::ifstream in(std::string(USBHID_TRACE_DIR) + "/" + name);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        const size_t marker = line.find("Raw data:");
+        if (marker != std::string::npos)
+        {
+            line.erase(0, marker + 9);
+        }
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        Report report;
+        std::istringstream bytes(line);
+        std::string byte;
+        while (bytes >> byte)
+        {
+            report.push_back(static_cast<uint8_t>(std::strtoul(byte.c_str(), nullptr, 16)));
+        }
+        if (!report.empty())
+        {
+            reports.push_back(std::move(report));
+        }
+    }
+    return reports;
+}
+}  // namespace trace